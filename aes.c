@@ -1,8 +1,10 @@
 /*
 
 This is an implementation of the AES-GCM authenticated encryption algorithm.
-Key sizes can be chosen in aes.h - available choices are AES128, AES192, AES256,
-and a non-standard AES512.
+Key sizes are selected at runtime from the key length passed to
+AES_init_ctx_keylen(): AES128, AES192, AES256 and a non-standard AES512 are
+compiled in by default (see aes.h). Each key size gets its own round-count-
+specialised kernels so the round loop is fully unrolled.
 
 The implementation of AES GCM is based on the guidelines in:
   National Institute of Standards and Technology Special Publication 800-38D
@@ -25,11 +27,31 @@ ECB and CBC modes have been removed.
 /*****************************************************************************/
 #include <string.h> // CBC mode, for memset
 #include <stdio.h>  // Add stdio.h for printf
+#include <stdlib.h> // aligned_alloc, for AES_ctx_alloc
+#if defined(_WIN32)
+#include <malloc.h> // _aligned_malloc
+#endif
 #include "aes.h"
+#include "aes_tables.h"
+
+#if AES_GCM_STATS
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#endif
 
 // Include headers for intrinsics if needed (example)
 #if defined(__x86_64__) || defined(_M_X64)
 #include <immintrin.h> // For AES-NI, PCLMULQDQ
+// GCC and Clang define __PCLMUL__ for -mpclmul; accept __PCLMULQDQ__ as well
+#if defined(__PCLMUL__) || defined(__PCLMULQDQ__)
+#define AES_HAVE_PCLMUL 1
+#endif
+// AES-512 also gets a VAES/AVX-512 CTR kernel in AES-NI builds, selected at run
+// time on CPUs that have it. -DAES_VAES=0 leaves it out.
+#if !defined(AES_VAES) && defined(__x86_64__) && defined(__AES__) && (defined(__GNUC__) || defined(__clang__))
+#define AES_VAES 1
+#endif
 #elif defined(__aarch64__)
 #include <arm_neon.h>   // For ARM NEON and Crypto extensions
 // #include <arm_acle.h> // Alternative/additional header for ARM CPU intrinsics
@@ -41,18 +63,21 @@ ECB and CBC modes have been removed.
 // The number of columns comprising a state in AES. This is a constant in AES. Value=4
 #define Nb 4
 
-#if defined(AES256) && (AES256 == 1)
-    #define Nk 8
-    //#define Nr 14 // Nr is now defined in aes.h
-#elif defined(AES192) && (AES192 == 1)
-    #define Nk 6
-    //#define Nr 12 // Nr is now defined in aes.h
-#elif defined(AES512) && (AES512 == 1) // Added non-standard 512-bit key option
-    #define Nk 16
-    //#define Nr 22 // Nr is now defined in aes.h
-#else // Default AES128
-    #define Nk 4        // The number of 32 bit words in a key.
-    //#define Nr 10       // The number of 32 bit words in a key.
+// The number of 32 bit words in a key (Nk) and the number of rounds (Nr) are
+// per-context now: Nk = key_len / 4 and Nr = Nk + 6, i.e. 10, 12, 14 and 22
+// rounds for AES128, AES192, AES256 and the non-standard AES512.
+
+// Forces a helper to be inlined into its callers, so that arguments which are
+// compile-time constants there (the round count) stay constant in the body.
+#if defined(__GNUC__) || defined(__clang__)
+  #define AES_ALWAYS_INLINE inline __attribute__((always_inline))
+  #define AES_UNROLL _Pragma("GCC unroll 24")
+#elif defined(_MSC_VER)
+  #define AES_ALWAYS_INLINE __forceinline
+  #define AES_UNROLL
+#else
+  #define AES_ALWAYS_INLINE inline
+  #define AES_UNROLL
 #endif
 
 // jcallan@github points out that declaring Multiply as a function 
@@ -76,24 +101,7 @@ typedef uint8_t state_t[4][4];
 // The lookup-tables are marked const so they can be placed in read-only storage instead of RAM
 // The numbers below can be computed dynamically trading ROM for RAM - 
 // This can be useful in (embedded) bootloader applications, where ROM is often limited.
-static const uint8_t sbox[256] = {
-  //0     1    2      3     4    5     6     7      8    9     A      B    C     D     E     F
-  0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
-  0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
-  0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
-  0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
-  0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
-  0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
-  0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
-  0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
-  0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
-  0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
-  0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
-  0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
-  0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
-  0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
-  0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
-  0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16 };
+static const uint8_t sbox[256] = AES_SBOX_INIT;
 
 #if 0 // (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1) - rsbox is unused for GCM
 static const uint8_t rsbox[256] = {
@@ -115,10 +123,8 @@ static const uint8_t rsbox[256] = {
   0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d };
 #endif
 
-// The round constant word array, Rcon[i], contains the values given by 
-// x to the power (i-1) being powers of x (x is denoted as {02}) in the field GF(2^8)
-static const uint8_t Rcon[11] = {
-  0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+// The round constant word array, Rcon[i] (see aes_tables.h)
+static const uint8_t Rcon[11] = AES_RCON_INIT;
 
 /*
  * Jordan Goulder points out in PR #12 (https://github.com/kokke/tiny-AES-C/pull/12),
@@ -137,7 +143,7 @@ static const uint8_t Rcon[11] = {
 #define getSBoxValue(num) (sbox[(num)])
 
 // This function produces Nb(Nr+1) round keys. The round keys are used in each round to decrypt the states. 
-static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
+static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key, unsigned Nk, unsigned Nr)
 {
   unsigned i, j, k;
   uint8_t tempa[4]; // Used for the column/row operations
@@ -190,8 +196,8 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
 
       tempa[0] = tempa[0] ^ Rcon[i/Nk];
     }
-#if Nk > 6 // Apply extra SubWord for keys larger than 192 bits (Nk=8 for AES256, Nk=16 for non-standard AES512)
-    if (i % Nk == 4)
+    // Apply extra SubWord for keys larger than 192 bits (Nk=8 for AES256, Nk=16 for non-standard AES512)
+    if (Nk > 6 && i % Nk == 4)
     {
       // Function Subword()
       {
@@ -201,7 +207,6 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
         tempa[3] = getSBoxValue(tempa[3]);
       }
     }
-#endif
     j = i * 4; k=(i - Nk) * 4;
     RoundKey[j + 0] = RoundKey[k + 0] ^ tempa[0];
     RoundKey[j + 1] = RoundKey[k + 1] ^ tempa[1];
@@ -210,15 +215,11 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
   }
 }
 
-void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key)
-{
-  KeyExpansion(ctx->RoundKey, key);
-}
 #if 0 // No longer used in public API or GCM internal functions
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
 void AES_init_ctx_iv(struct AES_ctx* ctx, const uint8_t* key, const uint8_t* iv)
 {
-  KeyExpansion(ctx->RoundKey, key);
+  KeyExpansion(ctx->RoundKey, key, Nk, Nr);
   memcpy (ctx->Iv, iv, AES_BLOCKLEN);
 }
 void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv)
@@ -409,32 +410,34 @@ static void InvShiftRows(state_t* state)
 
 #endif // End of commented-out inverse functions
 
-// Cipher is the main function that encrypts the PlainText.
-static void Cipher(state_t* state, const uint8_t* RoundKey)
+// CipherRounds is the main function that encrypts the PlainText.
+// It is only ever inlined into the per-key-size kernels below, where Nr is a
+// compile-time constant, so both the AES-NI and the C round loops unroll fully.
+static AES_ALWAYS_INLINE void CipherRounds(state_t* state, const uint8_t* RoundKey, const unsigned Nr)
 {
+    unsigned round;
+
 // --- Architecture-Specific Optimizations --- 
 #if defined(__x86_64__) || defined(_M_X64)
     #if defined(__AES__)
         // AES-NI intrinsic version for x86-64
-        // Assumes state is properly aligned
-        // Load state and first round key
+        // Load state and first round key. Round keys are 16-byte lanes of an
+        // aligned struct AES_ctx, so aligned loads are safe (and can be folded
+        // into the AESENC operands).
         __m128i block = _mm_loadu_si128((__m128i*)state);
         const __m128i* pRoundKey = (const __m128i*)RoundKey;
 
         // Initial AddRoundKey
-        block = _mm_xor_si128(block, _mm_loadu_si128(&pRoundKey[0]));
+        block = _mm_xor_si128(block, _mm_load_si128(&pRoundKey[0]));
 
         // Main rounds (Nr-1 rounds)
-        // Unroll loop slightly for potentially better performance, adjust as needed
-        for (uint8_t round = 1; round < Nr; round += 2) {
-            block = _mm_aesenc_si128(block, _mm_loadu_si128(&pRoundKey[round]));
-            if (round + 1 < Nr) { // Check if there's another round in this pair
-                 block = _mm_aesenc_si128(block, _mm_loadu_si128(&pRoundKey[round + 1]));
-            }
+        AES_UNROLL
+        for (round = 1; round < Nr; ++round) {
+            block = _mm_aesenc_si128(block, _mm_load_si128(&pRoundKey[round]));
         }
         
         // Final round
-        block = _mm_aesenclast_si128(block, _mm_loadu_si128(&pRoundKey[Nr]));
+        block = _mm_aesenclast_si128(block, _mm_load_si128(&pRoundKey[Nr]));
 
         // Store result back to state
         _mm_storeu_si128((__m128i*)state, block);
@@ -454,27 +457,24 @@ static void Cipher(state_t* state, const uint8_t* RoundKey)
 // --- End Architecture-Specific Optimizations ---
 
     // --- Generic C Implementation (Fallback) ---
-    uint8_t round = 0;
-
     // Add the First round key to the state before starting the rounds.
     AddRoundKey(0, state, RoundKey);
 
     // There will be Nr rounds.
     // The first Nr-1 rounds are identical.
-    // These Nr rounds are executed in the loop below.
     // Last one without MixColumns()
-    for (round = 1; ; ++round)
+    AES_UNROLL
+    for (round = 1; round < Nr; ++round)
     {
         SubBytes(state);
         ShiftRows(state);
-        if (round == Nr) {
-            break;
-        }
         MixColumns(state);
-        AddRoundKey(round, state, RoundKey);
+        AddRoundKey((uint8_t)round, state, RoundKey);
     }
+    SubBytes(state);
+    ShiftRows(state);
     // Add round key to last round
-    AddRoundKey(Nr, state, RoundKey);
+    AddRoundKey((uint8_t)Nr, state, RoundKey);
     // --- End Generic C Implementation ---
 }
 
@@ -575,24 +575,96 @@ void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, size_t length)
 
 #if defined(CTR) && (CTR == 1)
 
+// Counter blocks encrypted together by the AES-NI CTR kernel. Eight covers
+// AESENC's latency (4-7 cycles) at its throughput (1-2 per cycle) on current
+// x86 cores.
+#define AES_CTR_LANES 8
+
 // Internal CTR function used by GCM.
 // Encrypts/decrypts buffer using AES in CTR mode.
-// Make ctx const as it's only used for reading RoundKey.
-// Pass the counter block explicitly.
-static void AES_CTR_xcrypt_buffer(const struct AES_ctx* ctx, uint8_t* current_counter_block, uint8_t* buf, size_t length)
+// Pass the counter block explicitly; it is advanced past the blocks consumed.
+// Inlined into the per-key-size kernels like CipherRounds.
+static AES_ALWAYS_INLINE void CTR_xcrypt_rounds(const uint8_t* RoundKey, uint8_t* current_counter_block, uint8_t* buf, size_t length, const unsigned Nr)
 {
   uint8_t buffer[AES_BLOCKLEN]; // Buffer for encrypted counter block
   size_t i;
   int bi;
 
-  // Start with the current counter value
-  memcpy(buffer, current_counter_block, AES_BLOCKLEN);
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AES__)
+  // The schedule is loaded once per call. Blocks are then encrypted
+  // AES_CTR_LANES at a time, each round applied to all of them before the
+  // next, so the independent AESENCs overlap in the pipeline instead of
+  // waiting on one another's latency. With Nr constant every loop below is
+  // unrolled. AES-512 needs 23 round keys plus 8 blocks, more than the 16 SSE
+  // registers; the compiler then folds some round keys into AESENC memory
+  // operands (aligned, in L1), so it still loads each key once per 8 blocks.
+  __m128i rk[AES_keyExpSize / AES_BLOCKLEN];
+  __m128i b[AES_CTR_LANES];
+  unsigned round, j;
+  AES_UNROLL
+  for (round = 0; round <= Nr; ++round) {
+    rk[round] = _mm_load_si128((const __m128i*)RoundKey + round);
+  }
+  // The first 12 bytes of the counter block are fixed; only the big-endian
+  // inc32 word changes, so blocks are assembled in registers
+  uint32_t prefix[3];
+  memcpy(prefix, current_counter_block, sizeof(prefix));
+  uint32_t ctr = ((uint32_t)current_counter_block[12] << 24) | ((uint32_t)current_counter_block[13] << 16) |
+                 ((uint32_t)current_counter_block[14] << 8) | current_counter_block[15];
+  #define CTR_BLOCK(c) _mm_set_epi32((int)__builtin_bswap32(c), (int)prefix[2], (int)prefix[1], (int)prefix[0])
+
+  for (i = 0; length - i >= AES_CTR_LANES * AES_BLOCKLEN; i += AES_CTR_LANES * AES_BLOCKLEN) {
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_LANES; ++j) {
+      b[j] = _mm_xor_si128(CTR_BLOCK(ctr + j), rk[0]);
+    }
+    ctr += AES_CTR_LANES;
+    AES_UNROLL
+    for (round = 1; round < Nr; ++round) {
+      AES_UNROLL
+      for (j = 0; j < AES_CTR_LANES; ++j) {
+        b[j] = _mm_aesenc_si128(b[j], rk[round]);
+      }
+    }
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_LANES; ++j) {
+      b[j] = _mm_aesenclast_si128(b[j], rk[Nr]);
+      __m128i* p = (__m128i*)(buf + i) + j;
+      _mm_storeu_si128(p, _mm_xor_si128(b[j], _mm_loadu_si128(p)));
+    }
+  }
+  // Fewer than AES_CTR_LANES blocks left: one at a time, the last maybe partial
+  for (; i < length; i += AES_BLOCKLEN) {
+    __m128i block = _mm_xor_si128(CTR_BLOCK(ctr), rk[0]);
+    ++ctr;
+    AES_UNROLL
+    for (round = 1; round < Nr; ++round) {
+      block = _mm_aesenc_si128(block, rk[round]);
+    }
+    block = _mm_aesenclast_si128(block, rk[Nr]);
+    if (length - i >= AES_BLOCKLEN) {
+      _mm_storeu_si128((__m128i*)(buf + i), _mm_xor_si128(block, _mm_loadu_si128((const __m128i*)(buf + i))));
+    } else {
+      _mm_storeu_si128((__m128i*)buffer, block);
+      for (bi = 0; i + (size_t)bi < length; ++bi) {
+        buf[i + bi] ^= buffer[bi];
+      }
+    }
+  }
+  #undef CTR_BLOCK
+  current_counter_block[12] = (uint8_t)(ctr >> 24);
+  current_counter_block[13] = (uint8_t)(ctr >> 16);
+  current_counter_block[14] = (uint8_t)(ctr >> 8);
+  current_counter_block[15] = (uint8_t)ctr;
+  return;
+#endif
 
   for (i = 0, bi = AES_BLOCKLEN; i < length; ++i, ++bi)
   {
     if (bi == AES_BLOCKLEN) // Regen xor buffer if needed
     {
-        Cipher((state_t*)buffer, ctx->RoundKey); // Encrypt the current counter block
+        memcpy(buffer, current_counter_block, AES_BLOCKLEN);
+        CipherRounds((state_t*)buffer, RoundKey, Nr); // Encrypt the current counter block
 
         // Increment counter block for next time (standard GCM increments the rightmost 32 bits)
         for (bi = (AES_BLOCKLEN - 1); bi >= (AES_BLOCKLEN - 4); --bi) {
@@ -601,8 +673,6 @@ static void AES_CTR_xcrypt_buffer(const struct AES_ctx* ctx, uint8_t* current_co
                  break;
              }
         }
-        // Copy the *next* counter value to buffer for the next encryption cycle
-        memcpy(buffer, current_counter_block, AES_BLOCKLEN); 
         bi = 0;
     }
     buf[i] = (buf[i] ^ buffer[bi]); // XOR plaintext/ciphertext with encrypted counter block
@@ -611,6 +681,609 @@ static void AES_CTR_xcrypt_buffer(const struct AES_ctx* ctx, uint8_t* current_co
 
 #endif // #if defined(CTR) && (CTR == 1)
 
+// Encrypts nblocks independent blocks from in to out (which may be the same
+// buffer), for AES_encrypt_blocks. The AES-NI path interleaves AES_CTR_LANES
+// blocks like the CTR kernel; the portable path runs CipherRounds per block.
+static AES_ALWAYS_INLINE void ECB_encrypt_rounds(const uint8_t* RoundKey, const uint8_t* in, uint8_t* out, size_t nblocks, const unsigned Nr)
+{
+  size_t i = 0;
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AES__)
+  __m128i rk[AES_keyExpSize / AES_BLOCKLEN];
+  __m128i b[AES_CTR_LANES];
+  unsigned round, j;
+  AES_UNROLL
+  for (round = 0; round <= Nr; ++round) {
+    rk[round] = _mm_load_si128((const __m128i*)RoundKey + round);
+  }
+  for (; nblocks - i >= AES_CTR_LANES; i += AES_CTR_LANES) {
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_LANES; ++j) {
+      b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in + i + j), rk[0]);
+    }
+    AES_UNROLL
+    for (round = 1; round < Nr; ++round) {
+      AES_UNROLL
+      for (j = 0; j < AES_CTR_LANES; ++j) {
+        b[j] = _mm_aesenc_si128(b[j], rk[round]);
+      }
+    }
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_LANES; ++j) {
+      _mm_storeu_si128((__m128i*)out + i + j, _mm_aesenclast_si128(b[j], rk[Nr]));
+    }
+  }
+  for (; i < nblocks; ++i) {
+    __m128i block = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in + i), rk[0]);
+    AES_UNROLL
+    for (round = 1; round < Nr; ++round) {
+      block = _mm_aesenc_si128(block, rk[round]);
+    }
+    _mm_storeu_si128((__m128i*)out + i, _mm_aesenclast_si128(block, rk[Nr]));
+  }
+  return;
+#endif
+
+  for (; i < nblocks; ++i) {
+    state_t state;
+    memcpy(state, in + i * AES_BLOCKLEN, AES_BLOCKLEN);
+    CipherRounds(&state, RoundKey, Nr);
+    memcpy(out + i * AES_BLOCKLEN, state, AES_BLOCKLEN);
+  }
+}
+
+// Stamps out the kernels for one key size, with the round count baked in.
+#define AES_DEFINE_KERNELS(bits, rounds)                                                     \
+  static void Cipher##bits(state_t* state, const uint8_t* RoundKey)                         \
+  {                                                                                          \
+    CipherRounds(state, RoundKey, rounds);                                                   \
+  }                                                                                          \
+  static void CTR_xcrypt##bits(const uint8_t* RoundKey, uint8_t* counter, uint8_t* buf, size_t length) \
+  {                                                                                          \
+    CTR_xcrypt_rounds(RoundKey, counter, buf, length, rounds);                               \
+  }                                                                                          \
+  static void ECB_encrypt##bits(const uint8_t* RoundKey, const uint8_t* in, uint8_t* out, size_t nblocks) \
+  {                                                                                          \
+    ECB_encrypt_rounds(RoundKey, in, out, nblocks, rounds);                                  \
+  }                                                                                          \
+  static const struct aes_kernels kernels##bits = { Cipher##bits, CTR_xcrypt##bits, ECB_encrypt##bits };
+
+struct aes_kernels
+{
+  void (*cipher)(state_t* state, const uint8_t* RoundKey);
+  void (*ctr_xcrypt)(const uint8_t* RoundKey, uint8_t* counter, uint8_t* buf, size_t length);
+  void (*encrypt_blocks)(const uint8_t* RoundKey, const uint8_t* in, uint8_t* out, size_t nblocks);
+};
+
+#if defined(AES128) && (AES128 == 1)
+AES_DEFINE_KERNELS(128, 10)
+#endif
+#if defined(AES192) && (AES192 == 1)
+AES_DEFINE_KERNELS(192, 12)
+#endif
+#if defined(AES256) && (AES256 == 1)
+AES_DEFINE_KERNELS(256, 14)
+#endif
+#if defined(AES512) && (AES512 == 1)
+AES_DEFINE_KERNELS(512, 22)
+#endif
+
+#if defined(AES512) && (AES512 == 1) && defined(AES_VAES) && AES_VAES
+// Blocks in flight in the VAES kernel, as ZMM registers of four blocks each.
+// AES-512's chain of 22 dependent rounds is three times as long as the pipeline
+// is deep, so a longer run of independent blocks is needed to keep the units
+// busy; 4 x 4 blocks plus the 23 broadcast round keys still fit the 32 ZMM
+// registers.
+#define AES_CTR_VAES_LANES 4
+
+// AES-512 CTR on VAES: like the AES-NI kernel in CTR_xcrypt_rounds, but every
+// AESENC works on four blocks. Counters stay little-endian in the last word of
+// each 128-bit lane, so one add advances four of them (wrapping mod 2^32, as
+// inc32 does) and a byte shuffle turns them big-endian per use. The tail,
+// partial block included, goes through masked loads and stores.
+__attribute__((target("avx512f,avx512bw,vaes")))
+static void CTR_xcrypt512_vaes(const uint8_t* RoundKey, uint8_t* counter, uint8_t* buf, size_t length)
+{
+  __m512i rk[23];
+  __m512i x[AES_CTR_VAES_LANES];
+  unsigned round, j;
+  size_t i;
+
+  AES_UNROLL
+  for (round = 0; round <= 22; ++round) {
+    rk[round] = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i*)RoundKey + round));
+  }
+  uint32_t prefix[3];
+  memcpy(prefix, counter, sizeof(prefix));
+  uint32_t ctr = ((uint32_t)counter[12] << 24) | ((uint32_t)counter[13] << 16) |
+                 ((uint32_t)counter[14] << 8) | counter[15];
+  const __m512i bswap_ctr = _mm512_broadcast_i32x4(_mm_set_epi8(12, 13, 14, 15, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+  const __m512i four = _mm512_broadcast_i32x4(_mm_set_epi32(4, 0, 0, 0));
+  __m512i c = _mm512_add_epi32(_mm512_broadcast_i32x4(_mm_set_epi32((int)ctr, (int)prefix[2], (int)prefix[1], (int)prefix[0])),
+                               _mm512_set_epi32(3, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0));
+
+  for (i = 0; length - i >= AES_CTR_VAES_LANES * 64; i += AES_CTR_VAES_LANES * 64) {
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_VAES_LANES; ++j) {
+      x[j] = _mm512_xor_si512(_mm512_shuffle_epi8(c, bswap_ctr), rk[0]);
+      c = _mm512_add_epi32(c, four);
+    }
+    AES_UNROLL
+    for (round = 1; round < 22; ++round) {
+      AES_UNROLL
+      for (j = 0; j < AES_CTR_VAES_LANES; ++j) {
+        x[j] = _mm512_aesenc_epi128(x[j], rk[round]);
+      }
+    }
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_VAES_LANES; ++j) {
+      x[j] = _mm512_aesenclast_epi128(x[j], rk[22]);
+      uint8_t* p = buf + i + 64 * j;
+      _mm512_storeu_si512(p, _mm512_xor_si512(x[j], _mm512_loadu_si512(p)));
+    }
+  }
+  // Four blocks at a time; the bytes past the end are masked off
+  for (; i < length; i += 64) {
+    __mmask64 m = length - i >= 64 ? ~(__mmask64)0 : ((__mmask64)1 << (length - i)) - 1;
+    __m512i b = _mm512_xor_si512(_mm512_shuffle_epi8(c, bswap_ctr), rk[0]);
+    c = _mm512_add_epi32(c, four);
+    AES_UNROLL
+    for (round = 1; round < 22; ++round) {
+      b = _mm512_aesenc_epi128(b, rk[round]);
+    }
+    b = _mm512_aesenclast_epi128(b, rk[22]);
+    _mm512_mask_storeu_epi8(buf + i, m, _mm512_xor_si512(b, _mm512_maskz_loadu_epi8(m, buf + i)));
+  }
+
+  ctr += (uint32_t)((length + AES_BLOCKLEN - 1) / AES_BLOCKLEN);
+  counter[12] = (uint8_t)(ctr >> 24);
+  counter[13] = (uint8_t)(ctr >> 16);
+  counter[14] = (uint8_t)(ctr >> 8);
+  counter[15] = (uint8_t)ctr;
+}
+
+// AES-512 over independent blocks on VAES, four per register as in the CTR
+// kernel above.
+__attribute__((target("avx512f,avx512bw,vaes")))
+static void ECB_encrypt512_vaes(const uint8_t* RoundKey, const uint8_t* in, uint8_t* out, size_t nblocks)
+{
+  __m512i rk[23];
+  __m512i x[AES_CTR_VAES_LANES];
+  unsigned round, j;
+  size_t i, length = nblocks * AES_BLOCKLEN;
+
+  AES_UNROLL
+  for (round = 0; round <= 22; ++round) {
+    rk[round] = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i*)RoundKey + round));
+  }
+  for (i = 0; length - i >= AES_CTR_VAES_LANES * 64; i += AES_CTR_VAES_LANES * 64) {
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_VAES_LANES; ++j) {
+      x[j] = _mm512_xor_si512(_mm512_loadu_si512(in + i + 64 * j), rk[0]);
+    }
+    AES_UNROLL
+    for (round = 1; round < 22; ++round) {
+      AES_UNROLL
+      for (j = 0; j < AES_CTR_VAES_LANES; ++j) {
+        x[j] = _mm512_aesenc_epi128(x[j], rk[round]);
+      }
+    }
+    AES_UNROLL
+    for (j = 0; j < AES_CTR_VAES_LANES; ++j) {
+      _mm512_storeu_si512(out + i + 64 * j, _mm512_aesenclast_epi128(x[j], rk[22]));
+    }
+  }
+  for (; i < length; i += 64) {
+    __mmask64 m = length - i >= 64 ? ~(__mmask64)0 : ((__mmask64)1 << (length - i)) - 1;
+    __m512i b = _mm512_xor_si512(_mm512_maskz_loadu_epi8(m, in + i), rk[0]);
+    AES_UNROLL
+    for (round = 1; round < 22; ++round) {
+      b = _mm512_aesenc_epi128(b, rk[round]);
+    }
+    _mm512_mask_storeu_epi8(out + i, m, _mm512_aesenclast_epi128(b, rk[22]));
+  }
+}
+
+static const struct aes_kernels kernels512_vaes = { Cipher512, CTR_xcrypt512_vaes, ECB_encrypt512_vaes };
+
+// __builtin_cpu_supports also checks that the OS saves the ZMM state
+static int have_vaes(void)
+{
+  __builtin_cpu_init(); // In case this runs from a constructor before libgcc's
+  return __builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f") &&
+         __builtin_cpu_supports("avx512bw");
+}
+
+// The AES-512 kernels for this CPU, probed on first use and then a single
+// load. Threads racing on the first call store the same pointer.
+static const struct aes_kernels* kernels512_selected;
+
+static const struct aes_kernels* kernels512_for_cpu(void)
+{
+  const struct aes_kernels* k = __atomic_load_n(&kernels512_selected, __ATOMIC_RELAXED);
+  if (k == NULL) {
+    k = have_vaes() ? &kernels512_vaes : &kernels512;
+    __atomic_store_n(&kernels512_selected, k, __ATOMIC_RELAXED);
+  }
+  return k;
+}
+#endif
+
+// Returns the kernels for a context's round count, or NULL if the context was
+// never initialised (or for a key size that is not compiled in).
+static const struct aes_kernels* kernels_for(const struct AES_ctx* ctx)
+{
+  switch (ctx->Nr) {
+#if defined(AES128) && (AES128 == 1)
+  case 10: return &kernels128;
+#endif
+#if defined(AES192) && (AES192 == 1)
+  case 12: return &kernels192;
+#endif
+#if defined(AES256) && (AES256 == 1)
+  case 14: return &kernels256;
+#endif
+#if defined(AES512) && (AES512 == 1)
+#if defined(AES_VAES) && AES_VAES
+  case 22: return kernels512_for_cpu();
+#else
+  case 22: return &kernels512;
+#endif
+#endif
+  default: return NULL;
+  }
+}
+
+static void gcm_precompute(struct AES_ctx* ctx);
+
+int AES_init_ctx_keylen(struct AES_ctx* ctx, const uint8_t* key, size_t key_len)
+{
+  unsigned Nk;
+
+  if (ctx == NULL || key == NULL) {
+    return -1;
+  }
+  switch (key_len) {
+#if defined(AES128) && (AES128 == 1)
+  case 16:
+#endif
+#if defined(AES192) && (AES192 == 1)
+  case 24:
+#endif
+#if defined(AES256) && (AES256 == 1)
+  case 32:
+#endif
+#if defined(AES512) && (AES512 == 1)
+  case 64:
+#endif
+    break;
+  default:
+    return -1; // Key size not supported (or not compiled in)
+  }
+
+  // Unused round keys and padding are zeroed too, so two contexts for the same
+  // key are byte-for-byte identical
+  memset(ctx, 0, sizeof(*ctx));
+  Nk = (unsigned)(key_len / 4);
+  ctx->Nr = (uint8_t)(Nk + 6);
+  KeyExpansion(ctx->RoundKey, key, Nk, ctx->Nr);
+
+  // Precompute the GHASH subkey H = E_K(0^128) once per key
+  kernels_for(ctx)->cipher((state_t*)ctx->H, ctx->RoundKey);
+  gcm_precompute(ctx);
+  return 0;
+}
+
+struct AES_ctx* AES_ctx_alloc(void)
+{
+  struct AES_ctx* ctx;
+#if defined(_WIN32)
+  ctx = (struct AES_ctx*)_aligned_malloc(sizeof(*ctx), AES_CTX_ALIGN);
+#else
+  ctx = (struct AES_ctx*)aligned_alloc(AES_CTX_ALIGN, sizeof(*ctx)); // sizeof is a multiple of the alignment
+#endif
+  if (ctx != NULL) {
+    memset(ctx, 0, sizeof(*ctx));
+  }
+  return ctx;
+}
+
+void AES_ctx_free(struct AES_ctx* ctx)
+{
+  if (ctx == NULL) {
+    return;
+  }
+  // Zero through a volatile pointer so the wipe is not elided before free
+  volatile uint8_t* p = (volatile uint8_t*)ctx;
+  for (size_t i = 0; i < sizeof(*ctx); ++i) {
+    p[i] = 0;
+  }
+#if defined(_WIN32)
+  _aligned_free(ctx);
+#else
+  free(ctx);
+#endif
+}
+
+void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key)
+{
+  (void)AES_init_ctx_keylen(ctx, key, AES_KEYLEN);
+}
+
+
+int AES_encrypt_blocks(const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, size_t nblocks)
+{
+  if (ctx == NULL || ((in == NULL || out == NULL) && nblocks > 0) || nblocks > SIZE_MAX / AES_BLOCKLEN) {
+    return -1;
+  }
+  const struct aes_kernels* kernels = kernels_for(ctx);
+  if (kernels == NULL) {
+    return -1; // Context not initialised
+  }
+  kernels->encrypt_blocks(ctx->RoundKey, in, out, nblocks);
+  return 0;
+}
+
+// --- CTR ---
+// The kernels step only the low 32 bits of the counter (GCM's inc32), so the
+// buffer is split where that word wraps and the carry is added to the upper
+// 96 bits in between.
+
+// Adds n to the big-endian integer in c[0..len).
+static void ctr_add(uint8_t* c, size_t len, uint64_t n)
+{
+  unsigned carry = 0;
+  for (size_t i = len; i-- > 0 && (n != 0 || carry != 0); n >>= 8) {
+    unsigned v = c[i] + (unsigned)(n & 0xff) + carry;
+    c[i] = (uint8_t)v;
+    carry = v >> 8;
+  }
+}
+
+int AES_CTR_xcrypt(const struct AES_ctx* ctx, const uint8_t counter[AES_BLOCKLEN], uint64_t block_offset,
+                   const uint8_t* in, uint8_t* out, size_t len)
+{
+  if (ctx == NULL || counter == NULL || ((in == NULL || out == NULL) && len > 0)) {
+    return -1;
+  }
+  const struct aes_kernels* kernels = kernels_for(ctx);
+  if (kernels == NULL) {
+    return -1; // Context not initialised
+  }
+  uint8_t c[AES_BLOCKLEN];
+  memcpy(c, counter, AES_BLOCKLEN);
+  ctr_add(c, AES_BLOCKLEN, block_offset);
+  if (len > 0 && out != in) {
+    memcpy(out, in, len);
+  }
+  while (len > 0) {
+    uint32_t low = ((uint32_t)c[12] << 24) | ((uint32_t)c[13] << 16) | ((uint32_t)c[14] << 8) | c[15];
+    uint64_t run = ((uint64_t)1 << 32) - low; // Blocks until the low word wraps
+    size_t n = (uint64_t)len / AES_BLOCKLEN < run ? len : (size_t)(run * AES_BLOCKLEN);
+    kernels->ctr_xcrypt(ctx->RoundKey, c, out, n);
+    out += n;
+    len -= n;
+    if (len > 0) {
+      ctr_add(c, AES_BLOCKLEN - 4, 1); // The low word wrapped to 0
+    }
+  }
+  return 0;
+}
+
+int AES_CTR_keystream(const struct AES_ctx* ctx, const uint8_t counter[AES_BLOCKLEN], uint64_t block_offset,
+                      uint8_t* out, size_t len)
+{
+  if (out == NULL && len > 0) {
+    return -1;
+  }
+  if (len > 0) {
+    memset(out, 0, len);
+  }
+  return AES_CTR_xcrypt(ctx, counter, block_offset, out, out, len);
+}
+
+
+// --- Statistics ---
+// Each thread owns a block of counters, allocated on first use and linked into
+// a global list so snapshots can sum them. The owner updates its counters
+// with relaxed load/store pairs (plain moves, no lock prefix); readers load
+// them atomically. A thread's counters are folded into stats_retired when it
+// exits. Resetting records the current totals as a base instead of writing
+// other threads' counters.
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AES__)
+  #define AES_CIPHER_BACKEND "aesni"
+#else
+  #define AES_CIPHER_BACKEND "portable"
+#endif
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(AES_HAVE_PCLMUL) && defined(__SSE2__)
+  #define AES_GHASH_BACKEND "pclmul"
+#else
+  #define AES_GHASH_BACKEND "portable"
+#endif
+#define AES_BACKEND_NAME AES_CIPHER_BACKEND "+" AES_GHASH_BACKEND
+
+#if AES_GCM_STATS
+
+enum {
+  STAT_SEAL_MESSAGES,
+  STAT_SEAL_BYTES,
+  STAT_OPEN_MESSAGES,
+  STAT_OPEN_BYTES,
+  STAT_AUTH_FAILURES,
+  STAT_VERIFY_MESSAGES,
+  STAT_VERIFY_BYTES,
+  STAT_VERIFY_FAILURES,
+  STAT_IV_SLOW_PATH,
+  STAT_CTR_NS,
+  STAT_GHASH_NS,
+  STAT_COUNT
+};
+
+struct stats_block {
+  _Atomic uint64_t v[STAT_COUNT];
+  struct stats_block* prev;
+  struct stats_block* next;
+};
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct stats_block* stats_threads;   // Live threads (under stats_lock)
+static uint64_t stats_retired[STAT_COUNT];  // Exited threads (under stats_lock)
+static uint64_t stats_base[STAT_COUNT];     // Totals at the last reset (under stats_lock)
+static pthread_key_t stats_key;
+static pthread_once_t stats_key_once = PTHREAD_ONCE_INIT;
+static _Thread_local struct stats_block* stats_self;
+
+static void stats_thread_exit(void* arg) {
+  struct stats_block* b = (struct stats_block*)arg;
+  pthread_mutex_lock(&stats_lock);
+  for (int i = 0; i < STAT_COUNT; ++i) {
+    stats_retired[i] += atomic_load_explicit(&b->v[i], memory_order_relaxed);
+  }
+  if (b->prev) {
+    b->prev->next = b->next;
+  } else {
+    stats_threads = b->next;
+  }
+  if (b->next) {
+    b->next->prev = b->prev;
+  }
+  pthread_mutex_unlock(&stats_lock);
+  free(b);
+}
+
+static void stats_make_key(void) {
+  (void)pthread_key_create(&stats_key, stats_thread_exit);
+}
+
+static struct stats_block* stats_register(void) {
+  struct stats_block* b = (struct stats_block*)calloc(1, sizeof(*b));
+  if (b == NULL) {
+    return NULL; // Counts from this call are dropped; retried on the next one
+  }
+  pthread_once(&stats_key_once, stats_make_key);
+  pthread_mutex_lock(&stats_lock);
+  b->next = stats_threads;
+  if (stats_threads) {
+    stats_threads->prev = b;
+  }
+  stats_threads = b;
+  pthread_mutex_unlock(&stats_lock);
+  (void)pthread_setspecific(stats_key, b);
+  stats_self = b;
+  return b;
+}
+
+static void stats_add(int counter, uint64_t n) {
+  struct stats_block* b = stats_self ? stats_self : stats_register();
+  if (b != NULL) {
+    uint64_t v = atomic_load_explicit(&b->v[counter], memory_order_relaxed);
+    atomic_store_explicit(&b->v[counter], v + n, memory_order_relaxed);
+  }
+}
+
+static uint64_t stats_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Sums all threads into totals; stats_lock must be held.
+static void stats_totals(uint64_t totals[STAT_COUNT]) {
+  memcpy(totals, stats_retired, sizeof(stats_retired));
+  for (const struct stats_block* b = stats_threads; b != NULL; b = b->next) {
+    for (int i = 0; i < STAT_COUNT; ++i) {
+      totals[i] += atomic_load_explicit(&b->v[i], memory_order_relaxed);
+    }
+  }
+}
+
+  #define STATS_ADD(counter, n) stats_add(STAT_##counter, (uint64_t)(n))
+  // Starts a timer; STATS_LAP charges the time since the last start/lap to counter.
+  #define STATS_TIMER(t) uint64_t t = stats_now_ns()
+  #define STATS_LAP(counter, t)                 \
+    do {                                        \
+      uint64_t stats_now_ = stats_now_ns();     \
+      stats_add(STAT_##counter, stats_now_ - t); \
+      t = stats_now_;                           \
+    } while (0)
+
+#else
+
+  #define STATS_ADD(counter, n) ((void)0)
+  #define STATS_TIMER(t) ((void)0)
+  #define STATS_LAP(counter, t) ((void)0)
+
+#endif // AES_GCM_STATS
+
+int AES_GCM_stats_snapshot(struct AES_GCM_stats* out)
+{
+  if (out == NULL) {
+    return -1;
+  }
+  memset(out, 0, sizeof(*out));
+  out->backend = AES_BACKEND_NAME;
+#if AES_GCM_STATS
+  uint64_t totals[STAT_COUNT];
+  pthread_mutex_lock(&stats_lock);
+  stats_totals(totals);
+  for (int i = 0; i < STAT_COUNT; ++i) {
+    totals[i] -= stats_base[i];
+  }
+  pthread_mutex_unlock(&stats_lock);
+  out->seal_messages = totals[STAT_SEAL_MESSAGES];
+  out->seal_bytes = totals[STAT_SEAL_BYTES];
+  out->open_messages = totals[STAT_OPEN_MESSAGES];
+  out->open_bytes = totals[STAT_OPEN_BYTES];
+  out->auth_failures = totals[STAT_AUTH_FAILURES];
+  out->verify_messages = totals[STAT_VERIFY_MESSAGES];
+  out->verify_bytes = totals[STAT_VERIFY_BYTES];
+  out->verify_failures = totals[STAT_VERIFY_FAILURES];
+  out->iv_slow_path = totals[STAT_IV_SLOW_PATH];
+  out->ctr_ns = totals[STAT_CTR_NS];
+  out->ghash_ns = totals[STAT_GHASH_NS];
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+void AES_GCM_stats_reset(void)
+{
+#if AES_GCM_STATS
+  pthread_mutex_lock(&stats_lock);
+  stats_totals(stats_base);
+  pthread_mutex_unlock(&stats_lock);
+#endif
+}
+
+
+// --- Tracing ---
+// USDT (user-level statically defined tracing) probes on AES_GCM_encrypt,
+// AES_GCM_decrypt and AES_GCM_verify, for bpftrace/perf (see tools/aesgcm_latency.bt). Each probe
+// is a single nop until a tracer attaches. They are compiled in whenever
+// <sys/sdt.h> (systemtap-sdt-dev) is available; -DAES_GCM_USDT=0 removes them.
+//
+//   aesgcm:seal_entry(pt_len, aad_len, iv_len, backend)   aesgcm:seal_return(pt_len, ret)
+//   aesgcm:open_entry(ct_len, aad_len, iv_len, backend)   aesgcm:open_return(ct_len, ret)
+//   aesgcm:verify_entry(ct_len, aad_len, iv_len, backend) aesgcm:verify_return(ct_len, ret)
+#ifndef AES_GCM_USDT
+  #if defined(__linux__) && defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+      #define AES_GCM_USDT 1
+    #endif
+  #endif
+#endif
+#if defined(AES_GCM_USDT) && AES_GCM_USDT
+  #include <sys/sdt.h>
+  #define TRACE_ENTRY(probe, len, aad_len, iv_len) \
+    DTRACE_PROBE4(aesgcm, probe, (uint64_t)(len), (uint64_t)(aad_len), (uint64_t)(iv_len), AES_BACKEND_NAME)
+  #define TRACE_RETURN(probe, len, ret) DTRACE_PROBE2(aesgcm, probe, (uint64_t)(len), (int)(ret))
+#else
+  #define TRACE_ENTRY(probe, len, aad_len, iv_len) ((void)0)
+  #define TRACE_RETURN(probe, len, ret) ((void)0)
+#endif
+
 
 // --- GCM Implementation ---
 
@@ -619,50 +1292,102 @@ static void AES_CTR_xcrypt_buffer(const struct AES_ctx* ctx, uint8_t* current_co
 // We only need the lowest byte for the bitwise implementation: 0xE1
 #define GCM_POLYNOMIAL 0xE1
 
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(AES_HAVE_PCLMUL) && defined(__SSE2__)
+// GHASH operands are bit-reflected relative to the carry-less multiplier's
+// polynomial order. Reversing the bytes (and folding the remaining bit shift
+// into the multiplication below) lines the two up. SSE2 only, no PSHUFB needed.
+static inline __m128i ghash_load_reflected(const uint8_t b[16]) {
+    uint64_t lo, hi;
+    memcpy(&lo, b, 8);
+    memcpy(&hi, b + 8, 8);
+    return _mm_set_epi64x((long long)__builtin_bswap64(lo), (long long)__builtin_bswap64(hi));
+}
+
+static inline void ghash_store_reflected(__m128i v, uint8_t b[16]) {
+    uint64_t q[2];
+    _mm_storeu_si128((__m128i*)q, v);
+    q[0] = __builtin_bswap64(q[0]);
+    q[1] = __builtin_bswap64(q[1]);
+    memcpy(b, &q[1], 8);
+    memcpy(b + 8, &q[0], 8);
+}
+
+// The multiply follows Intel's "Carry-Less Multiplication and Its Usage for
+// Computing the GCM Mode" (Algorithm 5): schoolbook carry-less multiply, shift
+// left by one to undo the bit reflection, then reduce modulo
+// x^128 + x^7 + x^2 + x + 1. Shift and reduction are linear, so products can
+// be XORed together first and reduced once (ghash_update_ctx).
+
+// 256-bit carry-less product <*hi:*lo> of a and b, not shifted or reduced.
+static inline void ghash_clmul(__m128i a, __m128i b, __m128i* lo, __m128i* hi) {
+    __m128i tmp3, tmp4, tmp5, tmp6;
+
+    // Perform carry-less multiplications
+    tmp3 = _mm_clmulepi64_si128(a, b, 0x00); // a_low * b_low
+    tmp4 = _mm_clmulepi64_si128(a, b, 0x10); // a_low * b_high
+    tmp5 = _mm_clmulepi64_si128(a, b, 0x01); // a_high * b_low
+    tmp6 = _mm_clmulepi64_si128(a, b, 0x11); // a_high * b_high
+
+    // Combine into the 256-bit product <tmp6:tmp3>
+    tmp4 = _mm_xor_si128(tmp4, tmp5);
+    tmp5 = _mm_slli_si128(tmp4, 8);
+    tmp4 = _mm_srli_si128(tmp4, 8);
+    *lo = _mm_xor_si128(tmp3, tmp5);
+    *hi = _mm_xor_si128(tmp6, tmp4);
+}
+
+// Shifts a (sum of) ghash_clmul product(s) left by one and reduces it.
+static inline __m128i ghash_reduce(__m128i tmp3, __m128i tmp6) {
+    __m128i tmp2, tmp4, tmp5, tmp7, tmp8, tmp9;
+
+    // Shift the product left by one bit (bit-reflection correction)
+    tmp7 = _mm_srli_epi32(tmp3, 31);
+    tmp8 = _mm_srli_epi32(tmp6, 31);
+    tmp3 = _mm_slli_epi32(tmp3, 1);
+    tmp6 = _mm_slli_epi32(tmp6, 1);
+    tmp9 = _mm_srli_si128(tmp7, 12);
+    tmp8 = _mm_slli_si128(tmp8, 4);
+    tmp7 = _mm_slli_si128(tmp7, 4);
+    tmp3 = _mm_or_si128(tmp3, tmp7);
+    tmp6 = _mm_or_si128(tmp6, tmp8);
+    tmp6 = _mm_or_si128(tmp6, tmp9);
+
+    // Reduction, first phase
+    tmp7 = _mm_slli_epi32(tmp3, 31);
+    tmp8 = _mm_slli_epi32(tmp3, 30);
+    tmp9 = _mm_slli_epi32(tmp3, 25);
+    tmp7 = _mm_xor_si128(tmp7, tmp8);
+    tmp7 = _mm_xor_si128(tmp7, tmp9);
+    tmp8 = _mm_srli_si128(tmp7, 4);
+    tmp7 = _mm_slli_si128(tmp7, 12);
+    tmp3 = _mm_xor_si128(tmp3, tmp7);
+
+    // Reduction, second phase
+    tmp2 = _mm_srli_epi32(tmp3, 1);
+    tmp4 = _mm_srli_epi32(tmp3, 2);
+    tmp5 = _mm_srli_epi32(tmp3, 7);
+    tmp2 = _mm_xor_si128(tmp2, tmp4);
+    tmp2 = _mm_xor_si128(tmp2, tmp5);
+    tmp2 = _mm_xor_si128(tmp2, tmp8);
+    tmp3 = _mm_xor_si128(tmp3, tmp2);
+    return _mm_xor_si128(tmp6, tmp3);
+}
+#endif
+
 // Galois Field (GF(2^128)) Multiplication (ghash_gmul)
 // Multiplies x by y in GF(2^128) using the GCM polynomial R.
-// Includes placeholders for architecture-specific optimizations (PCLMULQDQ, PMULL).
-// The C implementation below serves as a portable fallback.
+// Uses PCLMULQDQ where available; the C implementation below serves as a
+// portable fallback. res may alias x or y.
 // Input x, y, Output res are 16 bytes (128 bits) treated as polynomials.
 static void ghash_gmul(const uint8_t x[16], const uint8_t y[16], uint8_t res[16]) {
 
 // --- Architecture-Specific Optimizations --- 
 #if defined(__x86_64__) || defined(_M_X64)
-    #if defined(__PCLMULQDQ__) && defined(__SSE2__)
-        // PCLMULQDQ intrinsic version for x86-64 (Illustrative - Reduction missing/simplified)
-        // Based on Intel's Carry-Less Multiplication instruction whitepaper/examples
-        // WARNING: Correct reduction implementation is complex and crucial for security.
-        // This example only shows the multiplication part, NOT the full reduction.
-        
-        __m128i h = _mm_loadu_si128((const __m128i*)x); // Load H (already byte-reversed if needed)
-        __m128i t = _mm_loadu_si128((const __m128i*)y); // Load Tag/Data (ensure byte order)
-
-        // Perform carry-less multiplications
-        __m128i tmp2 = _mm_clmulepi64_si128(h, t, 0x00); // H_low * T_low
-        __m128i tmp3 = _mm_clmulepi64_si128(h, t, 0x11); // H_high * T_high
-        __m128i tmp4 = _mm_clmulepi64_si128(h, t, 0x10); // H_high * T_low
-        __m128i tmp5 = _mm_clmulepi64_si128(h, t, 0x01); // H_low * T_high
-
-        // XOR intermediates
-        __m128i tmp6 = _mm_xor_si128(tmp4, tmp5); // tmp4 ^ tmp5
-        __m128i tmp7 = _mm_slli_si128(tmp6, 8);   // Shift left 64 bits
-        __m128i tmp8 = _mm_srli_si128(tmp6, 8);   // Shift right 64 bits
-        __m128i tmp9 = _mm_xor_si128(tmp2, tmp7); // tmp2 ^ shifted_tmp6_left
-        __m128i tmp10 = _mm_xor_si128(tmp3, tmp8);// tmp3 ^ shifted_tmp6_right
-        __m128i result_no_reduction = _mm_xor_si128(tmp9, tmp10); // Intermediate 256-bit result (lower 128 bits)
-
-        // ****** IMPORTANT: POLYNOMIAL REDUCTION STEP IS MISSING HERE ******
-        // The result_no_reduction needs to be reduced modulo the GCM polynomial (x^128 + x^7 + x^2 + x + 1)
-        // Implementing this reduction efficiently and correctly using intrinsics 
-        // (e.g., more PCLMULQDQ, shifts, XORs) is non-trivial and omitted for brevity/complexity.
-        // A naive C implementation of reduction would defeat the purpose.
-        // Refer to Intel documentation or optimized libraries (OpenSSL) for complete reduction.
-        
-        // Placeholder: Just copy the unreduced lower 128 bits for illustration
-        _mm_storeu_si128((__m128i*)res, result_no_reduction);
-        
-        // If reduction were implemented correctly, we would return here.
-        // printf("Warning: PCLMULQDQ path used, but reduction is NOT implemented!\n");
+    #if defined(AES_HAVE_PCLMUL) && defined(__SSE2__)
+        // PCLMULQDQ version (ghash_clmul and ghash_reduce)
+        __m128i lo, hi;
+        ghash_clmul(ghash_load_reflected(x), ghash_load_reflected(y), &lo, &hi);
+        ghash_store_reflected(ghash_reduce(lo, hi), res);
         return; 
     #endif
 #elif defined(__aarch64__)
@@ -680,18 +1405,19 @@ static void ghash_gmul(const uint8_t x[16], const uint8_t y[16], uint8_t res[16]
 // --- End Architecture-Specific Optimizations ---
 
     // --- Generic C Implementation (Fallback) ---
+    uint8_t Z[16];
     uint8_t V[16];
     int i, j;
 
-    memset(res, 0, 16); // Z = 0
-    memcpy(V, y, 16);   // V = y
+    memset(Z, 0, 16); // Z = 0 (accumulated separately so res may alias x)
+    memcpy(V, y, 16); // V = y
 
     for (i = 0; i < 16; ++i) { // Iterate over bytes of x
         for (j = 0; j < 8; ++j) { // Iterate over bits of x[i]
             // If the current bit of x is 1, XOR Z with V
             if ((x[i] >> (7 - j)) & 1) {
                 for(int k=0; k<16; ++k) {
-                    res[k] ^= V[k];
+                    Z[k] ^= V[k];
                 }
             }
 
@@ -710,7 +1436,8 @@ static void ghash_gmul(const uint8_t x[16], const uint8_t y[16], uint8_t res[16]
             }
         }
     }
-    // The result is now in res (Z)
+    // The result is now in Z
+    memcpy(res, Z, 16);
     // --- End Generic C Implementation ---
 }
 
@@ -745,29 +1472,57 @@ static void ghash_update(uint8_t S[16], const uint8_t H[16], const uint8_t* data
     }
 }
 
-// Helper to increment the counter block (last 4 bytes) - specific for GCM J0 prep
-static void increment_counter_j0(uint8_t counter[AES_BLOCKLEN]) {
-    for (int i = AES_BLOCKLEN - 1; i >= AES_BLOCKLEN - 4; --i) {
-        if (++counter[i] != 0) {
-            break;
+// ghash_update given H^2, H^3 and H^4 as well: with PCLMULQDQ, four blocks
+// are folded per reduction, as
+//   S' = (S ^ X0) * H^4 ^ X1 * H^3 ^ X2 * H^2 ^ X3 * H,
+// and the four multiplies are independent, unlike the chain in ghash_update.
+static void ghash_update_pow(uint8_t S[16], const uint8_t H[16], const uint8_t H2[16], const uint8_t H3[16],
+                             const uint8_t H4[16], const uint8_t* data, size_t len) {
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(AES_HAVE_PCLMUL) && defined(__SSE2__)
+    if (len >= 4 * AES_BLOCKLEN) {
+        const __m128i h1 = ghash_load_reflected(H);
+        const __m128i h2 = ghash_load_reflected(H2);
+        const __m128i h3 = ghash_load_reflected(H3);
+        const __m128i h4 = ghash_load_reflected(H4);
+        __m128i s = ghash_load_reflected(S);
+        for (; len >= 4 * AES_BLOCKLEN; data += 4 * AES_BLOCKLEN, len -= 4 * AES_BLOCKLEN) {
+            __m128i lo, hi, plo, phi;
+            ghash_clmul(_mm_xor_si128(s, ghash_load_reflected(data)), h4, &lo, &hi);
+            ghash_clmul(ghash_load_reflected(data + 16), h3, &plo, &phi);
+            lo = _mm_xor_si128(lo, plo);
+            hi = _mm_xor_si128(hi, phi);
+            ghash_clmul(ghash_load_reflected(data + 32), h2, &plo, &phi);
+            lo = _mm_xor_si128(lo, plo);
+            hi = _mm_xor_si128(hi, phi);
+            ghash_clmul(ghash_load_reflected(data + 48), h1, &plo, &phi);
+            s = ghash_reduce(_mm_xor_si128(lo, plo), _mm_xor_si128(hi, phi));
         }
+        ghash_store_reflected(s, S);
     }
+#else
+    (void)H2; (void)H3; (void)H4;
+#endif
+    ghash_update(S, H, data, len);
 }
 
-// Helper to encode length (as 64-bit big-endian) into the last 8 bytes of a block
-static void encode_length(uint64_t len_bits, uint8_t block[AES_BLOCKLEN]) {
+// ghash_update with the context's powers of H.
+static void ghash_update_ctx(uint8_t S[16], const struct AES_ctx* ctx, const uint8_t* data, size_t len) {
+    ghash_update_pow(S, ctx->H, ctx->H2, ctx->H3, ctx->H4, data, len);
+}
+
+// Helper to encode length (as 64-bit big-endian) into 8 bytes at out
+// Note: In GHASH final block, AAD len is in first 8, PT len in last 8, so callers
+// pass block or block + 8. IV hashing uses the last 8 bytes (block + 8).
+static void encode_length(uint64_t len_bits, uint8_t out[8]) {
     // Encode length in big-endian order
-    block[8]  = (uint8_t)(len_bits >> 56);
-    block[9]  = (uint8_t)(len_bits >> 48);
-    block[10] = (uint8_t)(len_bits >> 40);
-    block[11] = (uint8_t)(len_bits >> 32);
-    block[12] = (uint8_t)(len_bits >> 24);
-    block[13] = (uint8_t)(len_bits >> 16);
-    block[14] = (uint8_t)(len_bits >> 8);
-    block[15] = (uint8_t)(len_bits);
-    // Ensure first 8 bytes are zero if only encoding length
-    // Note: In GHASH final block, AAD len is in first 8, PT len in last 8
-    // This helper is used for both IV hashing (len in last 8) and final block (split)
+    out[0] = (uint8_t)(len_bits >> 56);
+    out[1] = (uint8_t)(len_bits >> 48);
+    out[2] = (uint8_t)(len_bits >> 40);
+    out[3] = (uint8_t)(len_bits >> 32);
+    out[4] = (uint8_t)(len_bits >> 24);
+    out[5] = (uint8_t)(len_bits >> 16);
+    out[6] = (uint8_t)(len_bits >> 8);
+    out[7] = (uint8_t)(len_bits);
 }
 
 // Constant-time memory comparison
@@ -789,152 +1544,685 @@ static int constant_time_memcmp(const void* ptr1, const void* ptr2, size_t num)
 }
 
 
-int AES_GCM_encrypt(struct AES_ctx* ctx, 
-                    const uint8_t* iv, size_t iv_len, 
-                    const uint8_t* aad, size_t aad_len, 
-                    const uint8_t* pt, uint8_t* ct, size_t pt_len, 
-                    uint8_t* tag)
+// Derives the initial counter block J0 from the IV (NIST SP 800-38D, 7.1 step 2).
+static void gcm_compute_j0(const struct AES_ctx* ctx, const uint8_t* iv, size_t iv_len, uint8_t J0[AES_BLOCKLEN]) {
+    static const uint8_t one32[4] = { 0, 0, 0, 1 };
+    if (iv_len == AES_GCM_IV_LEN) { // Standard 96-bit IV: J0 = IV || 0^31 || 1
+        memcpy(J0, iv, AES_GCM_IV_LEN);
+        memcpy(J0 + AES_GCM_IV_LEN, one32, sizeof(one32));
+        return;
+    }
+    STATS_ADD(IV_SLOW_PATH, 1);
+    if (iv_len == AES_BLOCKLEN) {
+        // GHASH(IV || L) = (IV * H ^ L) * H = IV * H^2 ^ L * H, and H^2 and
+        // L * H are fixed per key (gcm_precompute): one multiply instead of two
+        ghash_gmul(iv, ctx->H2, J0);
+        for (int k = 0; k < AES_BLOCKLEN; ++k) {
+            J0[k] ^= ctx->LH16[k];
+        }
+        return;
+    }
+    // Any other length: J0 = GHASH(IV || 0-pad || 0^64 || len(IV) in bits)
+    uint8_t len_block[16] = {0};
+    encode_length((uint64_t)iv_len * 8, len_block + 8);
+    memset(J0, 0, 16);
+    ghash_update_ctx(J0, ctx, iv, iv_len); // ghash_update pads the last block
+    ghash_update(J0, ctx->H, len_block, 16);
+}
+
+// Fills in the per-key GHASH values that AES_init_ctx_keylen caches after H.
+static void gcm_precompute(struct AES_ctx* ctx) {
+    uint8_t L[AES_BLOCKLEN] = {0};
+    encode_length(AES_BLOCKLEN * 8, L + 8);
+    ghash_gmul(ctx->H, ctx->H, ctx->H2);
+    ghash_gmul(ctx->H2, ctx->H, ctx->H3);
+    ghash_gmul(ctx->H2, ctx->H2, ctx->H4);
+    ghash_gmul(L, ctx->H, ctx->LH16);
+}
+
+// Sets counter to the counter block for message block block_offset, i.e.
+// inc32(J0) advanced by block_offset (the low 32 bits wrap, as in GCM).
+static void gcm_counter_at(const uint8_t J0[AES_BLOCKLEN], uint64_t block_offset, uint8_t counter[AES_BLOCKLEN]) {
+    uint32_t ctr = ((uint32_t)J0[12] << 24) | ((uint32_t)J0[13] << 16) | ((uint32_t)J0[14] << 8) | (uint32_t)J0[15];
+    ctr += 1 + (uint32_t)block_offset; // J0 + 1 is the first block's counter
+    memcpy(counter, J0, 12);
+    counter[12] = (uint8_t)(ctr >> 24);
+    counter[13] = (uint8_t)(ctr >> 16);
+    counter[14] = (uint8_t)(ctr >> 8);
+    counter[15] = (uint8_t)(ctr);
+}
+
+// Calculates the tag T = GHASH(S || len(A) || len(C)) ^ E_K(J0).
+static void gcm_tag(const struct aes_kernels* kernels, const struct AES_ctx* ctx, const uint8_t J0[AES_BLOCKLEN],
+                    const uint8_t S[AES_BLOCKLEN], uint64_t aad_len, uint64_t ct_len, uint8_t tag[AES_GCM_TAG_LEN]) {
+    uint8_t GCM_S[AES_BLOCKLEN];
+    uint8_t EK0[AES_BLOCKLEN];
+    uint8_t final_len_block[16] = {0};
+
+    memcpy(EK0, J0, AES_BLOCKLEN);
+    kernels->cipher((state_t*)EK0, ctx->RoundKey); // Calculate E_K(J0)
+
+    memcpy(GCM_S, S, AES_BLOCKLEN);
+    encode_length(aad_len * 8, final_len_block);    // AAD length in bits
+    encode_length(ct_len * 8, final_len_block + 8); // CT length in bits
+    ghash_update(GCM_S, ctx->H, final_len_block, 16);
+
+    for (int i = 0; i < AES_GCM_TAG_LEN; ++i) {
+        tag[i] = GCM_S[i] ^ EK0[i];
+    }
+}
+
+// Tag lengths allowed by SP 800-38D 5.2.1.2: 128, 120, 112, 104 and 96 bits,
+// and 64 and 32 bits for applications that bound their use (Appendix C).
+static int gcm_tag_len_valid(size_t tag_len) {
+    switch (tag_len) {
+    case 16: case 15: case 14: case 13: case 12: case 8: case 4:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Multiplies X by H^n in place (square-and-multiply over the bits of n).
+static void ghash_mul_hpow(uint8_t X[AES_BLOCKLEN], const uint8_t H[AES_BLOCKLEN], uint64_t n) {
+    uint8_t P[AES_BLOCKLEN]; // H^(2^i)
+    memcpy(P, H, AES_BLOCKLEN);
+    while (n != 0) {
+        if (n & 1) {
+            ghash_gmul(X, P, X);
+        }
+        n >>= 1;
+        if (n != 0) {
+            ghash_gmul(P, P, P);
+        }
+    }
+}
+
+// Body of AES_GCM_encrypt (which wraps it in the trace probes).
+// J0 is derived from iv unless j0 is given.
+static int gcm_encrypt(const struct AES_ctx* ctx, 
+                       const uint8_t* iv, size_t iv_len, const uint8_t* j0,
+                       const uint8_t* aad, size_t aad_len, 
+                       const uint8_t* pt, uint8_t* ct, size_t pt_len, 
+                       uint8_t* tag, size_t tag_len)
 {
-    if (iv_len == 0 || (aad == NULL && aad_len > 0) || (pt == NULL && pt_len > 0) || ct == NULL || tag == NULL) {
+    if (ctx == NULL || (j0 == NULL && (iv == NULL || iv_len == 0)) || (aad == NULL && aad_len > 0) || (pt == NULL && pt_len > 0) || (ct == NULL && pt_len > 0) || tag == NULL || !gcm_tag_len_valid(tag_len)) {
         return -1; // Invalid arguments
     }
-    // Removed IV length check, now supporting other lengths
-    // if (iv_len != AES_GCM_IV_LEN) { ... return -2; }
+    const struct aes_kernels* kernels = kernels_for(ctx);
+    if (kernels == NULL) {
+        return -1; // Context not initialised
+    }
 
-    uint8_t H[AES_BLOCKLEN] = {0};      // Hash subkey
     uint8_t J0[AES_BLOCKLEN];           // Initial counter block derived from IV
-    uint8_t GCM_S[AES_BLOCKLEN] = {0};  // GHASH state (used for AAD/CT and potentially IV)
-    uint8_t EK0[AES_BLOCKLEN];          // Encrypted initial counter block E_K(J0)
-
-    // 1. Generate H = E_K(0^128)
-    Cipher((state_t*)H, ctx->RoundKey);
+    uint8_t GCM_S[AES_BLOCKLEN] = {0};  // GHASH state for AAD/CT
+    STATS_TIMER(t);
 
+    // 1. H = E_K(0^128) was precomputed by AES_init_ctx_keylen
     // 2. Prepare J0 (Initial Counter Block)
-    if (iv_len == AES_GCM_IV_LEN) { // Standard 96-bit IV case
-        memcpy(J0, iv, iv_len); // iv_len is 12
-        memset(J0 + iv_len, 0, AES_BLOCKLEN - iv_len - 1); // Zero pad
-        J0[AES_BLOCKLEN - 1] = 1; // Set last byte to 1
-    } else { // IV length is not 96 bits - use GHASH
-        uint8_t len_block[16] = {0};
-        uint64_t iv_len_bits = (uint64_t)iv_len * 8;
-        encode_length(iv_len_bits, len_block + 8); // Encode IV length in bits at the end
-
-        memset(GCM_S, 0, 16); // Initialize GHASH state for IV processing
-        ghash_update(GCM_S, H, iv, iv_len);       // GHASH the IV (ghash_update handles padding)
-        ghash_update(GCM_S, H, len_block, 16);  // GHASH the length block
-        memcpy(J0, GCM_S, 16); // Resulting hash is J0
-
-        // Reset GCM_S for AAD/CT processing
-        memset(GCM_S, 0, 16);
-    }
-    
-    memcpy(EK0, J0, AES_BLOCKLEN); // Keep copy of J0 for tag calc
-    Cipher((state_t*)EK0, ctx->RoundKey); // Calculate E_K(J0)
+    if (j0 != NULL) {
+        memcpy(J0, j0, AES_BLOCKLEN);
+    } else {
+        gcm_compute_j0(ctx, iv, iv_len, J0);
+    }
 
     // 3. Process AAD with GHASH
-    ghash_update(GCM_S, H, aad, aad_len);
+    ghash_update_ctx(GCM_S, ctx, aad, aad_len);
+    STATS_LAP(GHASH_NS, t);
 
     // 4. Encrypt Plaintext using CTR mode (starting counter is J0+1)
     uint8_t current_counter[AES_BLOCKLEN];
-    memcpy(current_counter, J0, AES_BLOCKLEN);
-    increment_counter_j0(current_counter); // counter = J0 + 1
+    gcm_counter_at(J0, 0, current_counter); // counter = J0 + 1
     if (pt_len > 0) {
-        memcpy(ct, pt, pt_len); // Copy plaintext to ciphertext buffer for in-place encryption
-        AES_CTR_xcrypt_buffer(ctx, current_counter, ct, pt_len);
+        if (ct != pt) memcpy(ct, pt, pt_len); // Copy plaintext to ciphertext buffer for in-place encryption
+        kernels->ctr_xcrypt(ctx->RoundKey, current_counter, ct, pt_len);
     }
+    STATS_LAP(CTR_NS, t);
 
     // 5. Process Ciphertext with GHASH
-    ghash_update(GCM_S, H, ct, pt_len);
+    ghash_update_ctx(GCM_S, ctx, ct, pt_len);
+
+    // 6-7. Final GHASH block with lengths, Tag T = GHASH_result ^ E_K(J0)
+    if (tag_len == AES_GCM_TAG_LEN) {
+        gcm_tag(kernels, ctx, J0, GCM_S, aad_len, pt_len, tag);
+    } else {
+        uint8_t full_tag[AES_GCM_TAG_LEN];
+        gcm_tag(kernels, ctx, J0, GCM_S, aad_len, pt_len, full_tag);
+        memcpy(tag, full_tag, tag_len); // The leftmost tag_len bytes (SP 800-38D, 7.1 step 6)
+    }
+    STATS_LAP(GHASH_NS, t);
 
-    // 6. Calculate final GHASH block with lengths
-    uint8_t final_len_block[16] = {0};
-    encode_length((uint64_t)aad_len * 8, final_len_block);    // AAD length in bits
-    encode_length((uint64_t)pt_len * 8, final_len_block + 8); // PT length in bits
-    ghash_update(GCM_S, H, final_len_block, 16);
+    STATS_ADD(SEAL_MESSAGES, 1);
+    STATS_ADD(SEAL_BYTES, pt_len);
+    return 0; // Success
+}
 
-    // 7. Calculate Tag T = GHASH_result ^ E_K(J0)
-    for (int i = 0; i < AES_GCM_TAG_LEN; ++i) {
-        tag[i] = GCM_S[i] ^ EK0[i];
+// Recomputes the tag over aad and ct and compares it with the received one in
+// constant time. Shared by decryption, which runs CTR only once this passes,
+// and AES_GCM_verify, which never does; each counts its own failures.
+static int gcm_authenticate(const struct aes_kernels* kernels, const struct AES_ctx* ctx, const uint8_t J0[AES_BLOCKLEN],
+                            const uint8_t* aad, size_t aad_len, const uint8_t* ct, size_t ct_len,
+                            const uint8_t* tag, size_t tag_len) {
+    uint8_t GCM_S[AES_BLOCKLEN] = {0};  // GHASH state
+    uint8_t calculated_tag[AES_GCM_TAG_LEN];
+
+    ghash_update_ctx(GCM_S, ctx, aad, aad_len);
+    ghash_update_ctx(GCM_S, ctx, ct, ct_len);
+
+    // Final GHASH block with lengths, potential Tag T = GHASH_result ^ E_K(J0)
+    gcm_tag(kernels, ctx, J0, GCM_S, aad_len, ct_len, calculated_tag);
+
+    // Compare calculated tag with received tag (use constant-time compare!)
+    if (constant_time_memcmp(calculated_tag, tag, tag_len) != 0) {
+        return -3; // Authentication failed
     }
+    return 0;
+}
 
-    return 0; // Success
+// Body of AES_GCM_decrypt (which wraps it in the trace probes).
+static int gcm_decrypt(const struct AES_ctx* ctx, 
+                       const uint8_t* iv, size_t iv_len, const uint8_t* j0,
+                       const uint8_t* aad, size_t aad_len, 
+                       const uint8_t* ct, uint8_t* pt, size_t ct_len, 
+                       const uint8_t* tag, size_t tag_len)
+{
+    if (ctx == NULL || (j0 == NULL && (iv == NULL || iv_len == 0)) || (aad == NULL && aad_len > 0) || (ct == NULL && ct_len > 0) || (pt == NULL && ct_len > 0) || tag == NULL || !gcm_tag_len_valid(tag_len)) {
+        return -1; // Invalid arguments
+    }
+    const struct aes_kernels* kernels = kernels_for(ctx);
+    if (kernels == NULL) {
+        return -1; // Context not initialised
+    }
+
+    uint8_t J0[AES_BLOCKLEN];           // Initial counter block derived from IV
+    STATS_TIMER(t);
+
+    STATS_ADD(OPEN_MESSAGES, 1);
+    STATS_ADD(OPEN_BYTES, ct_len);
+
+    // 1. H = E_K(0^128) was precomputed by AES_init_ctx_keylen
+    // 2. Prepare J0 (Initial Counter Block) - Same logic as encryption
+    if (j0 != NULL) {
+        memcpy(J0, j0, AES_BLOCKLEN);
+    } else {
+        gcm_compute_j0(ctx, iv, iv_len, J0);
+    }
+
+    // 3-7. GHASH AAD and ciphertext, compare the tag
+    int auth = gcm_authenticate(kernels, ctx, J0, aad, aad_len, ct, ct_len, tag, tag_len);
+    STATS_LAP(GHASH_NS, t);
+    if (auth != 0) {
+        if (ct_len > 0) {
+            memset(pt, 0, ct_len); // Zero out plaintext buffer on tag mismatch
+        }
+        STATS_ADD(AUTH_FAILURES, 1);
+        return auth;
+    }
+
+    // 8. Decrypt Ciphertext using CTR mode (starting counter is J0+1)
+    uint8_t current_counter[AES_BLOCKLEN];
+    gcm_counter_at(J0, 0, current_counter); // counter = J0 + 1
+    if (ct_len > 0) {
+        if (pt != ct) memcpy(pt, ct, ct_len); // Copy ciphertext to plaintext buffer for in-place decryption
+        kernels->ctr_xcrypt(ctx->RoundKey, current_counter, pt, ct_len);
+    }
+    STATS_LAP(CTR_NS, t);
+
+    return 0; // Success (decryption ok, tag matched)
 }
 
-int AES_GCM_decrypt(struct AES_ctx* ctx, 
+int AES_GCM_encrypt(const struct AES_ctx* ctx, 
+                    const uint8_t* iv, size_t iv_len, 
+                    const uint8_t* aad, size_t aad_len, 
+                    const uint8_t* pt, uint8_t* ct, size_t pt_len, 
+                    uint8_t* tag)
+{
+    TRACE_ENTRY(seal_entry, pt_len, aad_len, iv_len);
+    int ret = gcm_encrypt(ctx, iv, iv_len, NULL, aad, aad_len, pt, ct, pt_len, tag, AES_GCM_TAG_LEN);
+    TRACE_RETURN(seal_return, pt_len, ret);
+    return ret;
+}
+
+int AES_GCM_decrypt(const struct AES_ctx* ctx, 
                     const uint8_t* iv, size_t iv_len, 
                     const uint8_t* aad, size_t aad_len, 
                     const uint8_t* ct, uint8_t* pt, size_t ct_len, 
                     const uint8_t* tag)
 {
-     if (iv_len == 0 || (aad == NULL && aad_len > 0) || (ct == NULL && ct_len > 0) || pt == NULL || tag == NULL) {
-        return -1; // Invalid arguments
+    TRACE_ENTRY(open_entry, ct_len, aad_len, iv_len);
+    int ret = gcm_decrypt(ctx, iv, iv_len, NULL, aad, aad_len, ct, pt, ct_len, tag, AES_GCM_TAG_LEN);
+    TRACE_RETURN(open_return, ct_len, ret);
+    return ret;
+}
+
+int AES_GCM_verify(const struct AES_ctx* ctx,
+                   const uint8_t* iv, size_t iv_len,
+                   const uint8_t* aad, size_t aad_len,
+                   const uint8_t* ct, size_t ct_len,
+                   const uint8_t* tag)
+{
+    TRACE_ENTRY(verify_entry, ct_len, aad_len, iv_len);
+    int ret = -1; // Invalid arguments
+    const struct aes_kernels* kernels = ctx != NULL ? kernels_for(ctx) : NULL;
+    if (kernels != NULL && iv != NULL && iv_len > 0 && (aad != NULL || aad_len == 0) && (ct != NULL || ct_len == 0) && tag != NULL) {
+        uint8_t J0[AES_BLOCKLEN];
+        STATS_TIMER(t);
+        STATS_ADD(VERIFY_MESSAGES, 1);
+        STATS_ADD(VERIFY_BYTES, ct_len);
+        gcm_compute_j0(ctx, iv, iv_len, J0);
+        ret = gcm_authenticate(kernels, ctx, J0, aad, aad_len, ct, ct_len, tag, AES_GCM_TAG_LEN);
+        STATS_LAP(GHASH_NS, t);
+        if (ret != 0) {
+            STATS_ADD(VERIFY_FAILURES, 1);
+        }
     }
-    // Removed IV length check, now supporting other lengths
-    // if (iv_len != AES_GCM_IV_LEN) { ... return -2; }
+    TRACE_RETURN(verify_return, ct_len, ret);
+    return ret;
+}
 
-    uint8_t H[AES_BLOCKLEN] = {0};      // Hash subkey
-    uint8_t J0[AES_BLOCKLEN];           // Initial counter block derived from IV
-    uint8_t GCM_S[AES_BLOCKLEN] = {0};  // GHASH state
-    uint8_t EK0[AES_BLOCKLEN];          // Encrypted initial counter block E_K(J0)
-    uint8_t calculated_tag[AES_GCM_TAG_LEN];
+int AES_GCM_encrypt_taglen(const struct AES_ctx* ctx,
+                           const uint8_t* iv, size_t iv_len,
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* pt, uint8_t* ct, size_t pt_len,
+                           uint8_t* tag, size_t tag_len)
+{
+    TRACE_ENTRY(seal_entry, pt_len, aad_len, iv_len);
+    int ret = gcm_encrypt(ctx, iv, iv_len, NULL, aad, aad_len, pt, ct, pt_len, tag, tag_len);
+    TRACE_RETURN(seal_return, pt_len, ret);
+    return ret;
+}
 
-    // 1. Generate H = E_K(0^128)
-    Cipher((state_t*)H, ctx->RoundKey);
+int AES_GCM_decrypt_taglen(const struct AES_ctx* ctx,
+                           const uint8_t* iv, size_t iv_len,
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* ct, uint8_t* pt, size_t ct_len,
+                           const uint8_t* tag, size_t tag_len)
+{
+    TRACE_ENTRY(open_entry, ct_len, aad_len, iv_len);
+    int ret = gcm_decrypt(ctx, iv, iv_len, NULL, aad, aad_len, ct, pt, ct_len, tag, tag_len);
+    TRACE_RETURN(open_return, ct_len, ret);
+    return ret;
+}
 
-    // 2. Prepare J0 (Initial Counter Block) - Same logic as encryption
-    if (iv_len == AES_GCM_IV_LEN) { // Standard 96-bit IV case
-         memcpy(J0, iv, iv_len);
-        memset(J0 + iv_len, 0, AES_BLOCKLEN - iv_len - 1); // Zero pad
-        J0[AES_BLOCKLEN - 1] = 1; // Set last byte to 1
-    } else { // IV length is not 96 bits - use GHASH
-        uint8_t len_block[16] = {0};
-        uint64_t iv_len_bits = (uint64_t)iv_len * 8;
-        encode_length(iv_len_bits, len_block + 8); // Encode IV length in bits at the end
+int AES_GCM_encrypt_j0(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN],
+                       const uint8_t* aad, size_t aad_len,
+                       const uint8_t* pt, uint8_t* ct, size_t pt_len,
+                       uint8_t* tag)
+{
+    if (j0 == NULL) {
+        return -1;
+    }
+    TRACE_ENTRY(seal_entry, pt_len, aad_len, AES_BLOCKLEN);
+    int ret = gcm_encrypt(ctx, NULL, 0, j0, aad, aad_len, pt, ct, pt_len, tag, AES_GCM_TAG_LEN);
+    TRACE_RETURN(seal_return, pt_len, ret);
+    return ret;
+}
 
-        memset(GCM_S, 0, 16); // Initialize GHASH state for IV processing
-        ghash_update(GCM_S, H, iv, iv_len);       // GHASH the IV
-        ghash_update(GCM_S, H, len_block, 16);  // GHASH the length block
-        memcpy(J0, GCM_S, 16); // Resulting hash is J0
+int AES_GCM_decrypt_j0(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN],
+                       const uint8_t* aad, size_t aad_len,
+                       const uint8_t* ct, uint8_t* pt, size_t ct_len,
+                       const uint8_t* tag)
+{
+    if (j0 == NULL) {
+        return -1;
+    }
+    TRACE_ENTRY(open_entry, ct_len, aad_len, AES_BLOCKLEN);
+    int ret = gcm_decrypt(ctx, NULL, 0, j0, aad, aad_len, ct, pt, ct_len, tag, AES_GCM_TAG_LEN);
+    TRACE_RETURN(open_return, ct_len, ret);
+    return ret;
+}
 
-        // Reset GCM_S for AAD/CT processing
-        memset(GCM_S, 0, 16);
+// --- GMAC ---
+// GCM with the data as AAD and an empty message: no CTR work beyond E_K(J0)
+// for the tag, and the data goes through the 4-block GHASH.
+
+int AES_GMAC(const struct AES_ctx* ctx, const uint8_t* iv, size_t iv_len,
+             const uint8_t* data, size_t len, uint8_t tag[AES_GCM_TAG_LEN])
+{
+    struct AES_GMAC_ctx g;
+    if (AES_GMAC_init(&g, ctx, iv, iv_len) != 0 || AES_GMAC_update(&g, data, len) != 0) {
+        return -1;
     }
+    return AES_GMAC_final(&g, tag);
+}
 
-    memcpy(EK0, J0, AES_BLOCKLEN); // Keep copy of J0 for tag calc
-    Cipher((state_t*)EK0, ctx->RoundKey); // Calculate E_K(J0)
+int AES_GMAC_verify(const struct AES_ctx* ctx, const uint8_t* iv, size_t iv_len,
+                    const uint8_t* data, size_t len, const uint8_t tag[AES_GCM_TAG_LEN])
+{
+    struct AES_GMAC_ctx g;
+    if (AES_GMAC_init(&g, ctx, iv, iv_len) != 0 || AES_GMAC_update(&g, data, len) != 0) {
+        return -1;
+    }
+    return AES_GMAC_final_verify(&g, tag);
+}
 
-    // 3. Process AAD with GHASH
-    ghash_update(GCM_S, H, aad, aad_len);
+int AES_GMAC_init(struct AES_GMAC_ctx* g, const struct AES_ctx* ctx, const uint8_t* iv, size_t iv_len)
+{
+    if (g == NULL || ctx == NULL || iv == NULL || iv_len == 0 || kernels_for(ctx) == NULL) {
+        return -1; // Invalid arguments or context not initialised
+    }
+    memset(g, 0, sizeof(*g));
+    g->key = ctx;
+    gcm_compute_j0(ctx, iv, iv_len, g->j0);
+    return 0;
+}
 
-    // 4. Process Ciphertext with GHASH
-    ghash_update(GCM_S, H, ct, ct_len);
+int AES_GMAC_update(struct AES_GMAC_ctx* g, const uint8_t* data, size_t len)
+{
+    if (g == NULL || g->key == NULL || (data == NULL && len > 0)) {
+        return -1;
+    }
+    size_t used = (size_t)(g->len % AES_BLOCKLEN);
+    g->len += len;
+    if (used > 0) { // Top up the buffered partial block first
+        size_t take = AES_BLOCKLEN - used < len ? AES_BLOCKLEN - used : len;
+        memcpy(g->buf + used, data, take);
+        if (used + take < AES_BLOCKLEN) {
+            return 0;
+        }
+        ghash_update(g->ghash, g->key->H, g->buf, AES_BLOCKLEN);
+        data += take;
+        len -= take;
+    }
+    size_t whole = len - len % AES_BLOCKLEN;
+    ghash_update_ctx(g->ghash, g->key, data, whole);
+    if (len > whole) {
+        memcpy(g->buf, data + whole, len - whole);
+    }
+    return 0;
+}
 
-    // 5. Calculate final GHASH block with lengths
-    uint8_t final_len_block[16] = {0};
-    encode_length((uint64_t)aad_len * 8, final_len_block);     // AAD length in bits
-    encode_length((uint64_t)ct_len * 8, final_len_block + 8);  // CT length in bits
-    ghash_update(GCM_S, H, final_len_block, 16);
+// Finishes the stream into tag and wipes it.
+static int gmac_final(struct AES_GMAC_ctx* g, uint8_t tag[AES_GCM_TAG_LEN])
+{
+    const struct aes_kernels* kernels = kernels_for(g->key);
+    size_t used = (size_t)(g->len % AES_BLOCKLEN);
+    if (used > 0) {
+        ghash_update(g->ghash, g->key->H, g->buf, used); // Zero-padded
+    }
+    gcm_tag(kernels, g->key, g->j0, g->ghash, g->len, 0, tag);
+    volatile uint8_t* p = (volatile uint8_t*)g;
+    for (size_t i = 0; i < sizeof(*g); ++i) {
+        p[i] = 0;
+    }
+    return 0;
+}
 
-    // 6. Calculate potential Tag T = GHASH_result ^ E_K(J0)
-    for (int i = 0; i < AES_GCM_TAG_LEN; ++i) {
-        calculated_tag[i] = GCM_S[i] ^ EK0[i];
+int AES_GMAC_final(struct AES_GMAC_ctx* g, uint8_t tag[AES_GCM_TAG_LEN])
+{
+    if (g == NULL || g->key == NULL || tag == NULL) {
+        return -1;
     }
+    return gmac_final(g, tag);
+}
 
-    // 7. Compare calculated tag with received tag (use constant-time compare!)
-    if (constant_time_memcmp(calculated_tag, tag, AES_GCM_TAG_LEN) != 0) {
-        memset(pt, 0, ct_len); // Zero out plaintext buffer on tag mismatch
+int AES_GMAC_final_verify(struct AES_GMAC_ctx* g, const uint8_t tag[AES_GCM_TAG_LEN])
+{
+    uint8_t expected[AES_GCM_TAG_LEN];
+    if (g == NULL || g->key == NULL || tag == NULL) {
+        return -1;
+    }
+    gmac_final(g, expected);
+    if (constant_time_memcmp(expected, tag, AES_GCM_TAG_LEN) != 0) {
         return -3; // Authentication failed
     }
+    return 0;
+}
 
-    // 8. Decrypt Ciphertext using CTR mode (starting counter is J0+1)
-    uint8_t current_counter[AES_BLOCKLEN];
-    memcpy(current_counter, J0, AES_BLOCKLEN);
-    increment_counter_j0(current_counter); // counter = J0 + 1
-    if (ct_len > 0) {
-         memcpy(pt, ct, ct_len); // Copy ciphertext to plaintext buffer for in-place decryption
-        AES_CTR_xcrypt_buffer(ctx, current_counter, pt, ct_len);
+// --- GHASH ---
+// The same kernels as GCM, for an H chosen by the caller. Like AES_GMAC_ctx, a
+// stream hashes whole blocks and buffers the bytes after them.
+
+int AES_GHASH_mul(const uint8_t x[AES_BLOCKLEN], const uint8_t y[AES_BLOCKLEN], uint8_t res[AES_BLOCKLEN])
+{
+    if (x == NULL || y == NULL || res == NULL) {
+        return -1;
     }
+    ghash_gmul(x, y, res);
+    return 0;
+}
 
-    return 0; // Success (decryption ok, tag matched)
+int AES_GHASH_init(struct AES_GHASH_ctx* g, const uint8_t H[AES_BLOCKLEN])
+{
+    if (g == NULL || H == NULL) {
+        return -1;
+    }
+    memset(g, 0, sizeof(*g));
+    memcpy(g->H, H, AES_BLOCKLEN);
+    ghash_gmul(g->H, g->H, g->H2);
+    ghash_gmul(g->H2, g->H, g->H3);
+    ghash_gmul(g->H2, g->H2, g->H4);
+    return 0;
+}
+
+int AES_GHASH_update(struct AES_GHASH_ctx* g, const uint8_t* data, size_t len)
+{
+    if (g == NULL || (data == NULL && len > 0)) {
+        return -1;
+    }
+    size_t used = (size_t)(g->len % AES_BLOCKLEN);
+    g->len += len;
+    if (used > 0) { // Top up the buffered partial block first
+        size_t take = AES_BLOCKLEN - used < len ? AES_BLOCKLEN - used : len;
+        memcpy(g->buf + used, data, take);
+        if (used + take < AES_BLOCKLEN) {
+            return 0;
+        }
+        ghash_update(g->state, g->H, g->buf, AES_BLOCKLEN);
+        data += take;
+        len -= take;
+    }
+    size_t whole = len - len % AES_BLOCKLEN;
+    ghash_update_pow(g->state, g->H, g->H2, g->H3, g->H4, data, whole);
+    if (len > whole) {
+        memcpy(g->buf, data + whole, len - whole);
+    }
+    return 0;
 }
 
+// Hashes the buffered partial block, zero-padded, and rounds len up to match.
+static void ghash_pad(struct AES_GHASH_ctx* g)
+{
+    size_t used = (size_t)(g->len % AES_BLOCKLEN);
+    if (used > 0) {
+        ghash_update(g->state, g->H, g->buf, used);
+        g->len += AES_BLOCKLEN - used;
+    }
+}
+
+int AES_GHASH_combine(struct AES_GHASH_ctx* g, const struct AES_GHASH_ctx* tail)
+{
+    // H is key material: compare it without an early exit
+    if (g == NULL || tail == NULL || g == tail || constant_time_memcmp(g->H, tail->H, AES_BLOCKLEN) != 0) {
+        return -1;
+    }
+    // As in AES_GCM_chunk_combine: g's state is scaled by H^n for the n
+    // (padded) blocks of the tail, and the tail's state XORed in.
+    struct AES_GHASH_ctx t = *tail;
+    ghash_pad(g);
+    ghash_pad(&t);
+    ghash_mul_hpow(g->state, g->H, t.len / AES_BLOCKLEN);
+    for (int i = 0; i < AES_BLOCKLEN; ++i) {
+        g->state[i] ^= t.state[i];
+    }
+    g->len += t.len;
+    return 0;
+}
+
+int AES_GHASH_final(struct AES_GHASH_ctx* g, uint8_t out[AES_BLOCKLEN])
+{
+    if (g == NULL || out == NULL) {
+        return -1;
+    }
+    ghash_pad(g);
+    memcpy(out, g->state, AES_BLOCKLEN);
+    volatile uint8_t* p = (volatile uint8_t*)g;
+    for (size_t i = 0; i < sizeof(*g); ++i) {
+        p[i] = 0;
+    }
+    return 0;
+}
+
+// --- IV prefixes ---
+// The prefix's whole blocks are GHASHed once; its remaining bytes are kept and
+// completed by the suffix of each IV.
+
+int AES_GCM_iv_prefix_init(const struct AES_ctx* ctx, const uint8_t* prefix, size_t prefix_len,
+                           struct AES_GCM_iv_prefix* out)
+{
+    if (ctx == NULL || out == NULL || (prefix == NULL && prefix_len > 0) || kernels_for(ctx) == NULL) {
+        return -1; // Invalid arguments or context not initialised
+    }
+    size_t whole = prefix_len - prefix_len % AES_BLOCKLEN;
+    memset(out, 0, sizeof(*out));
+    ghash_update_ctx(out->state, ctx, prefix, whole);
+    if (prefix_len > whole) {
+        memcpy(out->tail, prefix + whole, prefix_len - whole);
+    }
+    out->len = prefix_len;
+    return 0;
+}
+
+int AES_GCM_iv_prefix_j0(const struct AES_ctx* ctx, const struct AES_GCM_iv_prefix* prefix,
+                         const uint8_t* suffix, size_t suffix_len, uint8_t j0[AES_BLOCKLEN])
+{
+    if (ctx == NULL || prefix == NULL || (suffix == NULL && suffix_len > 0) || j0 == NULL ||
+        kernels_for(ctx) == NULL || prefix->len + suffix_len == 0) {
+        return -1; // Invalid arguments or context not initialised
+    }
+    size_t tail_len = (size_t)(prefix->len % AES_BLOCKLEN);
+    uint64_t iv_len = prefix->len + suffix_len;
+    uint8_t block[AES_BLOCKLEN] = {0};
+
+    memcpy(block, prefix->tail, tail_len);
+    if (iv_len == AES_GCM_IV_LEN) { // Not hashed; the prefix is all in tail
+        if (suffix_len > 0) {
+            memcpy(block + tail_len, suffix, suffix_len);
+        }
+        gcm_compute_j0(ctx, block, AES_GCM_IV_LEN, j0);
+        return 0;
+    }
+    STATS_ADD(IV_SLOW_PATH, 1);
+    memcpy(j0, prefix->state, AES_BLOCKLEN);
+    if (tail_len > 0) {
+        // Complete the prefix's last block from the suffix (zero-padded if short)
+        size_t take = AES_BLOCKLEN - tail_len < suffix_len ? AES_BLOCKLEN - tail_len : suffix_len;
+        if (take > 0) {
+            memcpy(block + tail_len, suffix, take);
+            suffix += take;
+            suffix_len -= take;
+        }
+        ghash_update(j0, ctx->H, block, AES_BLOCKLEN);
+    }
+    ghash_update_ctx(j0, ctx, suffix, suffix_len);
+    memset(block, 0, sizeof(block));
+    encode_length(iv_len * 8, block + 8);
+    ghash_update(j0, ctx->H, block, AES_BLOCKLEN);
+    return 0;
+}
+
+// --- Chunked GCM ---
+// A message is split into chunks at block boundaries. Each chunk is CTR-processed
+// at its own counter offset and GHASHed into its own partial state, so chunks can
+// run on different threads; the partials are folded together in order afterwards.
+
+int AES_GCM_chunk_start(const struct AES_ctx* ctx,
+                        const uint8_t* iv, size_t iv_len,
+                        const uint8_t* aad, size_t aad_len,
+                        uint8_t j0[AES_BLOCKLEN], uint8_t ghash[AES_BLOCKLEN])
+{
+    if (ctx == NULL || iv == NULL || iv_len == 0 || (aad == NULL && aad_len > 0) || j0 == NULL || ghash == NULL) {
+        return -1; // Invalid arguments
+    }
+    if (kernels_for(ctx) == NULL) {
+        return -1; // Context not initialised
+    }
+    STATS_TIMER(t);
+    gcm_compute_j0(ctx, iv, iv_len, j0);
+    memset(ghash, 0, AES_BLOCKLEN);
+    ghash_update_ctx(ghash, ctx, aad, aad_len);
+    STATS_LAP(GHASH_NS, t);
+    return 0;
+}
+
+// Shared body of AES_GCM_encrypt_chunk / AES_GCM_decrypt_chunk.
+static int gcm_xcrypt_chunk(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN], uint64_t block_offset,
+                            const uint8_t* in, uint8_t* out, size_t len, uint8_t ghash[AES_BLOCKLEN], int encrypt)
+{
+    if (ctx == NULL || j0 == NULL || ghash == NULL || ((in == NULL || out == NULL) && len > 0)) {
+        return -1; // Invalid arguments
+    }
+    const struct aes_kernels* kernels = kernels_for(ctx);
+    if (kernels == NULL) {
+        return -1; // Context not initialised
+    }
+
+    uint8_t counter[AES_BLOCKLEN];
+    STATS_TIMER(t);
+    gcm_counter_at(j0, block_offset, counter);
+    if (!encrypt) {
+        ghash_update_ctx(ghash, ctx, in, len); // GHASH runs over the ciphertext
+        STATS_LAP(GHASH_NS, t);
+    }
+    if (len > 0) {
+        if (out != in) {
+            memmove(out, in, len);
+        }
+        kernels->ctr_xcrypt(ctx->RoundKey, counter, out, len);
+    }
+    STATS_LAP(CTR_NS, t);
+    if (encrypt) {
+        ghash_update_ctx(ghash, ctx, out, len);
+        STATS_LAP(GHASH_NS, t);
+        STATS_ADD(SEAL_BYTES, len);
+    } else {
+        STATS_ADD(OPEN_BYTES, len);
+    }
+    return 0;
+}
+
+int AES_GCM_encrypt_chunk(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN], uint64_t block_offset,
+                          const uint8_t* pt, uint8_t* ct, size_t len, uint8_t ghash[AES_BLOCKLEN])
+{
+    return gcm_xcrypt_chunk(ctx, j0, block_offset, pt, ct, len, ghash, 1);
+}
+
+int AES_GCM_decrypt_chunk(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN], uint64_t block_offset,
+                          const uint8_t* ct, uint8_t* pt, size_t len, uint8_t ghash[AES_BLOCKLEN])
+{
+    return gcm_xcrypt_chunk(ctx, j0, block_offset, ct, pt, len, ghash, 0);
+}
+
+int AES_GCM_chunk_combine(const struct AES_ctx* ctx, uint8_t ghash[AES_BLOCKLEN],
+                          const uint8_t partial[AES_BLOCKLEN], size_t partial_len)
+{
+    if (ctx == NULL || ghash == NULL || partial == NULL) {
+        return -1; // Invalid arguments
+    }
+    // GHASH is Horner evaluation in H, so a state followed by n more blocks is
+    // scaled by H^n: ghash = ghash * H^n ^ partial, n = blocks in the chunk.
+    STATS_TIMER(t);
+    ghash_mul_hpow(ghash, ctx->H, ((uint64_t)partial_len + AES_BLOCKLEN - 1) / AES_BLOCKLEN);
+    for (int i = 0; i < AES_BLOCKLEN; ++i) {
+        ghash[i] ^= partial[i];
+    }
+    STATS_LAP(GHASH_NS, t);
+    return 0;
+}
+
+int AES_GCM_chunk_finish(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN],
+                         const uint8_t ghash[AES_BLOCKLEN], size_t aad_len, size_t ct_len,
+                         uint8_t tag[AES_GCM_TAG_LEN])
+{
+    if (ctx == NULL || j0 == NULL || ghash == NULL || tag == NULL) {
+        return -1; // Invalid arguments
+    }
+    const struct aes_kernels* kernels = kernels_for(ctx);
+    if (kernels == NULL) {
+        return -1; // Context not initialised
+    }
+    STATS_TIMER(t);
+    gcm_tag(kernels, ctx, j0, ghash, aad_len, ct_len, tag);
+    STATS_LAP(GHASH_NS, t);
+    return 0;
+}
@@ -23,46 +23,97 @@
 // #endif
 
 
-#define AES128 1 // Enabled standard 128-bit
-#define AES192 1 // Enabled standard 192-bit
-#define AES256 1 // Enabled standard 256-bit
-#define AES512 1 // Enabled non-standard 512-bit key extension
+// Key sizes compiled into the library. All enabled sizes are available in the
+// same binary; the size is picked at runtime from the key length passed to
+// AES_init_ctx_keylen(). #define one of these to 0 to drop its kernels.
+#ifndef AES128
+  #define AES128 1 // Enabled standard 128-bit
+#endif
+#ifndef AES192
+  #define AES192 1 // Enabled standard 192-bit
+#endif
+#ifndef AES256
+  #define AES256 1 // Enabled standard 256-bit
+#endif
+#ifndef AES512
+  #define AES512 1 // Enabled non-standard 512-bit key extension
+#endif
 
 #define AES_BLOCKLEN 16 // Block length in bytes - AES is 128b block only
 
-// Determine key length and round count based on defined macros
+// AES_KEYLEN is the key length used by the legacy AES_init_ctx() entry point:
+// the largest enabled key size. AES_keyExpSize is sized for that key, which is
+// also the largest schedule a context has to hold.
 #if defined(AES512) && (AES512 == 1)
     #define AES_KEYLEN 64   // Key length in bytes (512 bits)
-    #define Nr 22           // Number of rounds (Chosen based on AES pattern Nk + 6, security implications unknown)
-    #define AES_keyExpSize 368 // AES_BLOCKLEN * (Nr + 1) = 16 * 23 = 368
+    #define AES_keyExpSize 368 // AES_BLOCKLEN * (Nr + 1) = 16 * 23 = 368, Nr = 22
 #elif defined(AES256) && (AES256 == 1)
     #define AES_KEYLEN 32
-    #define Nr 14 // Number of rounds
     #define AES_keyExpSize 240
 #elif defined(AES192) && (AES192 == 1)
     #define AES_KEYLEN 24
-    #define Nr 12 // Number of rounds
     #define AES_keyExpSize 208
-#else // Default to AES128 if none of the specific versions (512, 256, 192) are defined AND enabled
-    #ifndef AES128 // Only define AES128 if it wasn't already defined externally
-      #define AES128 1 
-    #endif
+#elif defined(AES128) && (AES128 == 1)
     #define AES_KEYLEN 16   // Key length in bytes
-    #define Nr 10           // Number of rounds
     #define AES_keyExpSize 176
+#else
+    #error "At least one of AES128, AES192, AES256 or AES512 must be enabled"
+#endif
+
+// Alignment of struct AES_ctx: one cache line, so H and its powers fill the
+// first line, Nr and the first round keys share the second, and every round
+// key is a 16-byte lane that the kernels load with aligned loads.
+#define AES_CTX_ALIGN 64
+#if defined(__cplusplus)
+  #define AES_CTX_ALIGNAS alignas(AES_CTX_ALIGN)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+  #define AES_CTX_ALIGNAS _Alignas(AES_CTX_ALIGN)
+#elif defined(__GNUC__) || defined(__clang__)
+  #define AES_CTX_ALIGNAS __attribute__((aligned(AES_CTX_ALIGN)))
+#elif defined(_MSC_VER)
+  #define AES_CTX_ALIGNAS __declspec(align(AES_CTX_ALIGN))
+#else
+  #error "No way to align struct AES_ctx with this compiler"
 #endif
 
+// Contexts declared as variables or members are aligned by the compiler. On the
+// heap use AES_ctx_alloc: malloc does not honour the alignment, and the
+// AES-NI kernels need at least 16.
 struct AES_ctx
 {
-  uint8_t RoundKey[AES_keyExpSize];
-//#if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1)) // Keep Iv for GCM internal state/nonce handling
-  uint8_t Iv[AES_BLOCKLEN]; 
-//#endif
-  // Add fields specific to GCM state if needed later (e.g., precomputed H)
-  // uint8_t H[AES_BLOCKLEN]; 
+  AES_CTX_ALIGNAS uint8_t H[AES_BLOCKLEN]; // GHASH subkey E_K(0^128), read by every GHASH step
+  uint8_t H2[AES_BLOCKLEN];   // H^2 in GF(2^128), for J0 of 16-byte IVs and 4-block GHASH
+  uint8_t H3[AES_BLOCKLEN];   // H^3 and H^4, for 4-block GHASH
+  uint8_t H4[AES_BLOCKLEN];
+  uint8_t Nr;                 // Number of rounds for the key this context was initialised with (10, 12, 14 or 22)
+  uint8_t pad_[AES_BLOCKLEN - 1];
+  uint8_t LH16[AES_BLOCKLEN]; // The GHASH length block of a 16-byte IV, times H
+  uint8_t RoundKey[AES_keyExpSize]; // Nr + 1 round keys; each starts on a 16-byte boundary
 };
 
+// Initialises ctx with an AES_KEYLEN-byte key.
 void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key);
+
+/**
+ * @brief Allocates a zeroed context aligned to AES_CTX_ALIGN bytes.
+ *
+ * @return          The context (initialise it with AES_init_ctx_keylen), or
+ *                  NULL if allocation fails.
+ */
+struct AES_ctx* AES_ctx_alloc(void);
+
+/** @brief Wipes and frees a context from AES_ctx_alloc. NULL is ignored. */
+void AES_ctx_free(struct AES_ctx* ctx);
+
+/**
+ * @brief Initialises an AES context for a key of any enabled size.
+ *
+ * @param ctx       Context to initialise.
+ * @param key       Key bytes.
+ * @param key_len   Key length in bytes: 16, 24, 32 or 64 (AES-128/192/256/512).
+ * @return int      0 on success, -1 if key_len is not an enabled key size.
+ */
+int AES_init_ctx_keylen(struct AES_ctx* ctx, const uint8_t* key, size_t key_len);
 //#if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1)) // Remove IV-specific init/set functions from public API
 // void AES_init_ctx_iv(struct AES_ctx* ctx, const uint8_t* key, const uint8_t* iv);
 // void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv);
@@ -80,9 +131,45 @@ void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key);
 // #endif // #if defined(CBC) && (CBC == 1)
 
 
-//#if defined(CTR) && (CTR == 1) // Remove public CTR function
-// void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, size_t length);
-// #endif // #if defined(CTR) && (CTR == 1)
+/**
+ * @brief Encrypts nblocks independent 16-byte blocks with ctx's key.
+ *
+ * Each block is encrypted on its own (ECB), on the same kernels as GCM with
+ * several blocks in flight: a primitive for key wrapping, tokenisation or PRF
+ * constructions, not a mode for messages.
+ *
+ * @param in, out   nblocks * AES_BLOCKLEN bytes; may be the same buffer, but
+ *                  must not otherwise overlap.
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_encrypt_blocks(const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, size_t nblocks);
+
+// --- CTR ---
+//
+// Plain CTR mode (NIST SP 800-38A) on the same kernels as GCM. The counter
+// block is a 128-bit big-endian integer: block i of the stream is encrypted
+// with E_K(counter + i), wrapping mod 2^128 (GCM's own counter only steps the
+// low 32 bits). block_offset seeks: the call starts at stream block
+// block_offset, so a sector or a PRNG position can be processed without
+// generating the keystream before it. CTR gives no integrity.
+
+/**
+ * @brief XORs len bytes of keystream, starting at block block_offset, into in.
+ *
+ * @param counter       Initial counter block (stream block 0).
+ * @param in, out       len bytes; may be the same buffer, but must not otherwise overlap.
+ * @return int          0 on success, -1 on invalid arguments.
+ */
+int AES_CTR_xcrypt(const struct AES_ctx* ctx, const uint8_t counter[AES_BLOCKLEN], uint64_t block_offset,
+                   const uint8_t* in, uint8_t* out, size_t len);
+
+/**
+ * @brief Writes len bytes of raw keystream, starting at block block_offset, to out.
+ *
+ * @return int          0 on success, -1 on invalid arguments.
+ */
+int AES_CTR_keystream(const struct AES_ctx* ctx, const uint8_t counter[AES_BLOCKLEN], uint64_t block_offset,
+                      uint8_t* out, size_t len);
 
 // --- GCM API Declarations (Placeholders) ---
 
@@ -100,12 +187,13 @@ void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key);
  * @param aad       Additional Authenticated Data (can be NULL if aad_len is 0).
  * @param aad_len   Length of AAD in bytes.
  * @param pt        Plaintext input.
- * @param ct        Ciphertext output buffer (must be at least pt_len bytes).
+ * @param ct        Ciphertext output buffer (must be at least pt_len bytes; may be NULL if pt_len is 0).
+ *                  May be pt itself (in-place), but must not otherwise overlap it.
  * @param pt_len    Length of plaintext/ciphertext in bytes.
  * @param tag       Output buffer for the authentication tag (AES_GCM_TAG_LEN bytes).
  * @return int      0 on success, non-zero on error (e.g., invalid input).
  */
-int AES_GCM_encrypt(struct AES_ctx* ctx, 
+int AES_GCM_encrypt(const struct AES_ctx* ctx, 
                     const uint8_t* iv, size_t iv_len, 
                     const uint8_t* aad, size_t aad_len, 
                     const uint8_t* pt, uint8_t* ct, size_t pt_len, 
@@ -120,17 +208,354 @@ int AES_GCM_encrypt(struct AES_ctx* ctx,
  * @param aad       Additional Authenticated Data (must match encryption AAD).
  * @param aad_len   Length of AAD in bytes.
  * @param ct        Ciphertext input.
- * @param pt        Plaintext output buffer (must be at least ct_len bytes).
+ * @param pt        Plaintext output buffer (must be at least ct_len bytes; may be NULL if ct_len is 0).
+ *                  May be ct itself (in-place), but must not otherwise overlap it.
  * @param ct_len    Length of ciphertext/plaintext in bytes.
  * @param tag       Input buffer containing the authentication tag to verify.
  * @return int      0 on success (decryption successful, tag verified),
  *                  Non-zero on error (e.g., tag mismatch, invalid input).
  */
-int AES_GCM_decrypt(struct AES_ctx* ctx, 
+int AES_GCM_decrypt(const struct AES_ctx* ctx, 
                     const uint8_t* iv, size_t iv_len, 
                     const uint8_t* aad, size_t aad_len, 
                     const uint8_t* ct, uint8_t* pt, size_t ct_len, 
                     const uint8_t* tag);
 
+/**
+ * @brief Checks an AES-GCM message's tag without decrypting it.
+ *
+ * Runs only GHASH over aad and ct and one block cipher call for E_K(J0):
+ * no CTR pass and no output buffer. GHASH is the larger part of decryption, so
+ * this saves the CTR share (about a fifth with AES-NI and PCLMULQDQ). For
+ * integrity scrubs of stored ciphertext; a reader that needs the plaintext
+ * should call AES_GCM_decrypt, which verifies anyway.
+ *
+ * @param ct        Ciphertext (may be NULL if ct_len is 0).
+ * @param tag       The AES_GCM_TAG_LEN-byte tag to check.
+ * @return int      0 if the tag matches, -1 on invalid arguments, -3 if it does not.
+ */
+int AES_GCM_verify(const struct AES_ctx* ctx,
+                   const uint8_t* iv, size_t iv_len,
+                   const uint8_t* aad, size_t aad_len,
+                   const uint8_t* ct, size_t ct_len,
+                   const uint8_t* tag);
+
+/**
+ * @brief AES_GCM_encrypt with a truncated tag.
+ *
+ * The tag is the leftmost tag_len bytes of the full tag. SP 800-38D allows 16,
+ * 15, 14, 13 and 12 bytes, and 8 or 4 bytes only where the protocol bounds
+ * the message length and the number of failed decryptions per key (see its
+ * Appendix C). The length must be fixed by the protocol, never taken from the
+ * received tag.
+ *
+ * @param tag_len   16, 15, 14, 13, 12, 8 or 4.
+ * @return int      0 on success, -1 on invalid arguments (including tag_len).
+ */
+int AES_GCM_encrypt_taglen(const struct AES_ctx* ctx,
+                           const uint8_t* iv, size_t iv_len,
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* pt, uint8_t* ct, size_t pt_len,
+                           uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief AES_GCM_decrypt for a truncated tag of tag_len bytes (see AES_GCM_encrypt_taglen).
+ *
+ * @return int      0 on success, -1 on invalid arguments, -3 if the tag does not match.
+ */
+int AES_GCM_decrypt_taglen(const struct AES_ctx* ctx,
+                           const uint8_t* iv, size_t iv_len,
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* ct, uint8_t* pt, size_t ct_len,
+                           const uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief AES_GCM_encrypt with the initial counter block J0 given instead of the IV.
+ *
+ * @param j0        J0 for the message's IV, e.g. from AES_GCM_iv_prefix_j0.
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_GCM_encrypt_j0(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN],
+                       const uint8_t* aad, size_t aad_len,
+                       const uint8_t* pt, uint8_t* ct, size_t pt_len,
+                       uint8_t* tag);
+
+/**
+ * @brief AES_GCM_decrypt with the initial counter block J0 given instead of the IV.
+ *
+ * @return int      0 on success, -1 on invalid arguments, -3 if the tag does not match.
+ */
+int AES_GCM_decrypt_j0(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN],
+                       const uint8_t* aad, size_t aad_len,
+                       const uint8_t* ct, uint8_t* pt, size_t ct_len,
+                       const uint8_t* tag);
+
+// --- GMAC ---
+//
+// GMAC authenticates data without encrypting anything: it is GCM with the data
+// as AAD and no plaintext, so AES_GMAC's tag equals AES_GCM_encrypt's for
+// (iv, aad = data, pt_len = 0). The IV must be unique per key, as for GCM.
+
+/**
+ * @brief Computes the GMAC tag of data.
+ *
+ * @param tag       Output buffer (AES_GCM_TAG_LEN bytes).
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_GMAC(const struct AES_ctx* ctx, const uint8_t* iv, size_t iv_len,
+             const uint8_t* data, size_t len, uint8_t tag[AES_GCM_TAG_LEN]);
+
+/**
+ * @brief Checks a GMAC tag in constant time.
+ *
+ * @return int      0 if tag matches, -1 on invalid arguments, -3 if it does not.
+ */
+int AES_GMAC_verify(const struct AES_ctx* ctx, const uint8_t* iv, size_t iv_len,
+                    const uint8_t* data, size_t len, const uint8_t tag[AES_GCM_TAG_LEN]);
+
+// Streaming GMAC over data that arrives in pieces of any size:
+//
+//   AES_GMAC_init(&g, ctx, iv, iv_len);
+//   AES_GMAC_update(&g, piece, piece_len);   // any number of times
+//   AES_GMAC_final(&g, tag);                 // or AES_GMAC_final_verify
+//
+// ctx must outlive the stream. A stream is not thread-safe.
+struct AES_GMAC_ctx
+{
+  const struct AES_ctx* key;
+  uint8_t j0[AES_BLOCKLEN];
+  uint8_t ghash[AES_BLOCKLEN]; // GHASH state over the whole blocks so far
+  uint8_t buf[AES_BLOCKLEN];   // The bytes after them
+  uint64_t len;                // Bytes passed to update
+};
+
+/** @brief Starts a stream. @return int 0 on success, -1 on invalid arguments. */
+int AES_GMAC_init(struct AES_GMAC_ctx* g, const struct AES_ctx* ctx, const uint8_t* iv, size_t iv_len);
+
+/** @brief Authenticates the next len bytes. @return int 0 on success, -1 on invalid arguments. */
+int AES_GMAC_update(struct AES_GMAC_ctx* g, const uint8_t* data, size_t len);
+
+/** @brief Writes the tag and wipes the stream. @return int 0 on success, -1 on invalid arguments. */
+int AES_GMAC_final(struct AES_GMAC_ctx* g, uint8_t tag[AES_GCM_TAG_LEN]);
+
+/**
+ * @brief Compares the stream's tag with tag in constant time and wipes the stream.
+ *
+ * @return int      0 if tag matches, -1 on invalid arguments, -3 if it does not.
+ */
+int AES_GMAC_final_verify(struct AES_GMAC_ctx* g, const uint8_t tag[AES_GCM_TAG_LEN]);
+
+// --- GHASH ---
+//
+// GHASH_H over GF(2^128) for a caller-chosen H (e.g. for POLYVAL-style MACs or
+// GCM-based KDFs), on the same kernels as GCM: PCLMULQDQ with four blocks per
+// reduction where built with it, the bitwise multiply otherwise.
+//
+//   AES_GHASH_init(&g, H);
+//   AES_GHASH_update(&g, piece, piece_len);   // any number of times
+//   AES_GHASH_final(&g, out);                 // zero-pads a trailing partial block
+//
+// Streams over separate pieces (e.g. on several threads) can be joined with
+// AES_GHASH_combine. A stream is not thread-safe.
+struct AES_GHASH_ctx
+{
+  uint8_t H[AES_BLOCKLEN];
+  uint8_t H2[AES_BLOCKLEN];
+  uint8_t H3[AES_BLOCKLEN];
+  uint8_t H4[AES_BLOCKLEN];
+  uint8_t state[AES_BLOCKLEN]; // GHASH state over the whole blocks so far
+  uint8_t buf[AES_BLOCKLEN];   // The bytes after them
+  uint64_t len;                // Bytes hashed, counting padding added by AES_GHASH_combine
+};
+
+/**
+ * @brief Multiplies x by y in GCM's GF(2^128) (bit-reflected, as in SP 800-38D).
+ *
+ * @param res       Output; may alias x or y.
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_GHASH_mul(const uint8_t x[AES_BLOCKLEN], const uint8_t y[AES_BLOCKLEN], uint8_t res[AES_BLOCKLEN]);
+
+/** @brief Starts a stream with hash key H (computes H^2..H^4). @return int 0 on success, -1 on invalid arguments. */
+int AES_GHASH_init(struct AES_GHASH_ctx* g, const uint8_t H[AES_BLOCKLEN]);
+
+/** @brief Hashes the next len bytes. @return int 0 on success, -1 on invalid arguments. */
+int AES_GHASH_update(struct AES_GHASH_ctx* g, const uint8_t* data, size_t len);
+
+/**
+ * @brief Appends the stream tail to g.
+ *
+ * g becomes the stream of g's bytes and then tail's, each zero-padded to a
+ * block boundary (as GCM pads the AAD and the ciphertext), so splitting a
+ * message at block boundaries and combining the pieces gives its GHASH. The
+ * cost is O(log n) multiplies for n blocks in tail. tail is left unchanged.
+ *
+ * @return int      0 on success, -1 on invalid arguments (including a different H).
+ */
+int AES_GHASH_combine(struct AES_GHASH_ctx* g, const struct AES_GHASH_ctx* tail);
+
+/** @brief Writes the 16-byte hash and wipes the stream. @return int 0 on success, -1 on invalid arguments. */
+int AES_GHASH_final(struct AES_GHASH_ctx* g, uint8_t out[AES_BLOCKLEN]);
+
+// --- IV prefixes ---
+//
+// An IV of any length other than AES_GCM_IV_LEN is GHASHed into J0, block by
+// block. Protocols whose IVs share a fixed prefix (e.g. a per-session salt
+// followed by a per-message counter) can hash the prefix's whole blocks once:
+//
+//   AES_GCM_iv_prefix_init(ctx, salt, salt_len, &prefix);
+//   for each message:
+//       AES_GCM_iv_prefix_j0(ctx, &prefix, counter, counter_len, j0);
+//       AES_GCM_encrypt_j0(ctx, j0, aad, aad_len, pt, ct, len, tag);
+//
+// The output is the same as AES_GCM_encrypt with the IV prefix || suffix.
+// A prefix is tied to the context it was made with.
+
+struct AES_GCM_iv_prefix
+{
+  uint8_t state[AES_BLOCKLEN]; // GHASH state after the prefix's whole blocks
+  uint8_t tail[AES_BLOCKLEN];  // The bytes after them
+  uint64_t len;                // Prefix length in bytes
+};
+
+/**
+ * @brief Hashes the whole blocks of an IV prefix.
+ *
+ * @param prefix_len  Any length, including 0.
+ * @return int        0 on success, -1 on invalid arguments.
+ */
+int AES_GCM_iv_prefix_init(const struct AES_ctx* ctx, const uint8_t* prefix, size_t prefix_len,
+                           struct AES_GCM_iv_prefix* out);
+
+/**
+ * @brief Derives J0 for the IV prefix || suffix.
+ *
+ * @param j0        Output: initial counter block (AES_BLOCKLEN bytes).
+ * @return int      0 on success, -1 on invalid arguments (including an empty IV).
+ */
+int AES_GCM_iv_prefix_j0(const struct AES_ctx* ctx, const struct AES_GCM_iv_prefix* prefix,
+                         const uint8_t* suffix, size_t suffix_len, uint8_t j0[AES_BLOCKLEN]);
+
+// --- Chunked GCM API ---
+//
+// Splits one GCM message into chunks that can be processed independently (e.g.
+// on different threads) and produces standard AES_GCM_encrypt output:
+//
+//   AES_GCM_chunk_start(ctx, iv, iv_len, aad, aad_len, j0, ghash);
+//   for each chunk i (any order, any thread), starting at message block b_i:
+//       partial_i = {0};
+//       AES_GCM_encrypt_chunk(ctx, j0, b_i, pt + 16*b_i, ct + 16*b_i, len_i, partial_i);
+//   for each chunk i in message order:
+//       AES_GCM_chunk_combine(ctx, ghash, partial_i, len_i);
+//   AES_GCM_chunk_finish(ctx, j0, ghash, aad_len, total_len, tag);
+//
+// Every chunk except the last must be a multiple of AES_BLOCKLEN bytes.
+// A chunk may also be fed a running ghash directly (instead of a zeroed
+// partial) when chunks are processed sequentially; no combine step is then needed.
+
+/**
+ * @brief Derives J0 from the IV and hashes the AAD.
+ *
+ * @param j0        Output: initial counter block (AES_BLOCKLEN bytes).
+ * @param ghash     Output: GHASH state after the AAD (AES_BLOCKLEN bytes).
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_GCM_chunk_start(const struct AES_ctx* ctx,
+                        const uint8_t* iv, size_t iv_len,
+                        const uint8_t* aad, size_t aad_len,
+                        uint8_t j0[AES_BLOCKLEN], uint8_t ghash[AES_BLOCKLEN]);
+
+/**
+ * @brief Encrypts one chunk and GHASHes its ciphertext into ghash.
+ *
+ * @param j0            Initial counter block from AES_GCM_chunk_start.
+ * @param block_offset  Index of the chunk's first 16-byte block within the message.
+ * @param pt, ct        Input and output (len bytes; may be the same buffer).
+ * @param ghash         In/out GHASH state (zeroed for an independent partial).
+ * @return int          0 on success, -1 on invalid arguments.
+ */
+int AES_GCM_encrypt_chunk(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN], uint64_t block_offset,
+                          const uint8_t* pt, uint8_t* ct, size_t len, uint8_t ghash[AES_BLOCKLEN]);
+
+/**
+ * @brief Decrypts one chunk, GHASHing its ciphertext into ghash.
+ *
+ * The plaintext is unauthenticated until the tag from AES_GCM_chunk_finish
+ * has been compared (in constant time) against the received tag.
+ * Parameters as for AES_GCM_encrypt_chunk.
+ */
+int AES_GCM_decrypt_chunk(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN], uint64_t block_offset,
+                          const uint8_t* ct, uint8_t* pt, size_t len, uint8_t ghash[AES_BLOCKLEN]);
+
+/**
+ * @brief Appends a chunk's partial GHASH: ghash = ghash * H^blocks(partial_len) ^ partial.
+ *
+ * @param ghash         In/out running GHASH state.
+ * @param partial       GHASH of the chunk, computed from a zero state.
+ * @param partial_len   Length of the chunk in bytes.
+ * @return int          0 on success, -1 on invalid arguments.
+ */
+int AES_GCM_chunk_combine(const struct AES_ctx* ctx, uint8_t ghash[AES_BLOCKLEN],
+                          const uint8_t partial[AES_BLOCKLEN], size_t partial_len);
+
+/**
+ * @brief Computes the tag from the final GHASH state.
+ *
+ * @param aad_len   Total AAD length in bytes.
+ * @param ct_len    Total message length in bytes.
+ * @param tag       Output buffer (AES_GCM_TAG_LEN bytes).
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_GCM_chunk_finish(const struct AES_ctx* ctx, const uint8_t j0[AES_BLOCKLEN],
+                         const uint8_t ghash[AES_BLOCKLEN], size_t aad_len, size_t ct_len,
+                         uint8_t tag[AES_GCM_TAG_LEN]);
+
+// --- Statistics ---
+//
+// Building the library with -DAES_GCM_STATS=1 (Makefile: STATS=1, CMake:
+// -DTINY_AES_C_STATS=ON, Go: -tags aesgcm_stats) keeps per-thread counters
+// on the hot paths. Each thread writes only its own counters and snapshots sum
+// them, so no locks or atomic read-modify-writes are taken on the hot path.
+// Without it the counting compiles away entirely and AES_GCM_stats_snapshot
+// returns -1. Counting requires C11 atomics and POSIX threads. GMAC is not
+// counted.
+
+#ifndef AES_GCM_STATS
+  #define AES_GCM_STATS 0
+#endif
+
+struct AES_GCM_stats
+{
+  uint64_t seal_messages;  // AES_GCM_encrypt calls
+  uint64_t seal_bytes;     // Bytes encrypted (AES_GCM_encrypt and AES_GCM_encrypt_chunk)
+  uint64_t open_messages;  // AES_GCM_decrypt calls
+  uint64_t open_bytes;     // Bytes authenticated for decryption (AES_GCM_decrypt and AES_GCM_decrypt_chunk)
+  uint64_t auth_failures;  // AES_GCM_decrypt tag mismatches
+  uint64_t verify_messages; // AES_GCM_verify calls (not counted as opens: nothing is decrypted)
+  uint64_t verify_bytes;   // Ciphertext bytes checked by AES_GCM_verify
+  uint64_t verify_failures; // AES_GCM_verify tag mismatches
+  uint64_t iv_slow_path;   // J0 derived with GHASH because the IV was not AES_GCM_IV_LEN bytes
+  uint64_t ctr_ns;         // Time in the CTR kernel
+  uint64_t ghash_ns;       // Time in GHASH, J0 derivation and tag computation
+  const char* backend;     // Compiled-in kernels, e.g. "aesni+pclmul" or "portable+portable"
+};
+
+/**
+ * @brief Sums the counters of all threads since the last AES_GCM_stats_reset.
+ *
+ * Threads that have exited still count. Counters of running threads may be a
+ * few operations behind.
+ *
+ * @param out       Output snapshot. backend is set even when statistics are off.
+ * @return int      0 on success, -1 if out is NULL or the library was built
+ *                  without AES_GCM_STATS (counters are then zero).
+ */
+int AES_GCM_stats_snapshot(struct AES_GCM_stats* out);
+
+/**
+ * @brief Makes later snapshots count from zero again.
+ */
+void AES_GCM_stats_reset(void);
+
 
 #endif // _AES_H_
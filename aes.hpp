@@ -8,5 +8,758 @@
 extern "C" {
 #include "aes.h"
 }
+#include "aes_tables.h"
+
+// Header-only C++20 layer over the C API. Older language modes only get the
+// extern "C" declarations above.
+#if __cplusplus >= 202002L
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aes {
+
+inline constexpr std::size_t block_size = AES_BLOCKLEN;
+inline constexpr std::size_t tag_size = AES_GCM_TAG_LEN;
+inline constexpr std::size_t iv_size = AES_GCM_IV_LEN;
+
+// Thrown for misuse (mismatched buffer sizes, key sizes not compiled into the
+// C library). Authentication failures are reported through return values.
+class error : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+// Zeroes memory through a volatile pointer so the store cannot be elided.
+inline void secure_wipe(void* p, std::size_t n) noexcept {
+  volatile unsigned char* v = static_cast<volatile unsigned char*>(p);
+  while (n--) {
+    *v++ = 0;
+  }
+}
+
+// The C API takes NULL for empty buffers.
+inline const std::uint8_t* u8(std::span<const std::byte> s) noexcept {
+  return s.empty() ? nullptr : reinterpret_cast<const std::uint8_t*>(s.data());
+}
+inline std::uint8_t* u8(std::span<std::byte> s) noexcept {
+  return s.empty() ? nullptr : reinterpret_cast<std::uint8_t*>(s.data());
+}
+
+// Shared state of gcm_sealer / gcm_opener. The C chunk kernels only start at
+// block boundaries, so a block split across update() calls is kept in buf and
+// re-run once it is complete: the bytes emitted early use a scratch GHASH state,
+// the completed block is hashed into the real one.
+class gcm_stream {
+public:
+  gcm_stream(const gcm_stream&) = delete;
+  gcm_stream& operator=(const gcm_stream&) = delete;
+  ~gcm_stream() { secure_wipe(this, sizeof(*this)); }
+
+protected:
+  using chunk_fn = int (*)(const AES_ctx*, const std::uint8_t*, std::uint64_t,
+                           const std::uint8_t*, std::uint8_t*, std::size_t, std::uint8_t*);
+
+  gcm_stream(const AES_ctx* ctx, std::span<const std::byte> iv, std::span<const std::byte> aad, chunk_fn fn)
+      : ctx_(ctx), fn_(fn), aad_len_(aad.size()) {
+    if (AES_GCM_chunk_start(ctx_, u8(iv), iv.size(), u8(aad), aad.size(), j0_, ghash_) != 0) {
+      throw error("aes::gcm: invalid IV");
+    }
+  }
+
+  void update(std::span<const std::byte> in, std::span<std::byte> out) {
+    if (out.size() != in.size()) {
+      throw error("aes::gcm: output size must equal input size");
+    }
+    const std::uint8_t* src = u8(in);
+    std::uint8_t* dst = u8(out);
+    std::size_t len = in.size();
+    total_ += len;
+
+    if (buf_len_ > 0) { // Continue the block left partial by the last call
+      std::size_t n = block_size - buf_len_ < len ? block_size - buf_len_ : len;
+      std::uint8_t tmp[block_size];
+      for (std::size_t i = 0; i < n; ++i) {
+        buf_[buf_len_ + i] = src[i];
+      }
+      run_buffered(buf_len_ + n, tmp, buf_len_ + n == block_size);
+      for (std::size_t i = 0; i < n; ++i) {
+        dst[i] = tmp[buf_len_ + i];
+      }
+      buf_len_ = (buf_len_ + n) % block_size;
+      src += n;
+      dst += n;
+      len -= n;
+    }
+
+    std::size_t whole = len / block_size * block_size;
+    if (whole > 0) {
+      fn_(ctx_, j0_, block_, src, dst, whole, ghash_);
+      block_ += whole / block_size;
+      src += whole;
+      dst += whole;
+      len -= whole;
+    }
+
+    if (len > 0) { // Emit the tail now, hash it once the block is complete
+      std::uint8_t tmp[block_size];
+      for (std::size_t i = 0; i < len; ++i) {
+        buf_[i] = src[i];
+      }
+      run_buffered(len, tmp, false);
+      for (std::size_t i = 0; i < len; ++i) {
+        dst[i] = tmp[i];
+      }
+      buf_len_ = len;
+    }
+  }
+
+  void finish(std::uint8_t tag[AES_GCM_TAG_LEN]) {
+    if (buf_len_ > 0) {
+      std::uint8_t tmp[block_size];
+      run_buffered(buf_len_, tmp, true); // Final partial block, zero-padded by GHASH
+      buf_len_ = 0;
+    }
+    AES_GCM_chunk_finish(ctx_, j0_, ghash_, aad_len_, total_, tag);
+  }
+
+private:
+  // Runs the kernel over the first n buffered bytes at the current block.
+  // Hashes into the stream state (and advances) only when commit is set.
+  void run_buffered(std::size_t n, std::uint8_t* out, bool commit) {
+    std::uint8_t scratch[block_size] = {};
+    fn_(ctx_, j0_, block_, buf_, out, n, commit ? ghash_ : scratch);
+    if (commit) {
+      ++block_;
+    }
+    secure_wipe(scratch, sizeof(scratch));
+  }
+
+  const AES_ctx* ctx_;
+  chunk_fn fn_;
+  std::uint8_t j0_[block_size];
+  std::uint8_t ghash_[block_size];
+  std::uint8_t buf_[block_size];
+  std::size_t buf_len_ = 0;
+  std::uint64_t block_ = 0;
+  std::size_t aad_len_;
+  std::size_t total_ = 0;
+};
+
+} // namespace detail
+
+// Portable AES/GHASH usable in constant expressions, built from the same
+// tables as aes.c. It produces the same struct AES_ctx as AES_init_ctx_keylen,
+// so a key expanded at compile time can be handed straight to the C kernels.
+// Only meant for fixed keys and compile-time checks: table lookups are not
+// constant-time, use the C library for data at run time.
+namespace portable {
+
+inline constexpr std::uint8_t sbox[256] = AES_SBOX_INIT;
+inline constexpr std::uint8_t rcon[11] = AES_RCON_INIT;
+
+// Round count for a key length in bytes, 0 if unsupported.
+constexpr unsigned rounds_for(std::size_t key_len) noexcept {
+  switch (key_len) {
+  case 16: return 10;
+  case 24: return 12;
+  case 32: return 14;
+  case 64: return 22; // Non-standard AES-512
+  default: return 0;
+  }
+}
+
+constexpr std::uint8_t xtime(std::uint8_t x) noexcept {
+  return static_cast<std::uint8_t>((x << 1) ^ (((x >> 7) & 1) * 0x1b));
+}
+
+// Encrypts one block in place; same state layout as Cipher() in aes.c.
+constexpr void encrypt_block(const AES_ctx& ctx, std::uint8_t b[block_size]) noexcept {
+  for (unsigned i = 0; i < block_size; ++i) {
+    b[i] ^= ctx.RoundKey[i];
+  }
+  for (unsigned round = 1; round <= ctx.Nr; ++round) {
+    std::uint8_t t[block_size] = {};
+    for (unsigned i = 0; i < block_size; ++i) { // SubBytes + ShiftRows
+      t[i] = sbox[b[(i + 4 * (i % 4)) % block_size]];
+    }
+    if (round != ctx.Nr) { // MixColumns
+      for (unsigned c = 0; c < 4; ++c) {
+        std::uint8_t* col = t + 4 * c;
+        const std::uint8_t a0 = col[0], all = col[0] ^ col[1] ^ col[2] ^ col[3];
+        col[0] ^= xtime(col[0] ^ col[1]) ^ all;
+        col[1] ^= xtime(col[1] ^ col[2]) ^ all;
+        col[2] ^= xtime(col[2] ^ col[3]) ^ all;
+        col[3] ^= xtime(col[3] ^ a0) ^ all;
+      }
+    }
+    for (unsigned i = 0; i < block_size; ++i) {
+      b[i] = t[i] ^ ctx.RoundKey[round * block_size + i];
+    }
+  }
+}
+
+// x = x * h in GF(2^128), bitwise as the portable ghash_gmul in aes.c.
+constexpr void ghash_mul(std::uint8_t x[block_size], const std::uint8_t h[block_size]) noexcept {
+  std::uint8_t z[block_size] = {};
+  std::uint8_t v[block_size] = {};
+  for (unsigned i = 0; i < block_size; ++i) {
+    v[i] = h[i];
+  }
+  for (unsigned i = 0; i < 8 * block_size; ++i) {
+    if ((x[i / 8] >> (7 - i % 8)) & 1) {
+      for (unsigned k = 0; k < block_size; ++k) {
+        z[k] ^= v[k];
+      }
+    }
+    const bool lsb = v[block_size - 1] & 1;
+    for (unsigned k = block_size - 1; k > 0; --k) {
+      v[k] = static_cast<std::uint8_t>((v[k] >> 1) | (v[k - 1] << 7));
+    }
+    v[0] = static_cast<std::uint8_t>((v[0] >> 1) ^ (lsb ? 0xE1 : 0));
+  }
+  for (unsigned i = 0; i < block_size; ++i) {
+    x[i] = z[i];
+  }
+}
+
+// s = GHASH_H(s, data), zero-padding a trailing partial block.
+constexpr void ghash_update(std::uint8_t s[block_size], const std::uint8_t h[block_size],
+                            std::span<const std::uint8_t> data) noexcept {
+  for (std::size_t off = 0; off < data.size(); off += block_size) {
+    for (std::size_t i = 0; i < block_size && off + i < data.size(); ++i) {
+      s[i] ^= data[off + i];
+    }
+    ghash_mul(s, h);
+  }
+}
+
+// Equivalent of AES_init_ctx_keylen; throws (i.e. fails to compile in a
+// constant expression) for unsupported key lengths.
+constexpr AES_ctx expand_key(std::span<const std::uint8_t> key) {
+  const unsigned nr = rounds_for(key.size());
+  const unsigned nk = static_cast<unsigned>(key.size() / 4);
+  AES_ctx ctx{};
+  if (nr == 0 || (nr + 1) * block_size > sizeof(ctx.RoundKey)) {
+    throw error("aes::portable: unsupported key size");
+  }
+  ctx.Nr = static_cast<std::uint8_t>(nr);
+  for (unsigned i = 0; i < key.size(); ++i) {
+    ctx.RoundKey[i] = key[i];
+  }
+  for (unsigned i = nk; i < 4 * (nr + 1); ++i) {
+    std::uint8_t t[4] = { ctx.RoundKey[4 * i - 4], ctx.RoundKey[4 * i - 3],
+                          ctx.RoundKey[4 * i - 2], ctx.RoundKey[4 * i - 1] };
+    if (i % nk == 0) { // RotWord + SubWord + Rcon
+      const std::uint8_t t0 = t[0];
+      t[0] = static_cast<std::uint8_t>(sbox[t[1]] ^ rcon[i / nk]);
+      t[1] = sbox[t[2]];
+      t[2] = sbox[t[3]];
+      t[3] = sbox[t0];
+    } else if (nk > 6 && i % nk == 4) { // Extra SubWord for 256/512-bit keys
+      for (std::uint8_t& w : t) {
+        w = sbox[w];
+      }
+    }
+    for (unsigned j = 0; j < 4; ++j) {
+      ctx.RoundKey[4 * i + j] = ctx.RoundKey[4 * (i - nk) + j] ^ t[j];
+    }
+  }
+  encrypt_block(ctx, ctx.H); // H = E_K(0^128)
+  // The per-key GHASH values the C kernels read (gcm_precompute in aes.c)
+  for (unsigned i = 0; i < block_size; ++i) {
+    ctx.H2[i] = ctx.H[i];
+  }
+  ghash_mul(ctx.H2, ctx.H);
+  for (unsigned i = 0; i < block_size; ++i) {
+    ctx.H3[i] = ctx.H2[i];
+    ctx.H4[i] = ctx.H2[i];
+  }
+  ghash_mul(ctx.H3, ctx.H);
+  ghash_mul(ctx.H4, ctx.H2);
+  ctx.LH16[block_size - 1] = 0x80; // 16-byte IV length block: 128 bits, big-endian
+  ghash_mul(ctx.LH16, ctx.H);
+  return ctx;
+}
+
+// AES-GCM encryption, same output as AES_GCM_encrypt. ct must be pt.size() bytes.
+constexpr void gcm_encrypt(const AES_ctx& ctx, std::span<const std::uint8_t> iv,
+                           std::span<const std::uint8_t> aad, std::span<const std::uint8_t> pt,
+                           std::span<std::uint8_t> ct, std::span<std::uint8_t, tag_size> tag) {
+  if (iv.empty() || ct.size() != pt.size()) {
+    throw error("aes::portable: invalid arguments");
+  }
+  std::uint8_t j0[block_size] = {};
+  std::uint8_t len_block[block_size] = {};
+  if (iv.size() == iv_size) {
+    for (std::size_t i = 0; i < iv_size; ++i) {
+      j0[i] = iv[i];
+    }
+    j0[block_size - 1] = 1;
+  } else {
+    const std::uint64_t bits = static_cast<std::uint64_t>(iv.size()) * 8;
+    for (unsigned i = 0; i < 8; ++i) {
+      len_block[8 + i] = static_cast<std::uint8_t>(bits >> (56 - 8 * i));
+    }
+    ghash_update(j0, ctx.H, iv);
+    ghash_update(j0, ctx.H, len_block);
+  }
+
+  std::uint8_t s[block_size] = {};
+  ghash_update(s, ctx.H, aad);
+  std::uint8_t counter[block_size] = {};
+  for (std::size_t off = 0; off < pt.size(); off += block_size) {
+    const std::uint32_t ctr = ((std::uint32_t{j0[12]} << 24) | (std::uint32_t{j0[13]} << 16) |
+                               (std::uint32_t{j0[14]} << 8) | j0[15]) + 1 + static_cast<std::uint32_t>(off / block_size);
+    for (unsigned i = 0; i < 12; ++i) {
+      counter[i] = j0[i];
+    }
+    for (unsigned i = 0; i < 4; ++i) {
+      counter[12 + i] = static_cast<std::uint8_t>(ctr >> (24 - 8 * i));
+    }
+    encrypt_block(ctx, counter);
+    for (std::size_t i = 0; i < block_size && off + i < pt.size(); ++i) {
+      ct[off + i] = pt[off + i] ^ counter[i];
+    }
+  }
+  ghash_update(s, ctx.H, ct);
+
+  const std::uint64_t lens[2] = { static_cast<std::uint64_t>(aad.size()) * 8, static_cast<std::uint64_t>(pt.size()) * 8 };
+  for (unsigned i = 0; i < block_size; ++i) {
+    len_block[i] = static_cast<std::uint8_t>(lens[i / 8] >> (56 - 8 * (i % 8)));
+  }
+  ghash_update(s, ctx.H, len_block);
+  encrypt_block(ctx, j0);
+  for (unsigned i = 0; i < tag_size; ++i) {
+    tag[i] = s[i] ^ j0[i];
+  }
+}
+
+} // namespace portable
+
+class worker_pool;
+
+namespace detail {
+
+// One seal/open offloaded to a worker_pool. Lives in the awaiting coroutine's
+// frame (inside gcm_async), so the pool only ever holds pointers to it. The
+// message is split into chunk-sized jobs; each writes its partial GHASH and
+// whichever job finishes last folds them in order and produces the tag.
+class async_op {
+public:
+  async_op(const AES_ctx& ctx, std::span<const std::byte> iv, std::span<const std::byte> aad,
+           std::span<const std::byte> in, std::span<std::byte> out, bool encrypt, std::size_t chunk)
+      : ctx_(&ctx), in_(u8(in)), out_(u8(out)), len_(in.size()), aad_len_(aad.size()), encrypt_(encrypt),
+        chunk_(chunk), partials_(chunk == 0 ? 0 : (in.size() + chunk - 1) / chunk),
+        remaining_(partials_.size()) {
+    if (out.size() != in.size()) {
+      throw error("aes::gcm: output size must equal input size");
+    }
+    if (AES_GCM_chunk_start(ctx_, u8(iv), iv.size(), u8(aad), aad.size(), j0_, ghash_) != 0) {
+      throw error("aes::gcm: invalid IV");
+    }
+  }
+  async_op(const async_op&) = delete;
+  async_op& operator=(const async_op&) = delete;
+
+  std::size_t jobs() const noexcept { return partials_.size(); }
+
+  // Runs job i. Returns true for the job that completed the message.
+  bool run(std::size_t i) noexcept {
+    const std::size_t off = i * chunk_;
+    const std::size_t n = std::min(chunk_, len_ - off);
+    (encrypt_ ? AES_GCM_encrypt_chunk : AES_GCM_decrypt_chunk)(ctx_, j0_, off / block_size, in_ + off, out_ + off, n,
+                                                               partials_[i].data());
+    return remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  // Folds the partial GHASH values and computes (seal) or checks (open) the tag.
+  void finish() noexcept {
+    for (std::size_t i = 0; i < partials_.size(); ++i) {
+      AES_GCM_chunk_combine(ctx_, ghash_, partials_[i].data(), std::min(chunk_, len_ - i * chunk_));
+    }
+    std::uint8_t tag[tag_size];
+    AES_GCM_chunk_finish(ctx_, j0_, ghash_, aad_len_, len_, tag);
+    std::uint8_t diff = 0;
+    for (std::size_t i = 0; i < tag_size; ++i) {
+      diff |= static_cast<std::uint8_t>(tag[i] ^ tag_[i]);
+      tag_[i] = tag[i];
+    }
+    if (!encrypt_) {
+      ok_ = diff == 0;
+      if (!ok_ && len_ > 0) {
+        secure_wipe(out_, len_); // Do not leak unauthenticated plaintext
+      }
+    }
+    secure_wipe(tag, sizeof(tag));
+  }
+
+  std::coroutine_handle<> handle;
+
+protected:
+  std::uint8_t tag_[tag_size] = {}; // Expected tag in, computed tag out
+  bool ok_ = true;
+
+private:
+  const AES_ctx* ctx_;
+  const std::uint8_t* in_;
+  std::uint8_t* out_;
+  std::size_t len_;
+  std::size_t aad_len_;
+  bool encrypt_;
+  std::size_t chunk_;
+  std::uint8_t j0_[block_size];
+  std::uint8_t ghash_[block_size];
+  std::vector<std::array<std::uint8_t, block_size>> partials_;
+  std::atomic<std::size_t> remaining_;
+};
+
+} // namespace detail
+
+// Thread pool that runs seal/open for coroutines (gcm::async_seal and
+// gcm::async_open), so a large message does not block the calling reactor
+// thread. Messages are split into chunk_size jobs that run in parallel.
+//
+// Backpressure: at most max_inflight messages are admitted at a time; further
+// awaiting coroutines stay suspended, in FIFO order, until one completes.
+// Buffers passed to async_seal/async_open must stay valid until the
+// co_await resumes, and the pool must outlive all awaiting operations.
+class worker_pool {
+public:
+  struct options {
+    unsigned threads = 0;                        // 0: std::thread::hardware_concurrency()
+    std::size_t chunk_size = 256 * 1024;         // Bytes per job, rounded up to whole blocks
+    std::size_t max_inflight = 64;               // Messages admitted at once
+    std::size_t inline_threshold = 16 * 1024;    // Smaller messages complete without suspending
+    // Resumes a completed coroutine, e.g. by posting it to the reactor's run
+    // queue. Default: resume directly on the worker thread.
+    std::function<void(std::coroutine_handle<>)> resume;
+  };
+
+  worker_pool() : worker_pool(options{}) {}
+  explicit worker_pool(options opts) : opts_(std::move(opts)) {
+    opts_.chunk_size = std::max<std::size_t>(block_size, (opts_.chunk_size + block_size - 1) / block_size * block_size);
+    opts_.max_inflight = std::max<std::size_t>(1, opts_.max_inflight);
+    unsigned n = opts_.threads ? opts_.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads_.reserve(n);
+    for (unsigned i = 0; i < n; ++i) {
+      threads_.emplace_back([this](std::stop_token st) { run(st); });
+    }
+  }
+  ~worker_pool() {
+    for (auto& t : threads_) {
+      t.request_stop();
+    }
+    cv_.notify_all();
+  }
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  const options& config() const noexcept { return opts_; }
+
+  // Messages currently admitted / waiting for admission.
+  std::size_t inflight() const {
+    std::lock_guard lock(mu_);
+    return inflight_;
+  }
+  std::size_t waiting() const {
+    std::lock_guard lock(mu_);
+    return waiting_.size();
+  }
+
+private:
+  template <bool> friend class gcm_async;
+
+  void submit(detail::async_op* op) {
+    std::lock_guard lock(mu_);
+    if (inflight_ < opts_.max_inflight) {
+      admit(op);
+    } else {
+      waiting_.push_back(op);
+    }
+  }
+
+  void admit(detail::async_op* op) { // mu_ held
+    ++inflight_;
+    for (std::size_t i = 0; i < op->jobs(); ++i) {
+      jobs_.emplace_back(op, i);
+    }
+    cv_.notify_all();
+  }
+
+  void run(std::stop_token st) {
+    for (;;) {
+      std::pair<detail::async_op*, std::size_t> job;
+      {
+        std::unique_lock lock(mu_);
+        if (!cv_.wait(lock, st, [this] { return !jobs_.empty(); })) {
+          return;
+        }
+        job = jobs_.front();
+        jobs_.pop_front();
+      }
+      if (!job.first->run(job.second)) {
+        continue;
+      }
+      job.first->finish();
+      std::coroutine_handle<> h = job.first->handle; // op may be gone once resumed
+      {
+        std::lock_guard lock(mu_);
+        --inflight_;
+        if (!waiting_.empty()) {
+          admit(waiting_.front());
+          waiting_.pop_front();
+        }
+      }
+      if (opts_.resume) {
+        opts_.resume(h);
+      } else {
+        h.resume();
+      }
+    }
+  }
+
+  options opts_;
+  mutable std::mutex mu_;
+  std::condition_variable_any cv_;
+  std::deque<std::pair<detail::async_op*, std::size_t>> jobs_;
+  std::deque<detail::async_op*> waiting_;
+  std::size_t inflight_ = 0;
+  std::vector<std::jthread> threads_; // Last member: joined before the rest is destroyed
+};
+
+// Awaitable returned by async_seal (Encrypt, co_await yields void) and
+// async_open (co_await yields the authentication result).
+template <bool Encrypt>
+class gcm_async : detail::async_op {
+public:
+  gcm_async(worker_pool& pool, const AES_ctx& ctx, std::span<const std::byte> iv, std::span<const std::byte> aad,
+            std::span<const std::byte> in, std::span<std::byte> out, std::span<std::byte> tag_out,
+            std::span<const std::byte> tag_in)
+      : async_op(ctx, iv, aad, in, out, Encrypt, pool.config().chunk_size), pool_(pool), tag_out_(tag_out),
+        inline_(in.size() <= pool.config().inline_threshold) {
+    for (std::size_t i = 0; i < tag_in.size(); ++i) {
+      tag_[i] = static_cast<std::uint8_t>(tag_in[i]);
+    }
+  }
+
+  bool await_ready() noexcept {
+    if (!inline_) {
+      return false;
+    }
+    for (std::size_t i = 0; i < jobs(); ++i) {
+      run(i);
+    }
+    finish();
+    return true;
+  }
+  void await_suspend(std::coroutine_handle<> h) {
+    handle = h;
+    pool_.submit(this);
+  }
+  auto await_resume() noexcept {
+    if constexpr (Encrypt) {
+      for (std::size_t i = 0; i < tag_size; ++i) {
+        tag_out_[i] = static_cast<std::byte>(tag_[i]);
+      }
+    } else {
+      return ok_;
+    }
+  }
+
+private:
+  worker_pool& pool_;
+  std::span<std::byte> tag_out_;
+  bool inline_;
+};
+
+template <unsigned KeyBits> class gcm_sealer;
+template <unsigned KeyBits> class gcm_opener;
+
+namespace detail {
+
+// seal/open/sealer/opener over Derived::native_handle(), shared by the owning
+// gcm and the constexpr-constructible fixed_gcm.
+template <class Derived, unsigned KeyBits>
+class gcm_ops {
+  static_assert(KeyBits == 128 || KeyBits == 192 || KeyBits == 256 || KeyBits == 512,
+                "aes::gcm supports 128, 192, 256 and (non-standard) 512-bit keys");
+
+public:
+  static constexpr std::size_t key_size = KeyBits / 8;
+  static constexpr unsigned rounds = static_cast<unsigned>(key_size / 4 + 6);
+
+  // Encrypts pt into ct (same size, may alias) and writes the tag.
+  void seal(std::span<const std::byte> iv, std::span<const std::byte> aad,
+            std::span<const std::byte> pt, std::span<std::byte> ct,
+            std::span<std::byte, tag_size> tag) const {
+    if (ct.size() != pt.size()) {
+      throw error("aes::gcm: ciphertext size must equal plaintext size");
+    }
+    if (AES_GCM_encrypt(&ctx(), u8(iv), iv.size(), u8(aad), aad.size(), u8(pt), u8(ct), pt.size(),
+                        reinterpret_cast<std::uint8_t*>(tag.data())) != 0) {
+      throw error("aes::gcm: invalid arguments");
+    }
+  }
+
+  // Verifies the tag and decrypts ct into pt (same size, may alias).
+  // Returns false, with pt zeroed, if authentication fails.
+  [[nodiscard]] bool open(std::span<const std::byte> iv, std::span<const std::byte> aad,
+                          std::span<const std::byte> ct, std::span<const std::byte, tag_size> tag,
+                          std::span<std::byte> pt) const {
+    if (pt.size() != ct.size()) {
+      throw error("aes::gcm: plaintext size must equal ciphertext size");
+    }
+    int ret = AES_GCM_decrypt(&ctx(), u8(iv), iv.size(), u8(aad), aad.size(), u8(ct), u8(pt), ct.size(),
+                              reinterpret_cast<const std::uint8_t*>(tag.data()));
+    if (ret == -3) {
+      return false;
+    }
+    if (ret != 0) {
+      throw error("aes::gcm: invalid arguments");
+    }
+    return true;
+  }
+
+  // Streaming encryption/decryption of one message (see gcm_sealer/gcm_opener).
+  gcm_sealer<KeyBits> sealer(std::span<const std::byte> iv, std::span<const std::byte> aad = {}) const {
+    return gcm_sealer<KeyBits>(ctx(), iv, aad);
+  }
+  gcm_opener<KeyBits> opener(std::span<const std::byte> iv, std::span<const std::byte> aad = {}) const {
+    return gcm_opener<KeyBits>(ctx(), iv, aad);
+  }
+
+  // Coroutine versions of seal/open running on pool (see worker_pool):
+  //   co_await gcm.async_seal(pool, iv, aad, pt, ct, tag);
+  //   bool ok = co_await gcm.async_open(pool, iv, aad, ct, tag, pt);
+  // Argument errors throw immediately; all buffers must outlive the co_await.
+  [[nodiscard]] gcm_async<true> async_seal(worker_pool& pool, std::span<const std::byte> iv,
+                                           std::span<const std::byte> aad, std::span<const std::byte> pt,
+                                           std::span<std::byte> ct, std::span<std::byte, tag_size> tag) const {
+    return gcm_async<true>(pool, ctx(), iv, aad, pt, ct, tag, {});
+  }
+  [[nodiscard]] gcm_async<false> async_open(worker_pool& pool, std::span<const std::byte> iv,
+                                            std::span<const std::byte> aad, std::span<const std::byte> ct,
+                                            std::span<const std::byte, tag_size> tag,
+                                            std::span<std::byte> pt) const {
+    return gcm_async<false>(pool, ctx(), iv, aad, ct, pt, {}, tag);
+  }
+
+private:
+  constexpr const AES_ctx& ctx() const noexcept { return static_cast<const Derived&>(*this).native_handle(); }
+};
+
+} // namespace detail
+
+// AES-GCM with a key size fixed at compile time. Owns a cache-line aligned
+// C context that is wiped on destruction. The key size template argument is
+// checked statically (keys are std::span<const std::byte, key_size>), and the
+// C library runs the kernels unrolled for its round count.
+//
+// Instances are neither copyable nor movable: streams refer to them.
+template <unsigned KeyBits>
+class gcm : public detail::gcm_ops<gcm<KeyBits>, KeyBits> {
+public:
+  using detail::gcm_ops<gcm<KeyBits>, KeyBits>::key_size;
+
+  explicit gcm(std::span<const std::byte, key_size> key) {
+    if (AES_init_ctx_keylen(&ctx_, reinterpret_cast<const std::uint8_t*>(key.data()), key_size) != 0) {
+      throw error("aes::gcm: key size not compiled into the C library");
+    }
+  }
+  ~gcm() { detail::secure_wipe(&ctx_, sizeof(ctx_)); }
+
+  gcm(const gcm&) = delete;
+  gcm& operator=(const gcm&) = delete;
+
+  const AES_ctx& native_handle() const noexcept { return ctx_; }
+
+private:
+  AES_ctx ctx_; // Cache-line aligned by its type (AES_CTX_ALIGN)
+};
+
+// AES-GCM for keys embedded in the binary. The key schedule and H are
+// computed by portable::expand_key, so a constexpr instance is a literal in
+// .rodata with no startup cost:
+//
+//   static constexpr std::uint8_t kKey[32] = { ... };
+//   static constexpr aes::fixed_gcm<256> kSealer(kKey);
+//
+// Encryption at run time goes through the C kernels like gcm. There is no
+// wipe on destruction, as the key is part of the program image anyway.
+template <unsigned KeyBits>
+class fixed_gcm : public detail::gcm_ops<fixed_gcm<KeyBits>, KeyBits> {
+public:
+  using detail::gcm_ops<fixed_gcm<KeyBits>, KeyBits>::key_size;
+
+  constexpr explicit fixed_gcm(std::span<const std::uint8_t, key_size> key) : ctx_(portable::expand_key(key)) {}
+
+  constexpr const AES_ctx& native_handle() const noexcept { return ctx_; }
+
+private:
+  AES_ctx ctx_; // Cache-line aligned by its type (AES_CTX_ALIGN)
+};
+
+// Streaming encryption: update() may be called with any split of the
+// plaintext and emits the same number of ciphertext bytes; finish() writes the tag.
+template <unsigned KeyBits>
+class gcm_sealer : detail::gcm_stream {
+public:
+  void update(std::span<const std::byte> pt, std::span<std::byte> ct) { gcm_stream::update(pt, ct); }
+  void finish(std::span<std::byte, tag_size> tag) { gcm_stream::finish(reinterpret_cast<std::uint8_t*>(tag.data())); }
+
+private:
+  template <class, unsigned> friend class detail::gcm_ops;
+  gcm_sealer(const AES_ctx& ctx, std::span<const std::byte> iv, std::span<const std::byte> aad)
+      : gcm_stream(&ctx, iv, aad, &AES_GCM_encrypt_chunk) {}
+};
+
+// Streaming decryption. Plaintext from update() is unauthenticated until
+// finish() has returned true; discard it otherwise.
+template <unsigned KeyBits>
+class gcm_opener : detail::gcm_stream {
+public:
+  void update(std::span<const std::byte> ct, std::span<std::byte> pt) { gcm_stream::update(ct, pt); }
+
+  [[nodiscard]] bool finish(std::span<const std::byte, tag_size> tag) {
+    std::uint8_t expected[tag_size];
+    std::uint8_t diff = 0;
+    gcm_stream::finish(expected);
+    for (std::size_t i = 0; i < tag_size; ++i) { // Constant-time compare
+      diff |= static_cast<std::uint8_t>(expected[i] ^ static_cast<std::uint8_t>(tag[i]));
+    }
+    detail::secure_wipe(expected, sizeof(expected));
+    return diff == 0;
+  }
+
+private:
+  template <class, unsigned> friend class detail::gcm_ops;
+  gcm_opener(const AES_ctx& ctx, std::span<const std::byte> iv, std::span<const std::byte> aad)
+      : gcm_stream(&ctx, iv, aad, &AES_GCM_decrypt_chunk) {}
+};
+
+using gcm128 = gcm<128>;
+using gcm192 = gcm<192>;
+using gcm256 = gcm<256>;
+using gcm512 = gcm<512>;
+
+} // namespace aes
+
+#endif // __cplusplus >= 202002L
 
 #endif //_AES_HPP_
@@ -0,0 +1,431 @@
+/*
+
+Key-schedule cache (see aes_keycache.h).
+
+Entries live in one array that is never freed or moved while the cache exists,
+so a lookup may dereference an entry that is concurrently being evicted and
+recycled: it only trusts the entry after pinning it and re-checking the key ID.
+Each entry's state word holds a pin count and three flags:
+
+  0                 free, context wiped
+  VALID | pins      cached under key_id; lookups may pin it
+  DYING | pins      removed while pinned; the last unpin wipes it
+  LOCKED            owned by one thread that is wiping or filling it
+
+Pinning is a CAS that only succeeds while VALID is set; eviction is a CAS from
+exactly VALID (no pins) to LOCKED, so a pinned context is never wiped.
+
+Each shard maps key IDs to entry indexes with an open-addressed table of
+atomic buckets (linear probing, tombstones for deletions). Writers hold the
+shard's spinlock; readers probe without it. A reader racing with a writer can
+at worst miss an entry that is cached, which sends the caller down the insert
+path, where the lookup is repeated under the lock.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#endif
+
+#include "aes_keycache.h"
+
+#define ENTRY_VALID  ((uint64_t)1 << 63)
+#define ENTRY_DYING  ((uint64_t)1 << 62)
+#define ENTRY_LOCKED ((uint64_t)1 << 61)
+
+#define BUCKET_EMPTY UINT32_MAX
+#define BUCKET_TOMB  (UINT32_MAX - 1)
+
+#define CACHE_LINE 64
+#define MAX_ENTRIES ((size_t)1 << 30)
+
+struct entry
+{
+  uint64_t state;                // Flags and pin count, see above
+  uint64_t key_id;               // Written only while LOCKED
+  uint8_t referenced;            // CLOCK bit: used since the hand last passed
+  struct AES_ctx ctx;
+};
+
+struct shard
+{
+  // Written under the lock, read by lookups
+  uint32_t lock;
+  uint32_t hand;                 // CLOCK position, relative to first
+  uint32_t first;                // The shard owns entries [first, first + count)
+  uint32_t count;
+  uint32_t mask;                 // Buckets - 1
+  uint32_t tombs;
+  uint32_t* buckets;
+  uint8_t pad_[CACHE_LINE - 32];
+  // Counters, on their own cache line
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t inserts;
+  uint64_t evictions;
+  uint8_t pad2_[CACHE_LINE - 32];
+};
+
+struct AES_key_cache
+{
+  struct shard* shards;
+  uint8_t* entries;              // capacity entries of stride bytes
+  size_t stride;
+  size_t capacity;
+  uint32_t shard_mask;
+  void* shards_mem;
+  void* entries_mem;
+  uint32_t* buckets_mem;
+};
+
+// Zeroes through a volatile pointer so the stores cannot be elided.
+static void wipe(void* p, size_t n)
+{
+    volatile uint8_t* v = (volatile uint8_t*)p;
+    while (n--) {
+        *v++ = 0;
+    }
+}
+
+// calloc with the result rounded up to a cache line; *raw is what to free.
+static void* calloc_aligned(size_t n, void** raw)
+{
+    *raw = calloc(1, n + CACHE_LINE - 1);
+    if (*raw == NULL) {
+        return NULL;
+    }
+    return (void*)(((uintptr_t)*raw + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1));
+}
+
+// splitmix64 finaliser: the low bits pick the shard, the high bits the bucket,
+// so sequential tenant IDs spread over both.
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static struct entry* entry_at(const struct AES_key_cache* cache, uint32_t index)
+{
+    return (struct entry*)(cache->entries + (size_t)index * cache->stride);
+}
+
+static uint32_t entry_index(const struct AES_key_cache* cache, const struct entry* e)
+{
+    return (uint32_t)(((const uint8_t*)e - cache->entries) / cache->stride);
+}
+
+static void shard_lock(struct shard* s)
+{
+    while (__atomic_exchange_n(&s->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&s->lock, __ATOMIC_RELAXED)) {
+#if defined(__unix__) || defined(__APPLE__)
+            sched_yield(); // The holder may be descheduled; do not burn its time slice
+#endif
+        }
+    }
+}
+
+static void shard_unlock(struct shard* s)
+{
+    __atomic_store_n(&s->lock, 0, __ATOMIC_RELEASE);
+}
+
+static int entry_pin(struct entry* e)
+{
+    uint64_t state = __atomic_load_n(&e->state, __ATOMIC_RELAXED);
+    while (state & ENTRY_VALID) {
+        if (__atomic_compare_exchange_n(&e->state, &state, state + 1, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void entry_unpin(struct entry* e)
+{
+    uint64_t state = __atomic_sub_fetch(&e->state, 1, __ATOMIC_ACQ_REL);
+    uint64_t dying = ENTRY_DYING;
+    // Last pin of a removed entry: wipe it and hand the slot back
+    if (state == ENTRY_DYING &&
+        __atomic_compare_exchange_n(&e->state, &dying, ENTRY_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        wipe(&e->ctx, sizeof(e->ctx));
+        __atomic_store_n(&e->state, 0, __ATOMIC_RELEASE);
+    }
+}
+
+// Finds and pins the entry cached under key_id. Safe without the shard lock.
+static struct entry* table_find(const struct AES_key_cache* cache, const struct shard* s, uint64_t h, uint64_t key_id)
+{
+    uint32_t b = (uint32_t)(h >> 32) & s->mask;
+    for (uint32_t n = 0; n <= s->mask; ++n, b = (b + 1) & s->mask) {
+        uint32_t index = __atomic_load_n(&s->buckets[b], __ATOMIC_ACQUIRE);
+        if (index == BUCKET_EMPTY) {
+            break;
+        }
+        if (index == BUCKET_TOMB) {
+            continue;
+        }
+        struct entry* e = entry_at(cache, index);
+        if (__atomic_load_n(&e->key_id, __ATOMIC_RELAXED) == key_id && entry_pin(e)) {
+            // A pinned entry cannot be recycled, so this second check is stable
+            if (__atomic_load_n(&e->key_id, __ATOMIC_RELAXED) == key_id) {
+                return e;
+            }
+            entry_unpin(e);
+        }
+    }
+    return NULL;
+}
+
+// The functions below run under the shard lock.
+
+static void table_add(struct shard* s, uint64_t h, uint32_t index)
+{
+    uint32_t b = (uint32_t)(h >> 32) & s->mask;
+    for (;;) {
+        uint32_t cur = __atomic_load_n(&s->buckets[b], __ATOMIC_RELAXED);
+        if (cur == BUCKET_EMPTY || cur == BUCKET_TOMB) {
+            s->tombs -= cur == BUCKET_TOMB;
+            __atomic_store_n(&s->buckets[b], index, __ATOMIC_RELEASE);
+            return;
+        }
+        b = (b + 1) & s->mask; // There are at least twice as many buckets as entries
+    }
+}
+
+// Rebuilds the table from the VALID entries once tombstones would make
+// probes for absent keys long. Lookups running meanwhile may miss.
+static void table_rebuild(const struct AES_key_cache* cache, struct shard* s)
+{
+    for (uint32_t b = 0; b <= s->mask; ++b) {
+        __atomic_store_n(&s->buckets[b], BUCKET_EMPTY, __ATOMIC_RELAXED);
+    }
+    s->tombs = 0;
+    for (uint32_t i = s->first; i < s->first + s->count; ++i) {
+        struct entry* e = entry_at(cache, i);
+        if (__atomic_load_n(&e->state, __ATOMIC_RELAXED) & ENTRY_VALID) {
+            table_add(s, mix(__atomic_load_n(&e->key_id, __ATOMIC_RELAXED)), i);
+        }
+    }
+}
+
+static void table_del(const struct AES_key_cache* cache, struct shard* s, uint64_t h, uint32_t index)
+{
+    uint32_t b = (uint32_t)(h >> 32) & s->mask;
+    for (uint32_t n = 0; n <= s->mask; ++n, b = (b + 1) & s->mask) {
+        if (__atomic_load_n(&s->buckets[b], __ATOMIC_RELAXED) == index) {
+            __atomic_store_n(&s->buckets[b], BUCKET_TOMB, __ATOMIC_RELEASE);
+            if (++s->tombs > s->count / 2) {
+                table_rebuild(cache, s);
+            }
+            return;
+        }
+    }
+}
+
+// Claims an entry for a new key: a free one, or the first unpinned entry the
+// hand reaches whose CLOCK bit is clear (clearing the bits it passes). Two
+// sweeps are enough to find one unless every entry is pinned. Returns the
+// entry LOCKED, or NULL.
+static struct entry* clock_take(const struct AES_key_cache* cache, struct shard* s)
+{
+    for (uint32_t n = 0; n <= 2 * s->count; ++n) {
+        struct entry* e = entry_at(cache, s->first + s->hand);
+        s->hand = s->hand + 1 == s->count ? 0 : s->hand + 1;
+
+        uint64_t state = __atomic_load_n(&e->state, __ATOMIC_RELAXED);
+        if (state == 0) {
+            if (__atomic_compare_exchange_n(&e->state, &state, ENTRY_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                return e;
+            }
+            continue;
+        }
+        if (!(state & ENTRY_VALID)) {
+            continue; // DYING or being wiped
+        }
+        if (__atomic_load_n(&e->referenced, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&e->referenced, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (state == ENTRY_VALID &&
+            __atomic_compare_exchange_n(&e->state, &state, ENTRY_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            table_del(cache, s, mix(__atomic_load_n(&e->key_id, __ATOMIC_RELAXED)), entry_index(cache, e));
+            wipe(&e->ctx, sizeof(e->ctx));
+            __atomic_fetch_add(&s->evictions, 1, __ATOMIC_RELAXED);
+            return e;
+        }
+    }
+    return NULL;
+}
+
+struct AES_key_cache* AES_key_cache_new(size_t capacity, unsigned shards)
+{
+    if (capacity == 0 || capacity > MAX_ENTRIES) {
+        return NULL;
+    }
+    uint32_t nshards = 1;
+    while (nshards < (shards ? shards : AES_KEY_CACHE_DEFAULT_SHARDS) && nshards < (1u << 16)) {
+        nshards <<= 1;
+    }
+    while (nshards > capacity) {
+        nshards >>= 1;
+    }
+    uint32_t per_shard = (uint32_t)((capacity + nshards - 1) / nshards);
+    uint32_t buckets = 2;
+    while (buckets < 2 * per_shard) {
+        buckets <<= 1;
+    }
+
+    struct AES_key_cache* cache = calloc(1, sizeof(*cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->stride = (sizeof(struct entry) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    cache->capacity = (size_t)per_shard * nshards;
+    cache->shard_mask = nshards - 1;
+    cache->shards = calloc_aligned(nshards * sizeof(struct shard), &cache->shards_mem);
+    cache->entries = calloc_aligned(cache->capacity * cache->stride, &cache->entries_mem);
+    cache->buckets_mem = malloc((size_t)nshards * buckets * sizeof(uint32_t));
+    if (cache->shards == NULL || cache->entries == NULL || cache->buckets_mem == NULL) {
+        AES_key_cache_free(cache);
+        return NULL;
+    }
+    memset(cache->buckets_mem, 0xff, (size_t)nshards * buckets * sizeof(uint32_t)); // BUCKET_EMPTY
+    for (uint32_t i = 0; i < nshards; ++i) {
+        struct shard* s = &cache->shards[i];
+        s->first = i * per_shard;
+        s->count = per_shard;
+        s->mask = buckets - 1;
+        s->buckets = cache->buckets_mem + (size_t)i * buckets;
+    }
+    return cache;
+}
+
+void AES_key_cache_free(struct AES_key_cache* cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+    if (cache->entries != NULL) {
+        wipe(cache->entries, cache->capacity * cache->stride);
+    }
+    free(cache->buckets_mem);
+    free(cache->entries_mem);
+    free(cache->shards_mem);
+    free(cache);
+}
+
+const struct AES_ctx* AES_key_cache_get(struct AES_key_cache* cache, uint64_t key_id)
+{
+    if (cache == NULL) {
+        return NULL;
+    }
+    uint64_t h = mix(key_id);
+    struct shard* s = &cache->shards[h & cache->shard_mask];
+    struct entry* e = table_find(cache, s, h, key_id);
+    if (e == NULL) {
+        __atomic_fetch_add(&s->misses, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    // Only store when the bit is clear, so hot entries are not written twice per hit
+    if (!__atomic_load_n(&e->referenced, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&e->referenced, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&s->hits, 1, __ATOMIC_RELAXED);
+    return &e->ctx;
+}
+
+const struct AES_ctx* AES_key_cache_insert(struct AES_key_cache* cache, uint64_t key_id,
+                                           const uint8_t* key, size_t key_len)
+{
+    if (cache == NULL || key == NULL) {
+        return NULL;
+    }
+    // Expand outside the lock; only the copy into the slot is serialised
+    struct AES_ctx fresh;
+    if (AES_init_ctx_keylen(&fresh, key, key_len) != 0) {
+        return NULL;
+    }
+    uint64_t h = mix(key_id);
+    struct shard* s = &cache->shards[h & cache->shard_mask];
+
+    shard_lock(s);
+    struct entry* e = table_find(cache, s, h, key_id);
+    if (e == NULL && (e = clock_take(cache, s)) != NULL) {
+        __atomic_store_n(&e->key_id, key_id, __ATOMIC_RELAXED);
+        memcpy(&e->ctx, &fresh, sizeof(fresh));
+        __atomic_store_n(&e->referenced, 1, __ATOMIC_RELAXED);
+        table_add(s, h, entry_index(cache, e));
+        __atomic_store_n(&e->state, ENTRY_VALID | 1, __ATOMIC_RELEASE); // Publish, pinned for the caller
+        __atomic_fetch_add(&s->inserts, 1, __ATOMIC_RELAXED);
+    }
+    shard_unlock(s);
+
+    wipe(&fresh, sizeof(fresh));
+    return e != NULL ? &e->ctx : NULL;
+}
+
+void AES_key_cache_release(struct AES_key_cache* cache, const struct AES_ctx* ctx)
+{
+    if (cache == NULL || ctx == NULL) {
+        return;
+    }
+    entry_unpin((struct entry*)((uint8_t*)(uintptr_t)ctx - offsetof(struct entry, ctx)));
+}
+
+int AES_key_cache_remove(struct AES_key_cache* cache, uint64_t key_id)
+{
+    if (cache == NULL) {
+        return -1;
+    }
+    uint64_t h = mix(key_id);
+    struct shard* s = &cache->shards[h & cache->shard_mask];
+
+    shard_lock(s);
+    struct entry* e = table_find(cache, s, h, key_id);
+    if (e != NULL) {
+        // Stop new pins first (a rebuild in table_del only keeps VALID
+        // entries). The pin taken by table_find keeps the entry from being
+        // wiped until the unpin below, or a later one, drops the last pin.
+        uint64_t state = __atomic_load_n(&e->state, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&e->state, &state, (state & ~ENTRY_VALID) | ENTRY_DYING, 1,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        }
+        table_del(cache, s, h, entry_index(cache, e));
+    }
+    shard_unlock(s);
+
+    if (e == NULL) {
+        return -1;
+    }
+    entry_unpin(e);
+    return 0;
+}
+
+void AES_key_cache_stats(const struct AES_key_cache* cache, struct AES_key_cache_stats* out)
+{
+    if (out == NULL) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (cache == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i <= cache->shard_mask; ++i) {
+        const struct shard* s = &cache->shards[i];
+        out->hits += __atomic_load_n(&s->hits, __ATOMIC_RELAXED);
+        out->misses += __atomic_load_n(&s->misses, __ATOMIC_RELAXED);
+        out->inserts += __atomic_load_n(&s->inserts, __ATOMIC_RELAXED);
+        out->evictions += __atomic_load_n(&s->evictions, __ATOMIC_RELAXED);
+    }
+    for (size_t i = 0; i < cache->capacity; ++i) {
+        out->entries += (__atomic_load_n(&entry_at(cache, (uint32_t)i)->state, __ATOMIC_RELAXED) & ENTRY_VALID) != 0;
+    }
+    out->capacity = cache->capacity;
+}
@@ -0,0 +1,110 @@
+#ifndef _AES_KEYCACHE_H_
+#define _AES_KEYCACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aes.h"
+
+// --- Key-schedule cache ---
+//
+// Maps 64-bit key IDs (tenant or key-version identifiers chosen by the caller)
+// to initialised contexts, so that a hot key is expanded once rather than on
+// every request:
+//
+//   const struct AES_ctx* ctx = AES_key_cache_get(cache, id);
+//   if (ctx == NULL) {
+//       // load the key for id from the key store, then
+//       ctx = AES_key_cache_insert(cache, id, key, key_len);
+//   }
+//   AES_GCM_encrypt(ctx, ...);
+//   AES_key_cache_release(cache, ctx);
+//
+// Every context returned by get or insert is pinned until it is released: it is
+// never evicted or wiped while in use. Lookups take no locks; they pin the entry
+// with a single atomic update. Inserts and removals lock one shard. When a
+// shard is full an unpinned entry is evicted in CLOCK order (an approximation
+// of LRU: entries used since the clock hand last passed them are skipped).
+// Evicted and removed contexts are zeroed before their slot is reused, and the
+// cache keeps only expanded contexts, never the raw keys.
+//
+// Key IDs are hashed to shards, which fill unevenly: size the cache with some
+// headroom over the hot set (e.g. twice) or some hot keys will keep evicting
+// each other.
+//
+// All functions are thread-safe except AES_key_cache_free.
+
+#define AES_KEY_CACHE_DEFAULT_SHARDS 16
+
+struct AES_key_cache;
+
+struct AES_key_cache_stats
+{
+  uint64_t hits;                 // Lookups that returned a context
+  uint64_t misses;               // Lookups that found nothing
+  uint64_t inserts;              // Contexts expanded into the cache
+  uint64_t evictions;            // Unpinned contexts dropped to make room
+  uint64_t entries;              // Contexts currently cached
+  uint64_t capacity;
+};
+
+/**
+ * @brief Creates an empty cache.
+ *
+ * @param capacity  Contexts held at most; rounded up to a multiple of shards.
+ * @param shards    Independent shards, rounded up to a power of two
+ *                  (0: AES_KEY_CACHE_DEFAULT_SHARDS, and at most capacity).
+ * @return          The cache, or NULL if capacity is 0 or allocation fails.
+ */
+struct AES_key_cache* AES_key_cache_new(size_t capacity, unsigned shards);
+
+/** @brief Wipes every cached context and frees the cache. No context may be pinned. */
+void AES_key_cache_free(struct AES_key_cache* cache);
+
+/**
+ * @brief Looks up key_id and pins its context.
+ *
+ * @return          The context (release it with AES_key_cache_release), or NULL
+ *                  if key_id is not cached.
+ */
+const struct AES_ctx* AES_key_cache_get(struct AES_key_cache* cache, uint64_t key_id);
+
+/**
+ * @brief Expands key into the cache under key_id and pins it.
+ *
+ * If key_id is already cached (e.g. another thread inserted it after this
+ * thread's miss), the cached context is returned and key is not used. Changing
+ * the key of an ID requires AES_key_cache_remove first.
+ *
+ * @param key_len   16, 24, 32 or 64.
+ * @return          The pinned context, or NULL on invalid arguments or when
+ *                  every entry of the shard is pinned.
+ */
+const struct AES_ctx* AES_key_cache_insert(struct AES_key_cache* cache, uint64_t key_id,
+                                           const uint8_t* key, size_t key_len);
+
+/** @brief Unpins a context returned by AES_key_cache_get or AES_key_cache_insert. */
+void AES_key_cache_release(struct AES_key_cache* cache, const struct AES_ctx* ctx);
+
+/**
+ * @brief Drops key_id from the cache (e.g. after rotation or revocation).
+ *
+ * Later lookups miss at once. The context is wiped immediately, or when the
+ * last thread using it releases it.
+ *
+ * @return int      0 if key_id was cached, -1 otherwise.
+ */
+int AES_key_cache_remove(struct AES_key_cache* cache, uint64_t key_id);
+
+/** @brief Copies the cache's counters; they are summed over shards without locking. */
+void AES_key_cache_stats(const struct AES_key_cache* cache, struct AES_key_cache_stats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AES_KEYCACHE_H_
@@ -0,0 +1,93 @@
+/*
+
+Nonce leases (see aes_nonce.h).
+
+The fast path of AES_nonce_next only reads and writes the caller's lease. The
+source's counter is advanced with one relaxed fetch-add per block; the order in
+which blocks are handed out does not matter, only that no two leases receive
+overlapping ranges, which the atomic read-modify-write guarantees.
+
+*/
+
+#include <string.h>
+
+#include "aes_nonce.h"
+
+int AES_nonce_source_init(struct AES_nonce_source* src, const struct AES_ctx* ctx,
+                          const uint8_t prefix[AES_NONCE_PREFIX_LEN], uint64_t limit)
+{
+    if (src == NULL || ctx == NULL || prefix == NULL) {
+        return -1;
+    }
+    memset(src, 0, sizeof(*src));
+    src->ctx = ctx;
+    src->limit = limit ? limit : AES_NONCE_DEFAULT_LIMIT;
+    memcpy(src->prefix, prefix, AES_NONCE_PREFIX_LEN);
+    __atomic_store_n(&src->next, 0, __ATOMIC_RELEASE);
+    return 0;
+}
+
+uint64_t AES_nonce_remaining(const struct AES_nonce_source* src)
+{
+    uint64_t next = __atomic_load_n(&src->next, __ATOMIC_RELAXED);
+    return next < src->limit ? src->limit - next : 0;
+}
+
+int AES_nonce_lease_init(struct AES_nonce_lease* lease, struct AES_nonce_source* src, uint32_t block)
+{
+    if (lease == NULL || src == NULL) {
+        return -1;
+    }
+    lease->src = src;
+    lease->next = 0;
+    lease->end = 0;
+    lease->block = block ? block : AES_NONCE_DEFAULT_BLOCK;
+    return 0;
+}
+
+// Reserves the next block for the lease; -4 once the source is exhausted.
+static int lease_refill(struct AES_nonce_lease* lease)
+{
+    struct AES_nonce_source* src = lease->src;
+    // Check first so that exhausted sources are not written to at all (and the
+    // counter cannot creep towards wrapping around)
+    if (__atomic_load_n(&src->next, __ATOMIC_RELAXED) >= src->limit) {
+        return -4;
+    }
+    uint64_t start = __atomic_fetch_add(&src->next, lease->block, __ATOMIC_RELAXED);
+    if (start >= src->limit) {
+        return -4; // Another lease took the last block
+    }
+    lease->next = start;
+    lease->end = src->limit - start < lease->block ? src->limit : start + lease->block;
+    return 0;
+}
+
+int AES_nonce_next(struct AES_nonce_lease* lease, uint8_t iv[AES_GCM_IV_LEN])
+{
+    if (lease == NULL || lease->src == NULL || iv == NULL) {
+        return -1;
+    }
+    if (lease->next == lease->end && lease_refill(lease) != 0) {
+        return -4;
+    }
+    uint64_t counter = lease->next++;
+    memcpy(iv, lease->src->prefix, AES_NONCE_PREFIX_LEN);
+    for (int i = AES_GCM_IV_LEN - 1; i >= AES_NONCE_PREFIX_LEN; --i) {
+        iv[i] = (uint8_t)counter;
+        counter >>= 8;
+    }
+    return 0;
+}
+
+int AES_GCM_encrypt_next(struct AES_nonce_lease* lease,
+                         const uint8_t* aad, size_t aad_len,
+                         const uint8_t* pt, uint8_t* ct, size_t pt_len,
+                         uint8_t iv[AES_GCM_IV_LEN], uint8_t* tag)
+{
+    int ret = AES_nonce_next(lease, iv);
+    if (ret != 0) {
+        return ret;
+    }
+    return AES_GCM_encrypt(lease->src->ctx, iv, AES_GCM_IV_LEN, aad, aad_len, pt, ct, pt_len, tag);
+}
@@ -0,0 +1,106 @@
+#ifndef _AES_NONCE_H_
+#define _AES_NONCE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aes.h"
+
+// --- Nonce leases ---
+//
+// Deterministic 96-bit GCM IVs for one key: a fixed 4-byte prefix followed by a
+// 64-bit big-endian counter. A source owns the counter space of a context; each
+// thread holds its own lease and reserves counters from the source in blocks,
+// so generating an IV normally touches only the thread's lease and the shared
+// counter is written once per block:
+//
+//   AES_nonce_source_init(&src, &ctx, prefix, 0);      // once per key
+//   AES_nonce_lease_init(&lease, &src, 0);             // once per thread
+//   AES_GCM_encrypt_next(&lease, aad, aad_len, pt, ct, len, iv, tag);
+//
+// Every source sharing a key needs a different prefix (e.g. one per process or
+// host). Counters left in a lease that is dropped are never reused, so IVs are
+// unique but not necessarily consecutive. Once limit counters have been
+// reserved the source is exhausted and every call returns -4: rekey then.
+//
+// limit defaults to 2^32 messages per key. That is a conservative policy
+// default, not the spec bound for these IVs: SP 800-38D section 8.3 sets 2^32
+// for random or non-96-bit IVs, while deterministic IVs like these are bounded
+// by the 2^64 counter field. Raise it only where a deployment's own analysis
+// allows.
+
+#define AES_NONCE_PREFIX_LEN 4
+#define AES_NONCE_DEFAULT_LIMIT ((uint64_t)1 << 32)
+#define AES_NONCE_DEFAULT_BLOCK 1024
+
+struct AES_nonce_source
+{
+  uint64_t next;                 // First unreserved counter (shared; updated atomically)
+  uint8_t pad_[56];              // Keeps the fields below off the counter's cache line
+  const struct AES_ctx* ctx;
+  uint64_t limit;                // Counters [0, limit) may be used
+  uint8_t prefix[AES_NONCE_PREFIX_LEN];
+};
+
+struct AES_nonce_lease
+{
+  struct AES_nonce_source* src;
+  uint64_t next;                 // Reserved counters [next, end) not yet used
+  uint64_t end;
+  uint32_t block;                // Counters reserved per refill
+};
+
+/**
+ * @brief Initialises a nonce source for the key in ctx.
+ *
+ * @param ctx       Initialised context; sealed through by AES_GCM_encrypt_next.
+ * @param prefix    AES_NONCE_PREFIX_LEN bytes, unique among sources of this key.
+ * @param limit     Messages allowed under the key (0: AES_NONCE_DEFAULT_LIMIT).
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_nonce_source_init(struct AES_nonce_source* src, const struct AES_ctx* ctx,
+                          const uint8_t prefix[AES_NONCE_PREFIX_LEN], uint64_t limit);
+
+/** @brief Counters not yet reserved by any lease (an upper bound on messages left). */
+uint64_t AES_nonce_remaining(const struct AES_nonce_source* src);
+
+/**
+ * @brief Initialises an empty lease on src; the first IV reserves a block.
+ *
+ * A lease must only be used by one thread at a time.
+ *
+ * @param block     Counters reserved per refill (0: AES_NONCE_DEFAULT_BLOCK).
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_nonce_lease_init(struct AES_nonce_lease* lease, struct AES_nonce_source* src, uint32_t block);
+
+/**
+ * @brief Writes the next unique IV of the lease.
+ *
+ * @param iv        Output, AES_GCM_IV_LEN bytes.
+ * @return int      0 on success, -1 on invalid arguments, -4 if the source is
+ *                  exhausted.
+ */
+int AES_nonce_next(struct AES_nonce_lease* lease, uint8_t iv[AES_GCM_IV_LEN]);
+
+/**
+ * @brief AES_GCM_encrypt under the lease's context with the next IV.
+ *
+ * @param iv        Output: the IV used (AES_GCM_IV_LEN bytes), needed to decrypt.
+ * @return int      0 on success, -1 on invalid arguments, -4 if the source is
+ *                  exhausted (nothing is encrypted).
+ */
+int AES_GCM_encrypt_next(struct AES_nonce_lease* lease,
+                         const uint8_t* aad, size_t aad_len,
+                         const uint8_t* pt, uint8_t* ct, size_t pt_len,
+                         uint8_t iv[AES_GCM_IV_LEN], uint8_t* tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AES_NONCE_H_
@@ -0,0 +1,216 @@
+/*
+
+Segmented AES-GCM container (see aes_seg.h for the format).
+
+Every segment is an ordinary AES_GCM_encrypt message with a 96-bit IV, so the
+fast J0 path is always taken and segments can be sealed or opened in any order
+and on any thread.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "aes_seg.h"
+
+static const uint8_t seg_magic[4] = { 'A', 'G', 'S', '1' };
+
+static void put_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void put_be64(uint8_t* p, uint64_t v) {
+    put_be32(p, (uint32_t)(v >> 32));
+    put_be32(p + 4, (uint32_t)v);
+}
+
+static uint64_t get_be64(const uint8_t* p) {
+    return ((uint64_t)get_be32(p) << 32) | get_be32(p + 4);
+}
+
+static int seg_key_len_valid(unsigned key_len) {
+    return key_len == 16 || key_len == 24 || key_len == 32 || key_len == 64;
+}
+
+static uint64_t seg_count(uint32_t segment_size, uint64_t plaintext_len) {
+    if (plaintext_len == 0) {
+        return 1; // One empty segment, so an empty object still carries a tag
+    }
+    return (plaintext_len - 1) / segment_size + 1;
+}
+
+int AES_seg_header_write(const struct AES_seg_params* params, uint8_t header[AES_SEG_HEADER_LEN])
+{
+    if (params == NULL || header == NULL || params->segment_size == 0 || !seg_key_len_valid(params->key_len) ||
+        seg_count(params->segment_size, params->plaintext_len) > ((uint64_t)1 << 32)) {
+        return -1;
+    }
+    memset(header, 0, AES_SEG_HEADER_LEN);
+    memcpy(header, seg_magic, sizeof(seg_magic));
+    header[4] = AES_SEG_VERSION;
+    header[5] = (uint8_t)(params->key_len / 8);
+    put_be32(header + 8, params->segment_size);
+    put_be64(header + 12, params->plaintext_len);
+    memcpy(header + 20, params->nonce_base, AES_SEG_NONCE_BASE_LEN);
+    return 0;
+}
+
+int AES_seg_header_read(const uint8_t header[AES_SEG_HEADER_LEN], struct AES_seg_params* params)
+{
+    static const uint8_t zero[4] = { 0 };
+    if (header == NULL || params == NULL || memcmp(header, seg_magic, sizeof(seg_magic)) != 0 ||
+        header[4] != AES_SEG_VERSION || header[6] != 0 || header[7] != 0 || memcmp(header + 28, zero, 4) != 0) {
+        return -1;
+    }
+    params->key_len = (uint8_t)(header[5] * 8);
+    params->segment_size = get_be32(header + 8);
+    params->plaintext_len = get_be64(header + 12);
+    memcpy(params->nonce_base, header + 20, AES_SEG_NONCE_BASE_LEN);
+    if (params->segment_size == 0 || !seg_key_len_valid(params->key_len) ||
+        seg_count(params->segment_size, params->plaintext_len) > ((uint64_t)1 << 32)) {
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t AES_seg_count(const struct AES_seg_params* params)
+{
+    return seg_count(params->segment_size, params->plaintext_len);
+}
+
+size_t AES_seg_plain_len(const struct AES_seg_params* params, uint64_t index)
+{
+    uint64_t start = index * params->segment_size;
+    if (index >= AES_seg_count(params)) {
+        return 0;
+    }
+    return (size_t)(params->plaintext_len - start < params->segment_size ? params->plaintext_len - start
+                                                                         : params->segment_size);
+}
+
+uint64_t AES_seg_offset(const struct AES_seg_params* params, uint64_t index)
+{
+    return AES_SEG_HEADER_LEN + index * ((uint64_t)params->segment_size + AES_GCM_TAG_LEN);
+}
+
+uint64_t AES_seg_sealed_len(const struct AES_seg_params* params)
+{
+    return AES_SEG_HEADER_LEN + params->plaintext_len + AES_seg_count(params) * AES_GCM_TAG_LEN;
+}
+
+// Checks that ctx, header and index agree and builds the segment's IV and AAD.
+static int seg_prepare(const struct AES_ctx* ctx, const uint8_t header[AES_SEG_HEADER_LEN], uint64_t index,
+                       size_t len, uint8_t iv[AES_GCM_IV_LEN], uint8_t aad[AES_SEG_HEADER_LEN + 1])
+{
+    struct AES_seg_params params;
+    if (ctx == NULL || AES_seg_header_read(header, &params) != 0) {
+        return -1;
+    }
+    uint64_t count = AES_seg_count(&params);
+    if (index >= count || len != AES_seg_plain_len(&params, index) || ctx->Nr != params.key_len / 4 + 6) {
+        return -1; // Wrong segment length (or index), or a key of another size
+    }
+    memcpy(iv, params.nonce_base, AES_SEG_NONCE_BASE_LEN);
+    put_be32(iv + AES_SEG_NONCE_BASE_LEN, (uint32_t)index);
+    memcpy(aad, header, AES_SEG_HEADER_LEN);
+    aad[AES_SEG_HEADER_LEN] = index == count - 1; // Last-segment flag
+    return 0;
+}
+
+int AES_seg_seal(const struct AES_ctx* ctx, const uint8_t header[AES_SEG_HEADER_LEN], uint64_t index,
+                 const uint8_t* pt, size_t pt_len, uint8_t* out)
+{
+    uint8_t iv[AES_GCM_IV_LEN], aad[AES_SEG_HEADER_LEN + 1];
+    if (out == NULL || seg_prepare(ctx, header, index, pt_len, iv, aad) != 0) {
+        return -1;
+    }
+    return AES_GCM_encrypt(ctx, iv, sizeof(iv), aad, sizeof(aad), pt, out, pt_len, out + pt_len);
+}
+
+int AES_seg_open(const struct AES_ctx* ctx, const uint8_t header[AES_SEG_HEADER_LEN], uint64_t index,
+                 const uint8_t* in, size_t in_len, uint8_t* pt)
+{
+    uint8_t iv[AES_GCM_IV_LEN], aad[AES_SEG_HEADER_LEN + 1];
+    if (in == NULL || in_len < AES_GCM_TAG_LEN ||
+        seg_prepare(ctx, header, index, in_len - AES_GCM_TAG_LEN, iv, aad) != 0) {
+        return -1;
+    }
+    size_t ct_len = in_len - AES_GCM_TAG_LEN;
+    return AES_GCM_decrypt(ctx, iv, sizeof(iv), aad, sizeof(aad), in, pt, ct_len, in + ct_len);
+}
+
+int AES_seg_encrypt(const struct AES_ctx* ctx, const struct AES_seg_params* params, const uint8_t* pt,
+                    uint8_t* out)
+{
+    if (params == NULL || out == NULL || (pt == NULL && params->plaintext_len > 0) ||
+        AES_seg_header_write(params, out) != 0) {
+        return -1;
+    }
+    uint64_t count = AES_seg_count(params);
+    for (uint64_t i = 0; i < count; ++i) {
+        size_t n = AES_seg_plain_len(params, i);
+        const uint8_t* in = n ? pt + i * params->segment_size : NULL;
+        if (AES_seg_seal(ctx, out, i, in, n, out + AES_seg_offset(params, i)) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int AES_seg_decrypt_range(const struct AES_ctx* ctx, const uint8_t* sealed, uint64_t sealed_len,
+                          uint64_t offset, size_t len, uint8_t* out)
+{
+    struct AES_seg_params params;
+    uint8_t* scratch = NULL;
+    int ret = 0;
+
+    if (sealed == NULL || (out == NULL && len > 0) || sealed_len < AES_SEG_HEADER_LEN ||
+        AES_seg_header_read(sealed, &params) != 0 || sealed_len != AES_seg_sealed_len(&params) ||
+        offset > params.plaintext_len || len > params.plaintext_len - offset) {
+        return -1;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    uint64_t first = offset / params.segment_size;
+    uint64_t last = (offset + len - 1) / params.segment_size;
+    size_t done = 0;
+    for (uint64_t i = first; i <= last && ret == 0; ++i) {
+        uint64_t seg_start = i * params.segment_size;
+        size_t seg_len = AES_seg_plain_len(&params, i);
+        size_t from = (size_t)(offset + done - seg_start); // Offset of the range within this segment
+        size_t n = seg_len - from < len - done ? seg_len - from : len - done;
+        const uint8_t* in = sealed + AES_seg_offset(&params, i);
+
+        if (from == 0 && n == seg_len) { // Whole segment: decrypt in place in out
+            ret = AES_seg_open(ctx, sealed, i, in, seg_len + AES_GCM_TAG_LEN, out + done);
+        } else { // Partial first/last segment: decrypt to scratch, copy the slice
+            if (scratch == NULL && (scratch = (uint8_t*)malloc(params.segment_size)) == NULL) {
+                ret = -1;
+                break;
+            }
+            ret = AES_seg_open(ctx, sealed, i, in, seg_len + AES_GCM_TAG_LEN, scratch);
+            if (ret == 0) {
+                memcpy(out + done, scratch + from, n);
+            }
+        }
+        done += n;
+    }
+
+    if (scratch != NULL) {
+        memset(scratch, 0, params.segment_size);
+        free(scratch);
+    }
+    if (ret != 0) {
+        memset(out, 0, len); // Release nothing from a range that failed authentication
+    }
+    return ret;
+}
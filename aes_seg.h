@@ -0,0 +1,138 @@
+#ifndef _AES_SEG_H_
+#define _AES_SEG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aes.h"
+
+// --- Segmented GCM container ---
+//
+// A large object is sealed as fixed-size segments so that any byte range can be
+// decrypted by authenticating only the segments that cover it:
+//
+//   header (AES_SEG_HEADER_LEN bytes)
+//   segment 0: ciphertext (segment_size bytes) || tag (AES_GCM_TAG_LEN bytes)
+//   ...
+//   segment n-1: ciphertext (1..segment_size bytes, 0 for an empty object) || tag
+//
+// Header layout (integers big-endian):
+//
+//   0   magic "AGS1"
+//   4   version (1)
+//   5   key length in bytes / 8 (2, 3, 4 or 8)
+//   6   reserved, zero (2 bytes)
+//   8   segment_size, plaintext bytes per segment (uint32)
+//   12  plaintext_len (uint64)
+//   20  nonce_base (8 bytes, random per object)
+//   28  reserved, zero (4 bytes)
+//
+// Segment i is AES_GCM_encrypt with IV = nonce_base || uint32(i) and
+// AAD = header || last, where last is 1 for the final segment and 0 otherwise.
+// Authenticating the header with every segment binds the parameters and the
+// length, so truncation, extension, reordering and splicing segments from
+// another object all fail authentication. An object has at most 2^32 segments.
+//
+// nonce_base must be unique per object under a key. It is random (8 bytes), so
+// rotate the key well before 2^32 objects.
+
+#define AES_SEG_HEADER_LEN 32
+#define AES_SEG_NONCE_BASE_LEN 8
+#define AES_SEG_VERSION 1
+#define AES_SEG_DEFAULT_SEGMENT_SIZE 65536
+
+struct AES_seg_params
+{
+  uint32_t segment_size;   // Plaintext bytes per segment (> 0)
+  uint64_t plaintext_len;  // Total plaintext length
+  uint8_t key_len;         // Key length in bytes (16, 24, 32 or 64)
+  uint8_t nonce_base[AES_SEG_NONCE_BASE_LEN];
+};
+
+/**
+ * @brief Serialises params into a header.
+ *
+ * @return int      0 on success, -1 on invalid parameters (segment_size 0, an
+ *                  unsupported key length, or more than 2^32 segments).
+ */
+int AES_seg_header_write(const struct AES_seg_params* params, uint8_t header[AES_SEG_HEADER_LEN]);
+
+/**
+ * @brief Parses and validates a header.
+ *
+ * @return int      0 on success, -1 if the header is malformed or unsupported.
+ */
+int AES_seg_header_read(const uint8_t header[AES_SEG_HEADER_LEN], struct AES_seg_params* params);
+
+/** @brief Number of segments (at least 1; an empty object has one empty segment). */
+uint64_t AES_seg_count(const struct AES_seg_params* params);
+
+/** @brief Plaintext length of segment index (0 if index is out of range). */
+size_t AES_seg_plain_len(const struct AES_seg_params* params, uint64_t index);
+
+/** @brief Byte offset of segment index in the sealed object (header included). */
+uint64_t AES_seg_offset(const struct AES_seg_params* params, uint64_t index);
+
+/** @brief Total sealed length: header, ciphertext and one tag per segment. */
+uint64_t AES_seg_sealed_len(const struct AES_seg_params* params);
+
+/**
+ * @brief Seals one segment.
+ *
+ * @param ctx       Context initialised with a key of params' key length.
+ * @param header    The object's header (from AES_seg_header_write).
+ * @param index     Segment index.
+ * @param pt        Plaintext of the segment, AES_seg_plain_len(index) bytes.
+ * @param pt_len    Must equal AES_seg_plain_len(index).
+ * @param out       Output: ciphertext followed by the tag (pt_len + AES_GCM_TAG_LEN bytes).
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_seg_seal(const struct AES_ctx* ctx, const uint8_t header[AES_SEG_HEADER_LEN], uint64_t index,
+                 const uint8_t* pt, size_t pt_len, uint8_t* out);
+
+/**
+ * @brief Authenticates and decrypts one segment.
+ *
+ * @param in        Ciphertext followed by the tag (in_len bytes).
+ * @param in_len    Must equal AES_seg_plain_len(index) + AES_GCM_TAG_LEN.
+ * @param pt        Output plaintext (in_len - AES_GCM_TAG_LEN bytes), zeroed on failure.
+ * @return int      0 on success, -1 on invalid arguments, -3 if authentication failed.
+ */
+int AES_seg_open(const struct AES_ctx* ctx, const uint8_t header[AES_SEG_HEADER_LEN], uint64_t index,
+                 const uint8_t* in, size_t in_len, uint8_t* pt);
+
+/**
+ * @brief Seals a whole in-memory object.
+ *
+ * @param params    Parameters; params->plaintext_len is the length of pt.
+ * @param pt        Plaintext.
+ * @param out       Output buffer of AES_seg_sealed_len(params) bytes.
+ * @return int      0 on success, -1 on invalid arguments.
+ */
+int AES_seg_encrypt(const struct AES_ctx* ctx, const struct AES_seg_params* params, const uint8_t* pt,
+                    uint8_t* out);
+
+/**
+ * @brief Decrypts bytes [offset, offset + len) of a sealed object.
+ *
+ * Only the segments covering the range are read and authenticated, so sealed
+ * may be a memory-mapped file of any size.
+ *
+ * @param sealed        The sealed object (header first).
+ * @param sealed_len    Its length; must match the header.
+ * @param out           Output buffer of len bytes; zeroed on failure.
+ * @return int          0 on success, -1 on invalid arguments or a range past
+ *                      the end, -3 if a covering segment failed authentication.
+ */
+int AES_seg_decrypt_range(const struct AES_ctx* ctx, const uint8_t* sealed, uint64_t sealed_len,
+                          uint64_t offset, size_t len, uint8_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AES_SEG_H_
@@ -0,0 +1,402 @@
+/*
+
+io_uring pipeline for the segmented container (see aes_seg_uring.h).
+
+The ring is driven with the raw io_uring_setup/io_uring_enter/io_uring_register
+system calls. Each of the depth slots owns one registered buffer and cycles
+through read -> seal/open in place -> write -> next segment; completions are
+reaped in whatever order the kernel finishes them.
+
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include "aes_seg_uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define AES_SEG_URING 1
+#endif
+#endif
+#endif
+
+#ifdef AES_SEG_URING
+
+#define URING_MAX_IO (1u << 30) // Bytes per read/write; longer segments are split
+
+struct uring {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void* sq_ring;
+    void* cq_ring;
+    size_t sq_ring_len, cq_ring_len, sqes_len;
+    unsigned to_submit;
+};
+
+static int uring_init(struct uring* ring, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (ring->fd < 0) {
+        return -2; // ENOSYS, or disabled by sysctl/seccomp
+    }
+    ring->entries = p.sq_entries;
+    ring->sq_ring_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_ring_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) { // One mapping holds both rings
+        if (ring->cq_ring_len > ring->sq_ring_len) {
+            ring->sq_ring_len = ring->cq_ring_len;
+        }
+        ring->cq_ring_len = ring->sq_ring_len;
+    }
+    ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                         IORING_OFF_SQ_RING);
+    ring->cq_ring = (p.features & IORING_FEAT_SINGLE_MMAP)
+                        ? ring->sq_ring
+                        : mmap(NULL, ring->cq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                               IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                      IORING_OFF_SQES);
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        return -1;
+    }
+
+    uint8_t* sq = (uint8_t*)ring->sq_ring;
+    uint8_t* cq = (uint8_t*)ring->cq_ring;
+    ring->sq_head = (unsigned*)(sq + p.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + p.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + p.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+static void uring_exit(struct uring* ring) {
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_len);
+    }
+    if (ring->cq_ring != NULL && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_len);
+    }
+    if (ring->sq_ring != NULL && ring->sq_ring != MAP_FAILED) {
+        munmap(ring->sq_ring, ring->sq_ring_len);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+}
+
+// Queues one read or write. There is never more than one operation per slot
+// and the ring has at least as many entries as slots, so the SQ cannot be full.
+static void uring_queue(struct uring* ring, uint8_t opcode, int fd, void* buf, unsigned len, uint64_t offset,
+                        int buf_index, uint64_t user_data) {
+    unsigned tail = *ring->sq_tail; // Only this thread writes the tail
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->buf_index = (uint16_t)(buf_index < 0 ? 0 : buf_index);
+    sqe->user_data = user_data;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
+}
+
+// Submits queued operations and waits for at least one completion.
+static int uring_submit_and_wait(struct uring* ring) {
+    for (;;) {
+        long n = syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (n >= 0) {
+            ring->to_submit -= (unsigned)n;
+            return 0;
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            return -1;
+        }
+    }
+}
+
+enum slot_state { SLOT_IDLE, SLOT_READ, SLOT_WRITE };
+
+struct slot {
+    uint8_t* buf;
+    enum slot_state state;
+    uint64_t segment;
+    uint64_t offset; // File offset of the current operation's first byte
+    size_t want;     // Bytes of the current operation
+    size_t done;
+};
+
+struct pipeline {
+    struct uring ring;
+    const struct AES_ctx* ctx;
+    struct AES_seg_params params;
+    uint8_t header[AES_SEG_HEADER_LEN];
+    int sealing;
+    int in_fd, out_fd;
+    int fixed; // Buffers are registered: use READ_FIXED/WRITE_FIXED
+    struct slot* slots;
+    unsigned depth;
+    uint64_t next_segment, segments, completed;
+    unsigned in_flight;
+};
+
+static void slot_issue(struct pipeline* pl, unsigned i) {
+    struct slot* s = &pl->slots[i];
+    size_t left = s->want - s->done;
+    unsigned len = left < URING_MAX_IO ? (unsigned)left : URING_MAX_IO;
+    uint8_t opcode;
+    int fd;
+
+    if (s->state == SLOT_READ) {
+        opcode = pl->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        fd = pl->in_fd;
+    } else {
+        opcode = pl->fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        fd = pl->out_fd;
+    }
+    uring_queue(&pl->ring, opcode, fd, s->buf + s->done, len, s->offset + s->done, pl->fixed ? (int)i : -1, i);
+    pl->in_flight++;
+}
+
+static int slot_crypt(struct pipeline* pl, unsigned i);
+
+// Starts reading the next segment into slot i, or idles it when there is none.
+static int slot_start(struct pipeline* pl, unsigned i) {
+    struct slot* s = &pl->slots[i];
+    if (pl->next_segment == pl->segments) {
+        s->state = SLOT_IDLE;
+        return 0;
+    }
+    s->segment = pl->next_segment++;
+    s->state = SLOT_READ;
+    s->done = 0;
+    s->want = AES_seg_plain_len(&pl->params, s->segment);
+    if (pl->sealing) {
+        s->offset = s->segment * pl->params.segment_size;
+    } else {
+        s->offset = AES_seg_offset(&pl->params, s->segment);
+        s->want += AES_GCM_TAG_LEN;
+    }
+    if (s->want == 0) {
+        return slot_crypt(pl, i); // The empty segment of an empty object: nothing to read
+    }
+    slot_issue(pl, i);
+    return 0;
+}
+
+// Runs the cipher on a fully read slot and queues its write.
+static int slot_crypt(struct pipeline* pl, unsigned i) {
+    struct slot* s = &pl->slots[i];
+    size_t n = AES_seg_plain_len(&pl->params, s->segment);
+    int ret;
+
+    if (pl->sealing) {
+        ret = AES_seg_seal(pl->ctx, pl->header, s->segment, s->buf, n, s->buf);
+        s->offset = AES_seg_offset(&pl->params, s->segment);
+        s->want = n + AES_GCM_TAG_LEN;
+    } else {
+        ret = AES_seg_open(pl->ctx, pl->header, s->segment, s->buf, n + AES_GCM_TAG_LEN, s->buf);
+        s->offset = s->segment * pl->params.segment_size;
+        s->want = n;
+    }
+    if (ret != 0) {
+        return ret;
+    }
+    s->state = SLOT_WRITE;
+    s->done = 0;
+    if (s->want == 0) { // Opened an empty object: nothing to write
+        pl->completed++;
+        return slot_start(pl, i);
+    }
+    slot_issue(pl, i);
+    return 0;
+}
+
+// Handles one completion for slot i with result res (bytes or -errno).
+static int slot_complete(struct pipeline* pl, unsigned i, int res) {
+    struct slot* s = &pl->slots[i];
+    pl->in_flight--;
+    if (res == -EINTR || res == -EAGAIN) {
+        slot_issue(pl, i); // Retry the same operation
+        return 0;
+    }
+    if (res < 0) {
+        errno = -res;
+        return -1;
+    }
+    if (res == 0 && s->done < s->want) {
+        errno = s->state == SLOT_READ ? EIO : ENOSPC; // Input shorter than expected, or no progress writing
+        return -1;
+    }
+    s->done += (size_t)res;
+    if (s->done < s->want) {
+        slot_issue(pl, i); // Short read or write: continue where it stopped
+        return 0;
+    }
+    if (s->state == SLOT_READ) {
+        return slot_crypt(pl, i);
+    }
+    pl->completed++;
+    return slot_start(pl, i);
+}
+
+static int pipeline_run(struct pipeline* pl, unsigned depth) {
+    size_t buf_len = (size_t)pl->params.segment_size + AES_GCM_TAG_LEN;
+    struct iovec* iovs = NULL;
+    uint8_t* bufs = MAP_FAILED;
+    int ret;
+
+    pl->segments = AES_seg_count(&pl->params);
+    if (depth == 0) {
+        depth = AES_SEG_URING_DEFAULT_DEPTH;
+    }
+    if (depth > pl->segments) {
+        depth = (unsigned)pl->segments;
+    }
+    if (depth > 4096 || buf_len > SIZE_MAX / depth) {
+        errno = EINVAL;
+        return -1;
+    }
+    pl->depth = depth;
+    if ((ret = uring_init(&pl->ring, depth)) != 0) {
+        uring_exit(&pl->ring);
+        return ret;
+    }
+
+    pl->slots = (struct slot*)calloc(depth, sizeof(struct slot));
+    iovs = (struct iovec*)calloc(depth, sizeof(struct iovec));
+    bufs = (uint8_t*)mmap(NULL, buf_len * depth, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pl->slots == NULL || iovs == NULL || bufs == MAP_FAILED) {
+        ret = -1;
+        goto done;
+    }
+    for (unsigned i = 0; i < depth; ++i) {
+        pl->slots[i].buf = bufs + i * buf_len;
+        iovs[i].iov_base = pl->slots[i].buf;
+        iovs[i].iov_len = buf_len;
+    }
+    pl->fixed = buf_len <= URING_MAX_IO &&
+                syscall(__NR_io_uring_register, pl->ring.fd, IORING_REGISTER_BUFFERS, iovs, depth) == 0;
+
+    ret = 0;
+    for (unsigned i = 0; i < depth && ret == 0; ++i) {
+        ret = slot_start(pl, i);
+    }
+    while (pl->in_flight > 0) {
+        if (uring_submit_and_wait(&pl->ring) != 0) {
+            ret = -1;
+            break; // The ring is unusable; in-flight operations die with it
+        }
+        unsigned head = *pl->ring.cq_head;
+        unsigned tail = __atomic_load_n(pl->ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const struct io_uring_cqe* cqe = &pl->ring.cqes[head & *pl->ring.cq_mask];
+            unsigned i = (unsigned)cqe->user_data;
+            if (ret != 0) {
+                pl->in_flight--; // Draining after a failure
+                continue;
+            }
+            ret = slot_complete(pl, i, cqe->res);
+            if (ret != 0) {
+                pl->next_segment = pl->segments; // Start nothing new
+            }
+        }
+        __atomic_store_n(pl->ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+    if (ret == 0 && pl->completed != pl->segments) {
+        errno = EIO;
+        ret = -1;
+    }
+
+done:
+    uring_exit(&pl->ring); // Also unregisters the buffers
+    if (bufs != MAP_FAILED) {
+        memset(bufs, 0, buf_len * depth);
+        munmap(bufs, buf_len * depth);
+    }
+    free(iovs);
+    free(pl->slots);
+    return ret;
+}
+
+int AES_seg_uring_seal(const struct AES_ctx* ctx, const struct AES_seg_params* params, int in_fd, int out_fd,
+                       unsigned depth)
+{
+    struct pipeline pl;
+    memset(&pl, 0, sizeof(pl));
+    if (ctx == NULL || params == NULL || AES_seg_header_write(params, pl.header) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (pwrite(out_fd, pl.header, sizeof(pl.header), 0) != (ssize_t)sizeof(pl.header)) {
+        return -1;
+    }
+    pl.ctx = ctx;
+    pl.params = *params;
+    pl.sealing = 1;
+    pl.in_fd = in_fd;
+    pl.out_fd = out_fd;
+    return pipeline_run(&pl, depth);
+}
+
+int AES_seg_uring_open(const struct AES_ctx* ctx, int in_fd, int out_fd, unsigned depth)
+{
+    struct pipeline pl;
+    struct stat st;
+    memset(&pl, 0, sizeof(pl));
+    if (ctx == NULL || fstat(in_fd, &st) != 0 ||
+        pread(in_fd, pl.header, sizeof(pl.header), 0) != (ssize_t)sizeof(pl.header) ||
+        AES_seg_header_read(pl.header, &pl.params) != 0 || (uint64_t)st.st_size != AES_seg_sealed_len(&pl.params)) {
+        errno = EINVAL;
+        return -1; // Not a sealed file, or truncated
+    }
+    pl.ctx = ctx;
+    pl.sealing = 0;
+    pl.in_fd = in_fd;
+    pl.out_fd = out_fd;
+    return pipeline_run(&pl, depth);
+}
+
+#else // No io_uring on this platform
+
+int AES_seg_uring_seal(const struct AES_ctx* ctx, const struct AES_seg_params* params, int in_fd, int out_fd,
+                       unsigned depth)
+{
+    (void)ctx; (void)params; (void)in_fd; (void)out_fd; (void)depth;
+    errno = ENOSYS;
+    return -2;
+}
+
+int AES_seg_uring_open(const struct AES_ctx* ctx, int in_fd, int out_fd, unsigned depth)
+{
+    (void)ctx; (void)in_fd; (void)out_fd; (void)depth;
+    errno = ENOSYS;
+    return -2;
+}
+
+#endif // AES_SEG_URING
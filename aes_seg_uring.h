@@ -0,0 +1,60 @@
+#ifndef _AES_SEG_URING_H_
+#define _AES_SEG_URING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aes_seg.h"
+
+// --- io_uring segment pipeline (Linux) ---
+//
+// Seals or opens a file in the aes_seg.h format with reads and writes queued on
+// an io_uring (raw syscalls, no liburing). depth segment buffers are registered
+// with the ring once; each segment is read into its buffer, sealed or opened in
+// place, and written from the same buffer, so the data is never copied in user
+// space. While the calling thread runs the cipher on one segment, up to
+// depth - 1 other reads and writes are in flight in the kernel.
+//
+// If the kernel refuses to register the buffers (e.g. RLIMIT_MEMLOCK on old
+// kernels) the pipeline uses unregistered reads and writes instead. On other
+// platforms, or where io_uring is disabled, the functions return -2 so the
+// caller can fall back to a read/seal/write loop.
+
+#define AES_SEG_URING_DEFAULT_DEPTH 16
+
+/**
+ * @brief Seals the file in_fd into out_fd.
+ *
+ * @param ctx       Context initialised with a key of params->key_len bytes.
+ * @param params    Format parameters; plaintext_len is the number of bytes read
+ *                  from in_fd (from offset 0) and nonce_base must be fresh.
+ * @param in_fd     Plaintext input, readable with positional reads.
+ * @param out_fd    Output, written from offset 0 (AES_seg_sealed_len bytes).
+ * @param depth     Segments in flight (0: AES_SEG_URING_DEFAULT_DEPTH).
+ * @return int      0 on success, -1 on invalid arguments or an I/O error (errno
+ *                  is set), -2 if io_uring is not available.
+ */
+int AES_seg_uring_seal(const struct AES_ctx* ctx, const struct AES_seg_params* params, int in_fd, int out_fd,
+                       unsigned depth);
+
+/**
+ * @brief Authenticates and decrypts the sealed file in_fd into out_fd.
+ *
+ * Segments are written as soon as they are authenticated, so after a failure
+ * out_fd holds a partial plaintext and should be discarded.
+ *
+ * @return int      0 on success, -1 on invalid arguments, a malformed or
+ *                  truncated file or an I/O error, -2 if io_uring is not
+ *                  available, -3 if a segment failed authentication.
+ */
+int AES_seg_uring_open(const struct AES_ctx* ctx, int in_fd, int out_fd, unsigned depth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AES_SEG_URING_H_
@@ -2,10 +2,18 @@ package aesgcm
 
 /*
 #cgo CFLAGS: -Wall -Werror
-// Specific AES key size flags are set by build tags (defined in cflags_*.go files)
+// All key sizes are compiled in; the C library picks the round-count-specialised
+// kernels at runtime from the key length passed to AES_init_ctx_keylen.
 // We assume aes.c and aes.h are in the same directory or accessible via include paths
-#include <stdlib.h> // For C.free
 #include "aes.h"
+
+// Empty function for measuring the cost of a cgo call (see cgoNoop).
+// Takes an argument because cgo's generated wrapper for a parameterless
+// function trips -Werror=unused-variable.
+static inline int aesgcm_noop(int x) { return x; }
+
+// AES_ctx_alloc takes no arguments; wrapped for the same reason.
+static inline struct AES_ctx* aesgcm_ctx_alloc(int unused) { (void)unused; return AES_ctx_alloc(); }
 */
 import "C" // Enables Cgo
 import (
@@ -16,65 +24,92 @@ import (
 
 // Define constants matching C header (or derive if needed)
 const (
-	// KeySize is determined at compile time by build tags (see CompiledKeySize func)
-	// KeySize   = 32 // AES-256 key size in bytes (Matches CFLAGS -DAES256=1)
 	TagSize   = C.AES_GCM_TAG_LEN
 	BlockSize = C.AES_BLOCKLEN
 )
 
+// Key sizes in bytes accepted by NewContext. All of them are available in the
+// same binary; no build tags are needed.
+const (
+	KeySize128 = 16
+	KeySize192 = 24
+	KeySize256 = 32
+	KeySize512 = 64 // Non-standard AES-512 (22 rounds)
+)
+
 // Go errors
 var (
-	ErrInvalidKeySize   = errors.New("aesgcm: invalid key size for compiled version") // Modified error message
+	ErrInvalidKeySize   = errors.New("aesgcm: invalid key size (must be 16, 24, 32 or 64 bytes)")
 	ErrAuthFailed       = errors.New("aesgcm: authentication failed (tag mismatch)")
 	ErrEncrypt          = errors.New("aesgcm: encryption error from C library")
 	ErrDecrypt          = errors.New("aesgcm: decryption error from C library (other than auth fail)")
 	ErrInvalidArguments = errors.New("aesgcm: invalid arguments provided")
+	ErrInvalidTagSize   = errors.New("aesgcm: invalid tag size (must be 16, 15, 14, 13, 12, 8 or 4 bytes)")
 )
 
+// validTagSize reports whether n is a tag length allowed by SP 800-38D.
+func validTagSize(n int) bool {
+	switch n {
+	case 16, 15, 14, 13, 12, 8, 4:
+		return true
+	}
+	return false
+}
+
 // Context wraps the C AES context.
 type Context struct {
-	cCtx *C.struct_AES_ctx
+	cCtx   *C.struct_AES_ctx
+	keyLen int
 }
 
-/*
-// CompiledKeySize returns the key size in bytes (16, 24, 32, or 64)
-// that this package was compiled to support, based on build tags.
-// The actual implementation resides in tag-specific files (e.g., cflags_128.go).
-func CompiledKeySize() int
-*/
+// CompiledKeySize returns 32, the key size of the former default (AES-256) build.
+//
+// Deprecated: key sizes are no longer selected with build tags. NewContext
+// accepts 16, 24, 32 and 64-byte keys in the same binary.
+func CompiledKeySize() int {
+	return KeySize256
+}
+
+// validKeySize reports whether n is one of the supported key sizes in bytes.
+func validKeySize(n int) bool {
+	switch n {
+	case KeySize128, KeySize192, KeySize256, KeySize512:
+		return true
+	}
+	return false
+}
 
 // NewContext initializes a new AES-GCM context with the given key.
-// The key length must match the size the package was compiled for
-// (e.g., 32 bytes if compiled with -tags aes256, or by default).
+// The key length selects the variant: 16, 24, 32 or 64 bytes for AES-128,
+// AES-192, AES-256 or the non-standard AES-512.
 func NewContext(key []byte) (*Context, error) {
-	expectedKeySize := CompiledKeySize() // Get size based on build tag
-	if len(key) != expectedKeySize {
+	if !validKeySize(len(key)) {
 		return nil, ErrInvalidKeySize
 	}
 
-	// Allocate C context struct on the C heap
-	// C.malloc returns unsafe.Pointer, which needs casting.
-	cCtxPtr := C.malloc(C.sizeof_struct_AES_ctx)
-	if cCtxPtr == nil {
-		// Should not happen often, but check C malloc failure
-		panic("C.malloc failed to allocate AES_ctx")
+	// Allocate the C context on the C heap, aligned as the kernels expect
+	// (C.malloc does not honour struct AES_ctx's cache-line alignment)
+	cCtx := C.aesgcm_ctx_alloc(0)
+	if cCtx == nil {
+		// Should not happen often, but check C allocation failure
+		panic("AES_ctx_alloc failed to allocate AES_ctx")
 	}
-	cCtx := (*C.struct_AES_ctx)(cCtxPtr)
 
 	// Get a C pointer to the key slice's underlying data.
-	// This is safe because AES_init_ctx/KeyExpansion reads the key immediately
+	// This is safe because AES_init_ctx_keylen/KeyExpansion reads the key immediately
 	// and doesn't store the pointer itself long-term.
-	// Check for empty key slice, although length check above should prevent this.
-	var keyPtr *C.uint8_t
-	if len(key) > 0 {
-		keyPtr = (*C.uint8_t)(unsafe.Pointer(&key[0]))
-	} // else keyPtr remains nil, but AES_init_ctx probably doesn't handle that nicely.
+	// The length check above guarantees the key slice is non-empty.
+	keyPtr := (*C.uint8_t)(unsafe.Pointer(&key[0]))
 
-	// Call the C initialization function
-	C.AES_init_ctx(cCtx, keyPtr)
+	// Call the C initialization function; it picks the kernels for this key size
+	if C.AES_init_ctx_keylen(cCtx, keyPtr, C.size_t(len(key))) != 0 {
+		// Key size not compiled into the C library
+		C.AES_ctx_free(cCtx)
+		return nil, ErrInvalidKeySize
+	}
 
 	// Create the Go wrapper struct
-	goCtx := &Context{cCtx: cCtx}
+	goCtx := &Context{cCtx: cCtx, keyLen: len(key)}
 
 	// Set a finalizer to free the C memory when the Go object is garbage collected.
 	runtime.SetFinalizer(goCtx, freeContext)
@@ -82,10 +117,15 @@ func NewContext(key []byte) (*Context, error) {
 	return goCtx, nil
 }
 
+// KeySize returns the length in bytes of the key the context was created with.
+func (ctx *Context) KeySize() int {
+	return ctx.keyLen
+}
+
 // freeContext is called by the Go runtime garbage collector.
 func freeContext(ctx *Context) {
 	if ctx.cCtx != nil {
-		C.free(unsafe.Pointer(ctx.cCtx))
+		C.AES_ctx_free(ctx.cCtx) // Wipes the key schedule before freeing
 		ctx.cCtx = nil // Prevent double free
 	}
 }
@@ -96,16 +136,25 @@ func freeContext(ctx *Context) {
 // plaintext: The data to encrypt.
 // Returns ciphertext and authentication tag, or an error.
 func (ctx *Context) Encrypt(iv, aad, plaintext []byte) (ciphertext []byte, tag []byte, err error) {
+	// Allocate output buffers in Go
+	ciphertext = make([]byte, len(plaintext))
+	tag = make([]byte, TagSize)
+	if err := ctx.encryptInto(iv, aad, plaintext, ciphertext, tag); err != nil {
+		return nil, nil, err
+	}
+	return ciphertext, tag, nil
+}
+
+// encryptInto is Encrypt writing into caller-provided buffers: ciphertext must
+// be len(plaintext) bytes, and the tag is truncated to len(tag) bytes (TagSize
+// for a full tag). It does not allocate.
+func (ctx *Context) encryptInto(iv, aad, plaintext, ciphertext, tag []byte) error {
 	if ctx == nil || ctx.cCtx == nil {
-		return nil, nil, errors.New("aesgcm: context is nil")
+		return errors.New("aesgcm: context is nil")
 	}
 	// Note: C library checks for pt=NULL if pt_len>0, aad=NULL if aad_len>0, etc.
 	// We might add Go-level checks too if desired.
 
-	// Allocate output buffers in Go
-	ciphertext = make([]byte, len(plaintext))
-	tag = make([]byte, TagSize)
-
 	// Get C pointers to Go slice data. Handle empty slices gracefully by passing NULL.
 	var ivPtr *C.uint8_t
 	if len(iv) > 0 {
@@ -131,18 +180,18 @@ func (ctx *Context) Encrypt(iv, aad, plaintext []byte) (ciphertext []byte, tag [
 	ptLenC := C.size_t(len(plaintext))
 
 	// Call the C encryption function
-	ret := C.AES_GCM_encrypt(ctx.cCtx, ivPtr, ivLenC, aadPtr, aadLenC, ptPtr, ctPtr, ptLenC, tagPtr)
+	ret := C.AES_GCM_encrypt_taglen(ctx.cCtx, ivPtr, ivLenC, aadPtr, aadLenC, ptPtr, ctPtr, ptLenC, tagPtr, C.size_t(len(tag)))
+	runtime.KeepAlive(ctx) // The finalizer must not free cCtx while C is using it
 
 	if ret != 0 {
 		// Map C errors to Go errors
 		if ret == -1 {
-			return nil, nil, ErrInvalidArguments // Or be more specific if C provides more codes
+			return ErrInvalidArguments // Or be more specific if C provides more codes
 		}
 		// Add other error code mappings if C lib returns more specific errors
-		return nil, nil, ErrEncrypt
+		return ErrEncrypt
 	}
-
-	return ciphertext, tag, nil
+	return nil
 }
 
 // Decrypt performs AES-GCM authenticated decryption.
@@ -151,16 +200,59 @@ func (ctx *Context) Encrypt(iv, aad, plaintext []byte) (ciphertext []byte, tag [
 // tag: The authentication tag received alongside the ciphertext. Must be TagSize bytes.
 // Returns the original plaintext, or an error if decryption or authentication fails.
 func (ctx *Context) Decrypt(iv, aad, ciphertext, tag []byte) (plaintext []byte, err error) {
-	if ctx == nil || ctx.cCtx == nil {
-		return nil, errors.New("aesgcm: context is nil")
-	}
 	if len(tag) != TagSize {
 		return nil, errors.New("aesgcm: invalid tag size")
 	}
-	// Note: C library checks for ct=NULL if ct_len>0, aad=NULL if aad_len>0, etc.
-
 	// Allocate output buffer in Go
 	plaintext = make([]byte, len(ciphertext))
+	if err := ctx.decryptInto(iv, aad, ciphertext, tag, plaintext); err != nil {
+		return nil, err
+	}
+	return plaintext, nil
+}
+
+// EncryptTagSize is Encrypt with the tag truncated to tagSize bytes: 16, 15,
+// 14, 13 or 12, or 8 or 4 where the protocol bounds message lengths and failed
+// decryptions per key (SP 800-38D Appendix C). A shorter tag is easier to
+// forge; every message under a key should use the same size.
+func (ctx *Context) EncryptTagSize(iv, aad, plaintext []byte, tagSize int) (ciphertext, tag []byte, err error) {
+	if !validTagSize(tagSize) {
+		return nil, nil, ErrInvalidTagSize
+	}
+	ciphertext = make([]byte, len(plaintext))
+	tag = make([]byte, tagSize)
+	if err := ctx.encryptInto(iv, aad, plaintext, ciphertext, tag); err != nil {
+		return nil, nil, err
+	}
+	return ciphertext, tag, nil
+}
+
+// DecryptTagSize is Decrypt for a tag truncated to tagSize bytes. tagSize is
+// the protocol's, not inferred from the received tag, which must have exactly
+// that length: accepting whatever length arrives would let an attacker choose
+// the shortest.
+func (ctx *Context) DecryptTagSize(iv, aad, ciphertext, tag []byte, tagSize int) (plaintext []byte, err error) {
+	if !validTagSize(tagSize) || len(tag) != tagSize {
+		return nil, ErrInvalidTagSize
+	}
+	plaintext = make([]byte, len(ciphertext))
+	if err := ctx.decryptInto(iv, aad, ciphertext, tag, plaintext); err != nil {
+		return nil, err
+	}
+	return plaintext, nil
+}
+
+// decryptInto is Decrypt writing into a caller-provided plaintext buffer of
+// len(ciphertext) bytes, checking a tag of len(tag) bytes; callers fix that
+// length. It does not allocate.
+func (ctx *Context) decryptInto(iv, aad, ciphertext, tag, plaintext []byte) error {
+	if ctx == nil || ctx.cCtx == nil {
+		return errors.New("aesgcm: context is nil")
+	}
+	if !validTagSize(len(tag)) {
+		return ErrInvalidTagSize
+	}
+	// Note: C library checks for ct=NULL if ct_len>0, aad=NULL if aad_len>0, etc.
 
 	// Get C pointers, handling empty slices.
 	var ivPtr *C.uint8_t
@@ -187,19 +279,25 @@ func (ctx *Context) Decrypt(iv, aad, ciphertext, tag []byte) (plaintext []byte,
 	ctLenC := C.size_t(len(ciphertext))
 
 	// Call the C decryption function
-	ret := C.AES_GCM_decrypt(ctx.cCtx, ivPtr, ivLenC, aadPtr, aadLenC, ctPtr, ptPtr, ctLenC, tagPtr)
+	ret := C.AES_GCM_decrypt_taglen(ctx.cCtx, ivPtr, ivLenC, aadPtr, aadLenC, ctPtr, ptPtr, ctLenC, tagPtr, C.size_t(len(tag)))
+	runtime.KeepAlive(ctx) // The finalizer must not free cCtx while C is using it
 
 	if ret != 0 {
 		// Map C errors to Go errors
 		if ret == -3 {
-			return nil, ErrAuthFailed
+			return ErrAuthFailed
 		}
 		if ret == -1 {
-			return nil, ErrInvalidArguments
+			return ErrInvalidArguments
 		}
 		// Add other error code mappings if C lib returns more specific errors
-		return nil, ErrDecrypt
+		return ErrDecrypt
 	}
+	return nil
+}
 
-	return plaintext, nil
+// cgoNoop makes an empty cgo call. Benchmarks use it to separate the fixed
+// cost of crossing into C from the work done by the library.
+func cgoNoop() {
+	C.aesgcm_noop(0)
 }
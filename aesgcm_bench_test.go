@@ -0,0 +1,312 @@
+package aesgcm
+
+import (
+	"crypto/aes"
+	"crypto/cipher"
+	"fmt"
+	"sync/atomic"
+	"testing"
+)
+
+// benchSizes spans the regimes where different costs dominate: at 64 bytes the
+// cgo transition and allocations, at 1 MiB the cipher itself.
+var benchSizes = []int{64, 1024, 16 * 1024, 1 << 20}
+
+func sizeName(n int) string {
+	switch {
+	case n >= 1<<20:
+		return fmt.Sprintf("%dMiB", n>>20)
+	case n >= 1<<10:
+		return fmt.Sprintf("%dKiB", n>>10)
+	}
+	return fmt.Sprintf("%dB", n)
+}
+
+// benchMatrix runs fn for every key size and message size as
+// "AES-<bits>/<size>" sub-benchmarks, with allocation reporting enabled.
+func benchMatrix(b *testing.B, keySizes []int, fn func(b *testing.B, key []byte, size int)) {
+	for _, keySize := range keySizes {
+		for _, size := range benchSizes {
+			b.Run(fmt.Sprintf("AES-%d/%s", keySize*8, sizeName(size)), func(b *testing.B) {
+				key := make([]byte, keySize)
+				for i := range key {
+					key[i] = byte(i)
+				}
+				b.ReportAllocs()
+				b.SetBytes(int64(size))
+				fn(b, key, size)
+			})
+		}
+	}
+}
+
+func newBenchContext(b *testing.B, key []byte) *Context {
+	ctx, err := NewContext(key)
+	if err != nil {
+		b.Fatalf("NewContext failed: %v", err)
+	}
+	return ctx
+}
+
+// BenchmarkEncrypt measures the public Encrypt API, including the ciphertext
+// and tag allocations it makes per call.
+func BenchmarkEncrypt(b *testing.B) {
+	benchMatrix(b, allKeySizes, func(b *testing.B, key []byte, size int) {
+		ctx := newBenchContext(b, key)
+		iv := make([]byte, 12)
+		plaintext := make([]byte, size)
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			if _, _, err := ctx.Encrypt(iv, nil, plaintext); err != nil {
+				b.Fatalf("Encrypt failed: %v", err)
+			}
+		}
+	})
+}
+
+// BenchmarkDecrypt is the Decrypt counterpart of BenchmarkEncrypt.
+func BenchmarkDecrypt(b *testing.B) {
+	benchMatrix(b, allKeySizes, func(b *testing.B, key []byte, size int) {
+		ctx := newBenchContext(b, key)
+		iv := make([]byte, 12)
+		ciphertext, tag, err := ctx.Encrypt(iv, nil, make([]byte, size))
+		if err != nil {
+			b.Fatalf("Encrypt failed: %v", err)
+		}
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			if _, err := ctx.Decrypt(iv, nil, ciphertext, tag); err != nil {
+				b.Fatalf("Decrypt failed: %v", err)
+			}
+		}
+	})
+}
+
+// BenchmarkEncryptNoAlloc is BenchmarkEncrypt with caller-owned output
+// buffers. The difference between the two is the allocation overhead.
+func BenchmarkEncryptNoAlloc(b *testing.B) {
+	benchMatrix(b, allKeySizes, func(b *testing.B, key []byte, size int) {
+		ctx := newBenchContext(b, key)
+		iv := make([]byte, 12)
+		plaintext := make([]byte, size)
+		ciphertext := make([]byte, size)
+		tag := make([]byte, TagSize)
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			if err := ctx.encryptInto(iv, nil, plaintext, ciphertext, tag); err != nil {
+				b.Fatalf("encryptInto failed: %v", err)
+			}
+		}
+	})
+}
+
+// BenchmarkDecryptNoAlloc is the Decrypt counterpart of BenchmarkEncryptNoAlloc.
+func BenchmarkDecryptNoAlloc(b *testing.B) {
+	benchMatrix(b, allKeySizes, func(b *testing.B, key []byte, size int) {
+		ctx := newBenchContext(b, key)
+		iv := make([]byte, 12)
+		ciphertext, tag, err := ctx.Encrypt(iv, nil, make([]byte, size))
+		if err != nil {
+			b.Fatalf("Encrypt failed: %v", err)
+		}
+		plaintext := make([]byte, size)
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			if err := ctx.decryptInto(iv, nil, ciphertext, tag, plaintext); err != nil {
+				b.Fatalf("decryptInto failed: %v", err)
+			}
+		}
+	})
+}
+
+// BenchmarkCgoCall measures an empty call into C: the fixed per-call cost
+// that every Encrypt/Decrypt pays on top of the cipher work.
+func BenchmarkCgoCall(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		cgoNoop()
+	}
+}
+
+// BenchmarkStdlibEncrypt is the crypto/aes + cipher.NewGCM baseline for
+// BenchmarkEncryptNoAlloc (AES-512 has no stdlib equivalent). Seal appends to
+// a reused buffer, so it does not allocate either.
+func BenchmarkStdlibEncrypt(b *testing.B) {
+	benchMatrix(b, []int{KeySize128, KeySize192, KeySize256}, func(b *testing.B, key []byte, size int) {
+		aead := newStdlibGCM(b, key)
+		nonce := make([]byte, aead.NonceSize())
+		plaintext := make([]byte, size)
+		dst := make([]byte, 0, size+aead.Overhead())
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			dst = aead.Seal(dst[:0], nonce, plaintext, nil)
+		}
+	})
+}
+
+// BenchmarkStdlibDecrypt is the crypto/aes + cipher.NewGCM baseline for
+// BenchmarkDecryptNoAlloc.
+func BenchmarkStdlibDecrypt(b *testing.B) {
+	benchMatrix(b, []int{KeySize128, KeySize192, KeySize256}, func(b *testing.B, key []byte, size int) {
+		aead := newStdlibGCM(b, key)
+		nonce := make([]byte, aead.NonceSize())
+		sealed := aead.Seal(nil, nonce, make([]byte, size), nil)
+		dst := make([]byte, 0, size)
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			var err error
+			if dst, err = aead.Open(dst[:0], nonce, sealed, nil); err != nil {
+				b.Fatalf("Open failed: %v", err)
+			}
+		}
+	})
+}
+
+func newStdlibGCM(b *testing.B, key []byte) cipher.AEAD {
+	block, err := aes.NewCipher(key)
+	if err != nil {
+		b.Fatalf("aes.NewCipher failed: %v", err)
+	}
+	aead, err := cipher.NewGCM(block)
+	if err != nil {
+		b.Fatalf("cipher.NewGCM failed: %v", err)
+	}
+	return aead
+}
+
+// BenchmarkEncryptRunParallel runs Encrypt from GOMAXPROCS goroutines sharing
+// one Context, next to the stdlib doing the same, to show how cgo calls
+// scale under contention.
+func BenchmarkEncryptRunParallel(b *testing.B) {
+	for _, size := range []int{1024, 16 * 1024} {
+		key := make([]byte, KeySize256)
+		b.Run("AES-256/"+sizeName(size), func(b *testing.B) {
+			ctx := newBenchContext(b, key)
+			plaintext := make([]byte, size)
+			b.ReportAllocs()
+			b.SetBytes(int64(size))
+			b.RunParallel(func(pb *testing.PB) {
+				iv := make([]byte, 12)
+				ciphertext := make([]byte, size)
+				tag := make([]byte, TagSize)
+				for pb.Next() {
+					if err := ctx.encryptInto(iv, nil, plaintext, ciphertext, tag); err != nil {
+						b.Errorf("encryptInto failed: %v", err)
+						return
+					}
+				}
+			})
+		})
+		b.Run("Stdlib-256/"+sizeName(size), func(b *testing.B) {
+			aead := newStdlibGCM(b, key)
+			plaintext := make([]byte, size)
+			b.ReportAllocs()
+			b.SetBytes(int64(size))
+			b.RunParallel(func(pb *testing.PB) {
+				nonce := make([]byte, aead.NonceSize())
+				dst := make([]byte, 0, size+aead.Overhead())
+				for pb.Next() {
+					dst = aead.Seal(dst[:0], nonce, plaintext, nil)
+				}
+			})
+		})
+	}
+}
+
+// BenchmarkNonce compares IV generation from GOMAXPROCS goroutines with one
+// shared atomic counter (a write to the same cache line per message) against
+// per-goroutine NonceLeases (one shared write per block).
+func BenchmarkNonce(b *testing.B) {
+	ctx := newBenchContext(b, make([]byte, KeySize256))
+	b.Run("SharedCounter", func(b *testing.B) {
+		var counter atomic.Uint64
+		b.RunParallel(func(pb *testing.PB) {
+			iv := make([]byte, 12)
+			for pb.Next() {
+				n := counter.Add(1)
+				iv[11], iv[10], iv[9], iv[8] = byte(n), byte(n>>8), byte(n>>16), byte(n>>24)
+			}
+		})
+	})
+	b.Run("Lease", func(b *testing.B) {
+		src, err := ctx.NewNonceSource([]byte{0, 0, 0, 1}, ^uint64(0))
+		if err != nil {
+			b.Fatalf("NewNonceSource failed: %v", err)
+		}
+		b.RunParallel(func(pb *testing.PB) {
+			lease := src.Lease(0)
+			iv := make([]byte, 12)
+			for pb.Next() {
+				if err := lease.Next(iv); err != nil {
+					b.Errorf("Next failed: %v", err)
+					return
+				}
+			}
+		})
+	})
+}
+
+// BenchmarkKeyCache compares the per-request cost of obtaining a ready context
+// for a tenant: NewContext (key expansion and H on every call) against a
+// KeyCache hit (Get and Release) for one of 1024 cached AES-128 tenant keys.
+func BenchmarkKeyCache(b *testing.B) {
+	const tenants = 1024
+	b.Run("NewContext", func(b *testing.B) {
+		key := tenantKey(0)
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			key[0] = byte(i)
+			if _, err := NewContext(key); err != nil {
+				b.Fatalf("NewContext failed: %v", err)
+			}
+		}
+	})
+	b.Run("Hit", func(b *testing.B) {
+		kc, err := NewKeyCache(2*tenants, 0) // Headroom: shards fill unevenly
+		if err != nil {
+			b.Fatalf("NewKeyCache failed: %v", err)
+		}
+		defer kc.Close()
+		load := func(id uint64) ([]byte, error) { return tenantKey(id), nil }
+		for id := uint64(0); id < tenants; id++ {
+			cc, _ := kc.Get(id, load)
+			cc.Release()
+		}
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			cc, err := kc.Get(uint64(i%tenants), load)
+			if err != nil {
+				b.Fatalf("Get failed: %v", err)
+			}
+			cc.Release()
+		}
+	})
+}
+
+// BenchmarkEncryptParallel compares Encrypt with EncryptParallel on a large
+// object; the parallel variant should scale with GOMAXPROCS.
+func BenchmarkEncryptParallel(b *testing.B) {
+	ctx, err := NewContext(make([]byte, KeySize256))
+	if err != nil {
+		b.Fatalf("NewContext failed: %v", err)
+	}
+	iv := make([]byte, 12)
+	plaintext := make([]byte, 8<<20)
+	b.Run("Serial", func(b *testing.B) {
+		b.SetBytes(int64(len(plaintext)))
+		for i := 0; i < b.N; i++ {
+			if _, _, err := ctx.Encrypt(iv, nil, plaintext); err != nil {
+				b.Fatalf("Encrypt failed: %v", err)
+			}
+		}
+	})
+	b.Run("Parallel", func(b *testing.B) {
+		b.SetBytes(int64(len(plaintext)))
+		for i := 0; i < b.N; i++ {
+			if _, _, err := ctx.EncryptParallel(iv, nil, plaintext); err != nil {
+				b.Fatalf("EncryptParallel failed: %v", err)
+			}
+		}
+	})
+}
@@ -0,0 +1,32 @@
+package aesgcm
+
+/*
+#cgo CFLAGS: -Wall -Werror
+#include "aes.h"
+*/
+import "C"
+import (
+	"runtime"
+	"unsafe"
+)
+
+// EncryptBlocks encrypts src, a whole number of 16-byte blocks, into dst one
+// block at a time (ECB), as crypto/cipher.Block.Encrypt would per block but
+// with several blocks in flight. It is a primitive for key wrapping,
+// tokenisation or PRF constructions, not a mode for messages. dst and src must
+// be the same length and either the same slice or not overlap.
+func (ctx *Context) EncryptBlocks(dst, src []byte) error {
+	if ctx == nil || ctx.cCtx == nil || len(dst) != len(src) || len(src)%BlockSize != 0 {
+		return ErrInvalidArguments
+	}
+	if len(src) == 0 {
+		return nil
+	}
+	ret := C.AES_encrypt_blocks(ctx.cCtx, (*C.uint8_t)(unsafe.Pointer(&src[0])),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])), C.size_t(len(src)/BlockSize))
+	runtime.KeepAlive(ctx)
+	if ret != 0 {
+		return ErrInvalidArguments
+	}
+	return nil
+}
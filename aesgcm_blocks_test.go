@@ -0,0 +1,43 @@
+package aesgcm
+
+import (
+	"bytes"
+	"crypto/aes"
+	"fmt"
+	"testing"
+)
+
+// TestEncryptBlocks compares EncryptBlocks with crypto/aes block by block.
+func TestEncryptBlocks(t *testing.T) {
+	for _, keySize := range []int{KeySize128, KeySize192, KeySize256} {
+		t.Run(fmt.Sprintf("AES-%d", keySize*8), func(t *testing.T) {
+			key := make([]byte, keySize)
+			for i := range key {
+				key[i] = byte(i * 3)
+			}
+			ctx, err := NewContext(key)
+			if err != nil {
+				t.Fatalf("NewContext failed: %v", err)
+			}
+			block, _ := aes.NewCipher(key)
+			src := make([]byte, 21*BlockSize)
+			for i := range src {
+				src[i] = byte(i)
+			}
+			want := make([]byte, len(src))
+			for i := 0; i < len(src); i += BlockSize {
+				block.Encrypt(want[i:], src[i:])
+			}
+			got := make([]byte, len(src))
+			if err := ctx.EncryptBlocks(got, src); err != nil {
+				t.Fatalf("EncryptBlocks: %v", err)
+			}
+			if !bytes.Equal(got, want) {
+				t.Fatal("EncryptBlocks differs from crypto/aes")
+			}
+			if err := ctx.EncryptBlocks(got[:15], src[:15]); err != ErrInvalidArguments {
+				t.Fatalf("partial block: got %v, want ErrInvalidArguments", err)
+			}
+		})
+	}
+}
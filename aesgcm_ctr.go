@@ -0,0 +1,33 @@
+package aesgcm
+
+/*
+#cgo CFLAGS: -Wall -Werror
+#include "aes.h"
+*/
+import "C"
+import (
+	"runtime"
+	"unsafe"
+)
+
+// XORKeyStreamAt XORs src with CTR keystream into dst, starting at keystream
+// block blockOffset. counter is the 16-byte initial counter block, incremented
+// as one 128-bit big-endian integer per block as in crypto/cipher.NewCTR; the
+// offset lets a caller start mid-stream (a disk sector, a PRNG position)
+// without generating what comes before. dst and src must be the same length
+// and either the same slice or not overlap. CTR provides no integrity.
+func (ctx *Context) XORKeyStreamAt(dst, src, counter []byte, blockOffset uint64) error {
+	if ctx == nil || ctx.cCtx == nil || len(counter) != BlockSize || len(dst) != len(src) {
+		return ErrInvalidArguments
+	}
+	if len(src) == 0 {
+		return nil
+	}
+	ret := C.AES_CTR_xcrypt(ctx.cCtx, (*C.uint8_t)(unsafe.Pointer(&counter[0])), C.uint64_t(blockOffset),
+		(*C.uint8_t)(unsafe.Pointer(&src[0])), (*C.uint8_t)(unsafe.Pointer(&dst[0])), C.size_t(len(src)))
+	runtime.KeepAlive(ctx)
+	if ret != 0 {
+		return ErrInvalidArguments
+	}
+	return nil
+}
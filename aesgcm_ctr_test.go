@@ -0,0 +1,46 @@
+package aesgcm
+
+import (
+	"bytes"
+	"crypto/aes"
+	"crypto/cipher"
+	"testing"
+)
+
+// TestXORKeyStreamAt compares XORKeyStreamAt with crypto/cipher's CTR, whole
+// and seeked, from a counter whose low 32 bits wrap after two blocks.
+func TestXORKeyStreamAt(t *testing.T) {
+	key := make([]byte, KeySize128)
+	ctx, err := NewContext(key)
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	block, _ := aes.NewCipher(key)
+	counter := []byte{9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe}
+	src := make([]byte, 1000)
+	for i := range src {
+		src[i] = byte(i)
+	}
+	want := make([]byte, len(src))
+	cipher.NewCTR(block, counter).XORKeyStream(want, src)
+
+	got := make([]byte, len(src))
+	if err := ctx.XORKeyStreamAt(got, src, counter, 0); err != nil {
+		t.Fatalf("XORKeyStreamAt: %v", err)
+	}
+	if !bytes.Equal(got, want) {
+		t.Fatal("XORKeyStreamAt differs from crypto/cipher CTR")
+	}
+	for _, off := range []uint64{1, 2, 3, 17} {
+		part := make([]byte, len(src)-int(off)*BlockSize)
+		if err := ctx.XORKeyStreamAt(part, src[off*BlockSize:], counter, off); err != nil {
+			t.Fatalf("XORKeyStreamAt at block %d: %v", off, err)
+		}
+		if !bytes.Equal(part, want[off*BlockSize:]) {
+			t.Fatalf("XORKeyStreamAt at block %d differs", off)
+		}
+	}
+	if err := ctx.XORKeyStreamAt(got, src, counter[:8], 0); err != ErrInvalidArguments {
+		t.Fatalf("8-byte counter: got %v, want ErrInvalidArguments", err)
+	}
+}
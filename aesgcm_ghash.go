@@ -0,0 +1,51 @@
+package aesgcm
+
+/*
+#cgo CFLAGS: -Wall -Werror
+#include "aes.h"
+*/
+import "C"
+import "unsafe"
+
+// GHASH is a GHASH stream over GF(2^128) with a caller-chosen hash key H, on
+// the library's GHASH kernels. A trailing partial block is zero-padded. It is
+// not safe for concurrent use.
+type GHASH struct {
+	g C.struct_AES_GHASH_ctx
+}
+
+// NewGHASH returns a stream with hash key h, which must be 16 bytes.
+func NewGHASH(h []byte) (*GHASH, error) {
+	if len(h) != 16 {
+		return nil, ErrInvalidArguments
+	}
+	g := new(GHASH)
+	C.AES_GHASH_init(&g.g, (*C.uint8_t)(unsafe.Pointer(&h[0])))
+	return g, nil
+}
+
+// Write hashes p. It never returns an error.
+func (g *GHASH) Write(p []byte) (int, error) {
+	if len(p) > 0 {
+		C.AES_GHASH_update(&g.g, (*C.uint8_t)(unsafe.Pointer(&p[0])), C.size_t(len(p)))
+	}
+	return len(p), nil
+}
+
+// Combine appends tail's stream to g's, each zero-padded to a block boundary
+// as GCM pads the AAD and the ciphertext. Both must use the same H. tail is
+// not modified.
+func (g *GHASH) Combine(tail *GHASH) error {
+	if tail == nil || C.AES_GHASH_combine(&g.g, &tail.g) != 0 {
+		return ErrInvalidArguments
+	}
+	return nil
+}
+
+// Sum appends the hash of the bytes written so far to b. g can keep hashing.
+func (g *GHASH) Sum(b []byte) []byte {
+	var out [16]byte
+	tmp := g.g
+	C.AES_GHASH_final(&tmp, (*C.uint8_t)(unsafe.Pointer(&out[0])))
+	return append(b, out[:]...)
+}
@@ -0,0 +1,65 @@
+package aesgcm
+
+import (
+	"bytes"
+	"crypto/aes"
+	"crypto/cipher"
+	"encoding/binary"
+	"fmt"
+	"testing"
+)
+
+// TestGHASH rebuilds crypto/cipher's GCM tags from GHASH streams: the AAD and
+// ciphertext are hashed separately and combined, then the length block is
+// written, and the tag is that hash XOR E_K(J0).
+func TestGHASH(t *testing.T) {
+	key := make([]byte, 16)
+	for i := range key {
+		key[i] = byte(i * 11)
+	}
+	block, _ := aes.NewCipher(key)
+	gcm, _ := cipher.NewGCM(block)
+	h := make([]byte, 16)
+	block.Encrypt(h, h)
+	for _, sizes := range [][2]int{{0, 0}, {1, 1}, {13, 64}, {16, 100}, {70, 1000}} {
+		t.Run(fmt.Sprint(sizes), func(t *testing.T) {
+			iv, aad, pt := make([]byte, 12), make([]byte, sizes[0]), make([]byte, sizes[1])
+			for i := range aad {
+				aad[i] = byte(i)
+			}
+			sealed := gcm.Seal(nil, iv, pt, aad)
+			ct, tag := sealed[:len(pt)], sealed[len(pt):]
+
+			g, err := NewGHASH(h)
+			if err != nil {
+				t.Fatalf("NewGHASH: %v", err)
+			}
+			c, _ := NewGHASH(h)
+			g.Write(aad)
+			c.Write(ct)
+			if err := g.Combine(c); err != nil {
+				t.Fatalf("Combine: %v", err)
+			}
+			var lens [16]byte
+			binary.BigEndian.PutUint64(lens[:8], uint64(len(aad))*8)
+			binary.BigEndian.PutUint64(lens[8:], uint64(len(ct))*8)
+			g.Write(lens[:])
+			sum := g.Sum(nil)
+			if !bytes.Equal(g.Sum(nil), sum) {
+				t.Fatal("Sum changed the stream")
+			}
+
+			j0 := append(iv[:12:12], 0, 0, 0, 1)
+			block.Encrypt(j0, j0)
+			for i := range sum {
+				sum[i] ^= j0[i]
+			}
+			if !bytes.Equal(sum, tag) {
+				t.Fatalf("tag from GHASH = %x, crypto/cipher = %x", sum, tag)
+			}
+		})
+	}
+	if _, err := NewGHASH(make([]byte, 12)); err != ErrInvalidArguments {
+		t.Fatalf("NewGHASH with a 12-byte key: got %v", err)
+	}
+}
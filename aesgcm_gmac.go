@@ -0,0 +1,67 @@
+package aesgcm
+
+/*
+#cgo CFLAGS: -Wall -Werror
+#include "aes.h"
+*/
+import "C"
+import (
+	"runtime"
+	"unsafe"
+)
+
+// GMAC returns the GMAC tag of data: GCM authentication with data as the AAD
+// and nothing encrypted, so it equals the tag of Encrypt(iv, data, nil). iv
+// must not be reused with the same key, as for Encrypt.
+func (ctx *Context) GMAC(iv, data []byte) ([]byte, error) {
+	tag := make([]byte, TagSize)
+	ret, err := ctx.gmac(iv, data, tag, false)
+	if err != nil {
+		return nil, err
+	}
+	if ret != 0 {
+		return nil, ErrInvalidArguments
+	}
+	return tag, nil
+}
+
+// VerifyGMAC checks tag against data in constant time. It returns
+// ErrAuthFailed if they do not match.
+func (ctx *Context) VerifyGMAC(iv, data, tag []byte) error {
+	if len(tag) != TagSize {
+		return ErrInvalidArguments
+	}
+	ret, err := ctx.gmac(iv, data, tag, true)
+	if err != nil {
+		return err
+	}
+	switch ret {
+	case 0:
+		return nil
+	case -3:
+		return ErrAuthFailed
+	}
+	return ErrInvalidArguments
+}
+
+// gmac calls AES_GMAC, or AES_GMAC_verify if verify is set, and returns its
+// result code.
+func (ctx *Context) gmac(iv, data, tag []byte, verify bool) (C.int, error) {
+	if ctx == nil || ctx.cCtx == nil || len(iv) == 0 {
+		return 0, ErrInvalidArguments
+	}
+	var dataPtr *C.uint8_t
+	if len(data) > 0 {
+		dataPtr = (*C.uint8_t)(unsafe.Pointer(&data[0]))
+	}
+	ivPtr := (*C.uint8_t)(unsafe.Pointer(&iv[0]))
+	tagPtr := (*C.uint8_t)(unsafe.Pointer(&tag[0]))
+	var ret C.int
+	if verify {
+		ret = C.AES_GMAC_verify(ctx.cCtx, ivPtr, C.size_t(len(iv)), dataPtr, C.size_t(len(data)), tagPtr)
+	} else {
+		ret = C.AES_GMAC(ctx.cCtx, ivPtr, C.size_t(len(iv)), dataPtr, C.size_t(len(data)), tagPtr)
+	}
+	runtime.KeepAlive(ctx)
+	return ret, nil
+}
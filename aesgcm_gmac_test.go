@@ -0,0 +1,52 @@
+package aesgcm
+
+import (
+	"crypto/aes"
+	"crypto/cipher"
+	"fmt"
+	"testing"
+)
+
+// TestGMAC compares GMAC with crypto/cipher's GCM tag over data passed as
+// additional data, for lengths on both sides of the 64-byte GHASH stride.
+func TestGMAC(t *testing.T) {
+	key := make([]byte, KeySize256)
+	for i := range key {
+		key[i] = byte(i * 7)
+	}
+	ctx, err := NewContext(key)
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	block, _ := aes.NewCipher(key)
+	for _, ivLen := range []int{12, 16} {
+		gcm, _ := cipher.NewGCMWithNonceSize(block, ivLen)
+		for _, n := range []int{0, 1, 63, 64, 65, 1000} {
+			t.Run(fmt.Sprintf("IV-%d/%d", ivLen, n), func(t *testing.T) {
+				iv, data := make([]byte, ivLen), make([]byte, n)
+				for i := range data {
+					data[i] = byte(i)
+				}
+				iv[0] = byte(n)
+				want := gcm.Seal(nil, iv, nil, data)
+				tag, err := ctx.GMAC(iv, data)
+				if err != nil {
+					t.Fatalf("GMAC: %v", err)
+				}
+				if string(tag) != string(want) {
+					t.Fatalf("GMAC = %x, crypto/cipher = %x", tag, want)
+				}
+				if err := ctx.VerifyGMAC(iv, data, tag); err != nil {
+					t.Fatalf("VerifyGMAC of a good tag: %v", err)
+				}
+				tag[0] ^= 1
+				if err := ctx.VerifyGMAC(iv, data, tag); err != ErrAuthFailed {
+					t.Fatalf("VerifyGMAC of a bad tag: got %v, want ErrAuthFailed", err)
+				}
+			})
+		}
+	}
+	if _, err := ctx.GMAC(nil, []byte("x")); err != ErrInvalidArguments {
+		t.Fatalf("GMAC with no IV: got %v, want ErrInvalidArguments", err)
+	}
+}
@@ -0,0 +1,116 @@
+package aesgcm
+
+/*
+#cgo CFLAGS: -Wall -Werror
+#include "aes_keycache.h"
+*/
+import "C"
+import (
+	"errors"
+	"runtime"
+	"unsafe"
+)
+
+// ErrKeyCacheFull is returned by KeyCache.Get when the key is not cached and
+// every entry it could replace is in use.
+var ErrKeyCacheFull = errors.New("aesgcm: key cache full (every entry is in use)")
+
+// KeyCache maps key IDs to expanded contexts so that a hot key is set up once
+// rather than per request. It wraps the C cache in aes_keycache.h: lookups do
+// not lock, eviction is CLOCK (approximate LRU) per shard, and evicted or
+// removed contexts are zeroed. It is safe for concurrent use.
+type KeyCache struct {
+	c *C.struct_AES_key_cache
+}
+
+// KeyCacheStats are a KeyCache's counters, as returned by Stats.
+type KeyCacheStats struct {
+	Hits, Misses, Inserts, Evictions uint64
+	Entries, Capacity                uint64
+}
+
+// CachedContext is a Context pinned in a KeyCache: it will not be evicted or
+// wiped until Release is called. It must not be used after Release.
+type CachedContext struct {
+	Context
+	cache *KeyCache
+}
+
+// NewKeyCache returns a cache holding up to capacity contexts, split over
+// shards independent shards (0 selects the C default of 16).
+func NewKeyCache(capacity, shards int) (*KeyCache, error) {
+	if capacity <= 0 || shards < 0 {
+		return nil, ErrInvalidArguments
+	}
+	c := C.AES_key_cache_new(C.size_t(capacity), C.uint(shards))
+	if c == nil {
+		return nil, ErrInvalidArguments
+	}
+	kc := &KeyCache{c: c}
+	runtime.SetFinalizer(kc, (*KeyCache).Close)
+	return kc, nil
+}
+
+// Close wipes and frees the cache. No CachedContext may be in use.
+func (kc *KeyCache) Close() {
+	if kc.c != nil {
+		C.AES_key_cache_free(kc.c)
+		kc.c = nil
+	}
+}
+
+// Get returns the context cached under keyID, pinned. On a miss it calls load
+// for the key (16, 24, 32 or 64 bytes), expands it into the cache and returns
+// that. Concurrent misses on the same ID may each call load; one expanded key
+// is kept.
+func (kc *KeyCache) Get(keyID uint64, load func(keyID uint64) ([]byte, error)) (*CachedContext, error) {
+	if kc == nil || kc.c == nil || load == nil {
+		return nil, ErrInvalidArguments
+	}
+	p := C.AES_key_cache_get(kc.c, C.uint64_t(keyID))
+	if p == nil {
+		key, err := load(keyID)
+		if err != nil {
+			return nil, err
+		}
+		if !validKeySize(len(key)) {
+			return nil, ErrInvalidKeySize
+		}
+		p = C.AES_key_cache_insert(kc.c, C.uint64_t(keyID), (*C.uint8_t)(unsafe.Pointer(&key[0])), C.size_t(len(key)))
+		if p == nil {
+			return nil, ErrKeyCacheFull
+		}
+	}
+	// Nr is 10, 12, 14 or 22 for 16, 24, 32 or 64-byte keys
+	keyLen := (int(p.Nr) - 6) * 4
+	return &CachedContext{Context: Context{cCtx: p, keyLen: keyLen}, cache: kc}, nil
+}
+
+// Release unpins the context. Further calls do nothing.
+func (cc *CachedContext) Release() {
+	if cc.cCtx != nil {
+		C.AES_key_cache_release(cc.cache.c, cc.cCtx)
+		cc.cCtx = nil
+	}
+}
+
+// Remove drops keyID from the cache (after rotation or revocation) and reports
+// whether it was cached. Contexts already handed out stay usable until they
+// are released, then they are wiped.
+func (kc *KeyCache) Remove(keyID uint64) bool {
+	return C.AES_key_cache_remove(kc.c, C.uint64_t(keyID)) == 0
+}
+
+// Stats returns the cache's counters.
+func (kc *KeyCache) Stats() KeyCacheStats {
+	var st C.struct_AES_key_cache_stats
+	C.AES_key_cache_stats(kc.c, &st)
+	return KeyCacheStats{
+		Hits:      uint64(st.hits),
+		Misses:    uint64(st.misses),
+		Inserts:   uint64(st.inserts),
+		Evictions: uint64(st.evictions),
+		Entries:   uint64(st.entries),
+		Capacity:  uint64(st.capacity),
+	}
+}
@@ -0,0 +1,107 @@
+package aesgcm
+
+import (
+	"bytes"
+	"errors"
+	"sync"
+	"sync/atomic"
+	"testing"
+)
+
+func tenantKey(id uint64) []byte {
+	key := make([]byte, KeySize128)
+	key[0], key[1] = byte(id), byte(id>>8)
+	return key
+}
+
+// TestKeyCache seals with cached contexts from several goroutines over more
+// tenants than the cache holds, removing some on the way, and checks every
+// message against a context built directly from the tenant's key.
+func TestKeyCache(t *testing.T) {
+	kc, err := NewKeyCache(32, 4)
+	if err != nil {
+		t.Fatalf("NewKeyCache failed: %v", err)
+	}
+	defer kc.Close()
+	var loads atomic.Uint64
+	load := func(id uint64) ([]byte, error) {
+		loads.Add(1)
+		return tenantKey(id), nil
+	}
+
+	const workers, rounds, tenants = 8, 2000, 100
+	iv, aad, plaintext := make([]byte, 12), []byte("tenant"), []byte("per-tenant message")
+	var wg sync.WaitGroup
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func(w int) {
+			defer wg.Done()
+			for i := 0; i < rounds; i++ {
+				id := uint64((i*31 + w*7) % tenants)
+				cc, err := kc.Get(id, load)
+				if err != nil {
+					t.Errorf("Get(%d): %v", id, err)
+					return
+				}
+				ct, tag, err := cc.Encrypt(iv, aad, plaintext)
+				cc.Release()
+				if err != nil {
+					t.Errorf("Encrypt: %v", err)
+					return
+				}
+				ref, _ := NewContext(tenantKey(id))
+				if pt, err := ref.Decrypt(iv, aad, ct, tag); err != nil || !bytes.Equal(pt, plaintext) {
+					t.Errorf("tenant %d: cached context does not hold the tenant's key", id)
+					return
+				}
+				if i%100 == 0 {
+					kc.Remove(id)
+				}
+			}
+		}(w)
+	}
+	wg.Wait()
+
+	st := kc.Stats()
+	if st.Hits+st.Misses != workers*rounds || st.Misses != loads.Load() || st.Entries > st.Capacity || st.Capacity != 32 {
+		t.Fatalf("inconsistent stats %+v after %d loads", st, loads.Load())
+	}
+	if st.Evictions == 0 {
+		t.Fatal("expected evictions with more tenants than capacity")
+	}
+}
+
+func TestKeyCacheErrors(t *testing.T) {
+	if _, err := NewKeyCache(0, 0); err != ErrInvalidArguments {
+		t.Fatalf("zero capacity: got %v, want ErrInvalidArguments", err)
+	}
+	kc, _ := NewKeyCache(1, 0)
+	defer kc.Close()
+	errStore := errors.New("key store unavailable")
+	if _, err := kc.Get(1, func(uint64) ([]byte, error) { return nil, errStore }); err != errStore {
+		t.Fatalf("load error: got %v", err)
+	}
+	if _, err := kc.Get(1, func(uint64) ([]byte, error) { return make([]byte, 7), nil }); err != ErrInvalidKeySize {
+		t.Fatalf("7-byte key: got %v, want ErrInvalidKeySize", err)
+	}
+
+	cc, err := kc.Get(1, func(uint64) ([]byte, error) { return make([]byte, KeySize512), nil })
+	if err != nil || cc.KeySize() != KeySize512 {
+		t.Fatalf("Get: %v (key size %d)", err, cc.KeySize())
+	}
+	// The only entry is pinned, so another tenant cannot be cached
+	if _, err := kc.Get(2, func(uint64) ([]byte, error) { return tenantKey(2), nil }); err != ErrKeyCacheFull {
+		t.Fatalf("full cache: got %v, want ErrKeyCacheFull", err)
+	}
+	if !kc.Remove(1) || kc.Remove(1) {
+		t.Fatal("Remove should report the entry once")
+	}
+	if _, _, err := cc.Encrypt(make([]byte, 12), nil, []byte("still pinned")); err != nil {
+		t.Fatalf("removed but pinned context: %v", err)
+	}
+	cc.Release()
+	cc.Release()
+	if _, _, err := cc.Encrypt(make([]byte, 12), nil, nil); err == nil {
+		t.Fatal("Encrypt with a released context succeeded")
+	}
+}
@@ -0,0 +1,119 @@
+package aesgcm
+
+import (
+	"encoding/binary"
+	"errors"
+	"sync/atomic"
+)
+
+// Nonce leases: the same IV layout and limits as aes_nonce.h in C.
+const (
+	NoncePrefixSize   = 4
+	DefaultNonceLimit = uint64(1) << 32 // Conservative policy default per key; counter IVs are bounded by the 64-bit counter, not SP 800-38D 8.3's 2^32
+	DefaultNonceBlock = 1024
+)
+
+// ErrNonceExhausted is returned once a NonceSource has handed out its limit of
+// IVs. The key must be replaced.
+var ErrNonceExhausted = errors.New("aesgcm: nonce source exhausted (rekey)")
+
+// NonceSource hands out unique 12-byte IVs for one Context: a fixed 4-byte
+// prefix followed by a 64-bit big-endian counter. Each goroutine takes a
+// NonceLease, which reserves counters from the source in blocks, so the shared
+// counter is written once per block instead of once per message.
+//
+// Every source sharing a key needs a different prefix. Counters left in an
+// abandoned lease are never reused.
+type NonceSource struct {
+	next   atomic.Uint64 // First unreserved counter
+	_      [56]byte      // Keeps the fields below off the counter's cache line
+	ctx    *Context
+	limit  uint64
+	prefix [NoncePrefixSize]byte
+}
+
+// NewNonceSource returns a source for ctx. limit is the number of messages
+// allowed under the key; 0 selects DefaultNonceLimit.
+func (ctx *Context) NewNonceSource(prefix []byte, limit uint64) (*NonceSource, error) {
+	if ctx == nil || len(prefix) != NoncePrefixSize {
+		return nil, ErrInvalidArguments
+	}
+	if limit == 0 {
+		limit = DefaultNonceLimit
+	}
+	s := &NonceSource{ctx: ctx, limit: limit}
+	copy(s.prefix[:], prefix)
+	return s, nil
+}
+
+// Remaining returns the number of counters not yet reserved by any lease.
+func (s *NonceSource) Remaining() uint64 {
+	if next := s.next.Load(); next < s.limit {
+		return s.limit - next
+	}
+	return 0
+}
+
+// NonceLease is one goroutine's share of a NonceSource. It is not safe for
+// concurrent use.
+type NonceLease struct {
+	src       *NonceSource
+	next, end uint64
+	block     uint64
+}
+
+// Lease returns an empty lease that reserves block counters at a time
+// (0 selects DefaultNonceBlock).
+func (s *NonceSource) Lease(block uint32) *NonceLease {
+	if block == 0 {
+		block = DefaultNonceBlock
+	}
+	return &NonceLease{src: s, block: uint64(block)}
+}
+
+func (l *NonceLease) refill() error {
+	s := l.src
+	// Exhausted sources are not written to, so the counter cannot wrap
+	if s.next.Load() >= s.limit {
+		return ErrNonceExhausted
+	}
+	start := s.next.Add(l.block) - l.block
+	if start >= s.limit {
+		return ErrNonceExhausted
+	}
+	l.next, l.end = start, start+l.block
+	if s.limit-start < l.block {
+		l.end = s.limit
+	}
+	return nil
+}
+
+// Next writes the lease's next IV into iv, which must be 12 bytes.
+func (l *NonceLease) Next(iv []byte) error {
+	if len(iv) != 12 {
+		return ErrInvalidArguments
+	}
+	if l.next == l.end {
+		if err := l.refill(); err != nil {
+			return err
+		}
+	}
+	copy(iv, l.src.prefix[:])
+	binary.BigEndian.PutUint64(iv[NoncePrefixSize:], l.next)
+	l.next++
+	return nil
+}
+
+// Seal encrypts plaintext under the source's Context with the next IV and
+// returns the IV along with the ciphertext and tag.
+func (l *NonceLease) Seal(aad, plaintext []byte) (iv, ciphertext, tag []byte, err error) {
+	iv = make([]byte, 12)
+	if err := l.Next(iv); err != nil {
+		return nil, nil, nil, err
+	}
+	ciphertext, tag, err = l.src.ctx.Encrypt(iv, aad, plaintext)
+	if err != nil {
+		return nil, nil, nil, err
+	}
+	return iv, ciphertext, tag, nil
+}
@@ -0,0 +1,92 @@
+package aesgcm
+
+import (
+	"bytes"
+	"encoding/binary"
+	"sync"
+	"testing"
+)
+
+// TestNonceLeases draws IVs from one source on several goroutines with small
+// blocks and checks that every counter below the limit is issued exactly once.
+func TestNonceLeases(t *testing.T) {
+	ctx, err := NewContext(make([]byte, KeySize256))
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	prefix := []byte{1, 2, 3, 4}
+	const limit, workers = 10000, 8
+	src, err := ctx.NewNonceSource(prefix, limit)
+	if err != nil {
+		t.Fatalf("NewNonceSource failed: %v", err)
+	}
+
+	counts := make([][]uint64, workers)
+	var wg sync.WaitGroup
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func(w int) {
+			defer wg.Done()
+			lease := src.Lease(uint32(7 + w))
+			iv := make([]byte, 12)
+			for {
+				if err := lease.Next(iv); err != nil {
+					if err != ErrNonceExhausted {
+						t.Errorf("Next: %v", err)
+					}
+					return
+				}
+				if !bytes.Equal(iv[:NoncePrefixSize], prefix) {
+					t.Errorf("IV %x does not start with the prefix", iv)
+					return
+				}
+				counts[w] = append(counts[w], binary.BigEndian.Uint64(iv[NoncePrefixSize:]))
+			}
+		}(w)
+	}
+	wg.Wait()
+
+	seen := make(map[uint64]bool, limit)
+	for _, c := range counts {
+		for _, n := range c {
+			if n >= limit || seen[n] {
+				t.Fatalf("counter %d issued twice or past the limit", n)
+			}
+			seen[n] = true
+		}
+	}
+	if len(seen) != limit || src.Remaining() != 0 {
+		t.Fatalf("issued %d IVs (remaining %d), want %d", len(seen), src.Remaining(), limit)
+	}
+	if err := src.Lease(0).Next(make([]byte, 12)); err != ErrNonceExhausted {
+		t.Fatalf("new lease on an exhausted source: got %v, want ErrNonceExhausted", err)
+	}
+}
+
+func TestNonceLeaseSeal(t *testing.T) {
+	ctx, err := NewContext(make([]byte, KeySize128))
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	if _, err := ctx.NewNonceSource([]byte{1, 2, 3}, 0); err != ErrInvalidArguments {
+		t.Fatalf("3-byte prefix: got %v, want ErrInvalidArguments", err)
+	}
+	src, _ := ctx.NewNonceSource([]byte{9, 9, 9, 9}, 0)
+	if src.Remaining() != DefaultNonceLimit {
+		t.Fatalf("Remaining = %d, want DefaultNonceLimit", src.Remaining())
+	}
+	lease := src.Lease(0)
+	aad, plaintext := []byte("header"), []byte("a message sealed with a leased nonce")
+	iv1, ciphertext, tag, err := lease.Seal(aad, plaintext)
+	if err != nil {
+		t.Fatalf("Seal failed: %v", err)
+	}
+	iv2, _, _, _ := lease.Seal(aad, plaintext)
+	if bytes.Equal(iv1, iv2) {
+		t.Fatal("consecutive Seal calls reused an IV")
+	}
+	decrypted, err := ctx.Decrypt(iv1, aad, ciphertext, tag)
+	if err != nil || !bytes.Equal(decrypted, plaintext) {
+		t.Fatalf("Decrypt of a leased-nonce message failed: %v", err)
+	}
+}
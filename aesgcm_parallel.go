@@ -0,0 +1,126 @@
+package aesgcm
+
+/*
+#include "aes.h"
+*/
+import "C"
+import (
+	"crypto/subtle"
+	"errors"
+	"runtime"
+	"sync"
+	"unsafe"
+)
+
+// parallelMinChunk is the smallest chunk handed to one goroutine by
+// EncryptParallel and DecryptParallel. Inputs shorter than two chunks are
+// processed by a single goroutine, where the fan-out would only add overhead.
+const parallelMinChunk = 1 << 20 // 1 MiB
+
+// parallelChunkSize splits n bytes across workers goroutines. The result is a
+// multiple of BlockSize (the chunk kernels require block-aligned chunk starts)
+// and at least minChunk.
+func parallelChunkSize(n, workers, minChunk int) int {
+	if workers < 1 {
+		workers = 1
+	}
+	chunk := (n + workers - 1) / workers
+	chunk = (chunk + BlockSize - 1) / BlockSize * BlockSize
+	if chunk < minChunk {
+		chunk = minChunk
+	}
+	return chunk
+}
+
+// EncryptParallel performs AES-GCM authenticated encryption like Encrypt, but
+// splits large plaintexts across GOMAXPROCS goroutines. Each goroutine runs the
+// C chunk kernel (keystream plus partial GHASH at its counter offset) and the
+// partial GHASH values are combined into the final tag, so the output is
+// identical to Encrypt's.
+func (ctx *Context) EncryptParallel(iv, aad, plaintext []byte) (ciphertext []byte, tag []byte, err error) {
+	chunk := parallelChunkSize(len(plaintext), runtime.GOMAXPROCS(0), parallelMinChunk)
+	ciphertext = make([]byte, len(plaintext))
+	tag, err = ctx.xcryptParallel(iv, aad, plaintext, ciphertext, chunk, true)
+	if err != nil {
+		return nil, nil, err
+	}
+	return ciphertext, tag, nil
+}
+
+// DecryptParallel is the parallel counterpart of Decrypt. The ciphertext is
+// hashed and decrypted in a single pass per chunk; the plaintext is only
+// returned once the combined tag has been verified.
+func (ctx *Context) DecryptParallel(iv, aad, ciphertext, tag []byte) (plaintext []byte, err error) {
+	if len(tag) != TagSize {
+		return nil, errors.New("aesgcm: invalid tag size")
+	}
+	chunk := parallelChunkSize(len(ciphertext), runtime.GOMAXPROCS(0), parallelMinChunk)
+	plaintext = make([]byte, len(ciphertext))
+	expected, err := ctx.xcryptParallel(iv, aad, ciphertext, plaintext, chunk, false)
+	if err != nil {
+		return nil, err
+	}
+	if subtle.ConstantTimeCompare(expected, tag) != 1 {
+		clear(plaintext) // Do not leak unauthenticated plaintext
+		return nil, ErrAuthFailed
+	}
+	return plaintext, nil
+}
+
+// xcryptParallel runs the chunk kernels over in -> out with chunk-sized pieces
+// on separate goroutines and returns the computed tag.
+func (ctx *Context) xcryptParallel(iv, aad, in, out []byte, chunk int, encrypt bool) ([]byte, error) {
+	if ctx == nil || ctx.cCtx == nil {
+		return nil, errors.New("aesgcm: context is nil")
+	}
+	// Keep the finalizer from freeing the C context while the kernels run.
+	defer runtime.KeepAlive(ctx)
+
+	var ivPtr *C.uint8_t
+	if len(iv) > 0 {
+		ivPtr = (*C.uint8_t)(unsafe.Pointer(&iv[0]))
+	}
+	var aadPtr *C.uint8_t
+	if len(aad) > 0 {
+		aadPtr = (*C.uint8_t)(unsafe.Pointer(&aad[0]))
+	}
+
+	var j0, ghash [BlockSize]C.uint8_t
+	if C.AES_GCM_chunk_start(ctx.cCtx, ivPtr, C.size_t(len(iv)), aadPtr, C.size_t(len(aad)), &j0[0], &ghash[0]) != 0 {
+		return nil, ErrInvalidArguments
+	}
+
+	nChunks := (len(in) + chunk - 1) / chunk
+	partials := make([][BlockSize]C.uint8_t, nChunks)
+	var wg sync.WaitGroup
+	for i := 0; i < nChunks; i++ {
+		off := i * chunk
+		end := min(off+chunk, len(in))
+		wg.Add(1)
+		go func(i, off, end int) {
+			defer wg.Done()
+			inPtr := (*C.uint8_t)(unsafe.Pointer(&in[off]))
+			outPtr := (*C.uint8_t)(unsafe.Pointer(&out[off]))
+			blockOffset := C.uint64_t(off / BlockSize)
+			if encrypt {
+				C.AES_GCM_encrypt_chunk(ctx.cCtx, &j0[0], blockOffset, inPtr, outPtr, C.size_t(end-off), &partials[i][0])
+			} else {
+				C.AES_GCM_decrypt_chunk(ctx.cCtx, &j0[0], blockOffset, inPtr, outPtr, C.size_t(end-off), &partials[i][0])
+			}
+		}(i, off, end)
+	}
+	wg.Wait()
+
+	// Fold the partial GHASH values in message order.
+	for i := 0; i < nChunks; i++ {
+		size := min(chunk, len(in)-i*chunk)
+		C.AES_GCM_chunk_combine(ctx.cCtx, &ghash[0], &partials[i][0], C.size_t(size))
+	}
+
+	tag := make([]byte, TagSize)
+	tagPtr := (*C.uint8_t)(unsafe.Pointer(&tag[0]))
+	if C.AES_GCM_chunk_finish(ctx.cCtx, &j0[0], &ghash[0], C.size_t(len(aad)), C.size_t(len(in)), tagPtr) != 0 {
+		return nil, ErrInvalidArguments
+	}
+	return tag, nil
+}
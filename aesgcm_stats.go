@@ -0,0 +1,103 @@
+package aesgcm
+
+/*
+#include "aes.h"
+
+// See aesgcm_noop: a cgo call without arguments trips -Werror.
+static inline void aesgcm_stats_reset(int unused) { (void)unused; AES_GCM_stats_reset(); }
+*/
+import "C"
+import (
+	"fmt"
+	"io"
+	"time"
+)
+
+// Stats is a snapshot of the C library's hot-path counters, summed over all
+// threads. The counters are only compiled in when the package is built with
+// -tags aesgcm_stats; otherwise Enabled is false and every counter is zero.
+//
+// The chunk kernels used by EncryptParallel/DecryptParallel count bytes and
+// time but not messages or authentication failures.
+type Stats struct {
+	Enabled      bool
+	Backend      string // Compiled-in kernels, e.g. "aesni+pclmul"
+	SealMessages uint64
+	SealBytes    uint64
+	OpenMessages uint64
+	OpenBytes    uint64
+	AuthFailures uint64
+	// Verify calls check tags without decrypting; they are not counted as opens.
+	VerifyMessages uint64
+	VerifyBytes    uint64
+	VerifyFailures uint64
+	IVSlowPath     uint64 // Messages whose IV was not 12 bytes (J0 derived with GHASH)
+	CTRTime        time.Duration
+	GHASHTime      time.Duration
+}
+
+// ReadStats returns the counters accumulated since the last ResetStats.
+func ReadStats() Stats {
+	var cs C.struct_AES_GCM_stats
+	enabled := C.AES_GCM_stats_snapshot(&cs) == 0
+	return Stats{
+		Enabled:        enabled,
+		Backend:        C.GoString(cs.backend),
+		SealMessages:   uint64(cs.seal_messages),
+		SealBytes:      uint64(cs.seal_bytes),
+		OpenMessages:   uint64(cs.open_messages),
+		OpenBytes:      uint64(cs.open_bytes),
+		AuthFailures:   uint64(cs.auth_failures),
+		VerifyMessages: uint64(cs.verify_messages),
+		VerifyBytes:    uint64(cs.verify_bytes),
+		VerifyFailures: uint64(cs.verify_failures),
+		IVSlowPath:     uint64(cs.iv_slow_path),
+		CTRTime:        time.Duration(cs.ctr_ns),
+		GHASHTime:      time.Duration(cs.ghash_ns),
+	}
+}
+
+// ResetStats makes later snapshots count from zero. Prometheus counters must
+// not go backwards, so do not call it in a process that is being scraped.
+func ResetStats() {
+	C.aesgcm_stats_reset(0)
+}
+
+// WritePrometheus writes s in the Prometheus text exposition format, e.g. from
+// an HTTP handler:
+//
+//	http.HandleFunc("/metrics", func(w http.ResponseWriter, r *http.Request) {
+//		w.Header().Set("Content-Type", "text/plain; version=0.0.4")
+//		aesgcm.ReadStats().WritePrometheus(w)
+//	})
+func (s Stats) WritePrometheus(w io.Writer) error {
+	enabled := 0
+	if s.Enabled {
+		enabled = 1
+	}
+	metrics := []struct {
+		name, kind, help string
+		value            any
+	}{
+		{"aesgcm_stats_enabled", "gauge", "Whether the library was built with counters (-tags aesgcm_stats).", enabled},
+		{"aesgcm_seal_messages_total", "counter", "Messages encrypted.", s.SealMessages},
+		{"aesgcm_seal_bytes_total", "counter", "Bytes encrypted.", s.SealBytes},
+		{"aesgcm_open_messages_total", "counter", "Messages decrypted.", s.OpenMessages},
+		{"aesgcm_open_bytes_total", "counter", "Bytes decrypted.", s.OpenBytes},
+		{"aesgcm_auth_failures_total", "counter", "Decryptions rejected because the tag did not match.", s.AuthFailures},
+		{"aesgcm_verify_messages_total", "counter", "Messages whose tag was checked without decrypting.", s.VerifyMessages},
+		{"aesgcm_verify_bytes_total", "counter", "Bytes authenticated without decrypting.", s.VerifyBytes},
+		{"aesgcm_verify_failures_total", "counter", "Verifications that failed because the tag did not match.", s.VerifyFailures},
+		{"aesgcm_iv_slow_path_total", "counter", "Messages with a non-96-bit IV (J0 derived with GHASH).", s.IVSlowPath},
+		{"aesgcm_ctr_seconds_total", "counter", "Time spent in the CTR kernel.", s.CTRTime.Seconds()},
+		{"aesgcm_ghash_seconds_total", "counter", "Time spent in GHASH and tag computation.", s.GHASHTime.Seconds()},
+	}
+	for _, m := range metrics {
+		if _, err := fmt.Fprintf(w, "# HELP %s %s\n# TYPE %s %s\n%s %v\n", m.name, m.help, m.name, m.kind, m.name, m.value); err != nil {
+			return err
+		}
+	}
+	_, err := fmt.Fprintf(w, "# HELP aesgcm_backend_info Kernels compiled into the library.\n"+
+		"# TYPE aesgcm_backend_info gauge\naesgcm_backend_info{backend=%q} 1\n", s.Backend)
+	return err
+}
@@ -0,0 +1,12 @@
+//go:build aesgcm_stats
+
+package aesgcm
+
+// Building with -tags aesgcm_stats compiles the C library's per-thread
+// counters in (see ReadStats).
+
+/*
+#cgo CFLAGS: -DAES_GCM_STATS=1
+#cgo LDFLAGS: -lpthread
+*/
+import "C"
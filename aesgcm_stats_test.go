@@ -0,0 +1,82 @@
+package aesgcm
+
+import (
+	"bytes"
+	"strings"
+	"testing"
+)
+
+// TestStats checks the counter deltas for a known sequence of calls when the
+// package is built with -tags aesgcm_stats, and that they stay zero otherwise.
+func TestStats(t *testing.T) {
+	ctx, err := NewContext(make([]byte, KeySize128))
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	plaintext := make([]byte, 100)
+	before := ReadStats()
+	if before.Backend == "" {
+		t.Error("Backend is empty")
+	}
+
+	ciphertext, tag, err := ctx.Encrypt(make([]byte, 12), nil, plaintext)
+	if err != nil {
+		t.Fatalf("Encrypt failed: %v", err)
+	}
+	longIV := make([]byte, 16)
+	if _, _, err := ctx.Encrypt(longIV, nil, plaintext); err != nil {
+		t.Fatalf("Encrypt failed: %v", err)
+	}
+	if _, err := ctx.Decrypt(make([]byte, 12), nil, ciphertext, tag); err != nil {
+		t.Fatalf("Decrypt failed: %v", err)
+	}
+	if err := ctx.Verify(make([]byte, 12), nil, ciphertext, tag); err != nil {
+		t.Fatalf("Verify failed: %v", err)
+	}
+	tag[0] ^= 1
+	if _, err := ctx.Decrypt(make([]byte, 12), nil, ciphertext, tag); err != ErrAuthFailed {
+		t.Fatalf("Decrypt with a bad tag: got %v, want ErrAuthFailed", err)
+	}
+	if err := ctx.Verify(make([]byte, 12), nil, ciphertext, tag); err != ErrAuthFailed {
+		t.Fatalf("Verify with a bad tag: got %v, want ErrAuthFailed", err)
+	}
+	after := ReadStats()
+
+	if after.Enabled != before.Enabled {
+		t.Fatalf("Enabled changed between snapshots")
+	}
+	want := map[string][2]uint64{
+		"SealMessages":   {after.SealMessages - before.SealMessages, 2},
+		"SealBytes":      {after.SealBytes - before.SealBytes, 200},
+		"OpenMessages":   {after.OpenMessages - before.OpenMessages, 2},
+		"OpenBytes":      {after.OpenBytes - before.OpenBytes, 200},
+		"AuthFailures":   {after.AuthFailures - before.AuthFailures, 1},
+		"VerifyMessages": {after.VerifyMessages - before.VerifyMessages, 2},
+		"VerifyBytes":    {after.VerifyBytes - before.VerifyBytes, 200},
+		"VerifyFailures": {after.VerifyFailures - before.VerifyFailures, 1},
+		"IVSlowPath":     {after.IVSlowPath - before.IVSlowPath, 1},
+	}
+	for name, v := range want {
+		if !after.Enabled {
+			v[1] = 0
+		}
+		if v[0] != v[1] {
+			t.Errorf("%s delta = %d, want %d", name, v[0], v[1])
+		}
+	}
+	t.Logf("stats enabled=%v backend=%s ctr=%v ghash=%v", after.Enabled, after.Backend, after.CTRTime, after.GHASHTime)
+
+	var buf bytes.Buffer
+	if err := after.WritePrometheus(&buf); err != nil {
+		t.Fatalf("WritePrometheus failed: %v", err)
+	}
+	for _, line := range []string{
+		"# TYPE aesgcm_seal_bytes_total counter\n",
+		"aesgcm_auth_failures_total ",
+		`aesgcm_backend_info{backend="` + after.Backend + `"} 1`,
+	} {
+		if !strings.Contains(buf.String(), line) {
+			t.Errorf("Prometheus output lacks %q:\n%s", line, buf.String())
+		}
+	}
+}
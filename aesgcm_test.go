@@ -2,19 +2,30 @@ package aesgcm
 
 import (
 	"bytes"
+	"crypto/aes"
+	"crypto/cipher"
 	"crypto/rand"
 	"errors"
+	"fmt"
 	"io"
 	"testing"
 )
 
-// TestAesGcmDefaultEncryptDecrypt tests basic encryption and decryption cycle
-// using the default key size compiled into the package (expected to be AES-256
-// if no build tags like aes128, aes192, aes512 are used).
-func TestAesGcmDefaultEncryptDecrypt(t *testing.T) {
-	// Determine expected key size based on build
-	expectedKeySize := CompiledKeySize()
-	t.Logf("Testing with compiled key size: %d bytes", expectedKeySize)
+// allKeySizes lists every key size the package accepts, in bytes.
+var allKeySizes = []int{KeySize128, KeySize192, KeySize256, KeySize512}
+
+// TestAesGcmEncryptDecrypt tests basic encryption and decryption cycle
+// for every key size, all served by the same binary.
+func TestAesGcmEncryptDecrypt(t *testing.T) {
+	for _, keySize := range allKeySizes {
+		t.Run(fmt.Sprintf("AES-%d", keySize*8), func(t *testing.T) {
+			testEncryptDecrypt(t, keySize)
+		})
+	}
+}
+
+func testEncryptDecrypt(t *testing.T, expectedKeySize int) {
+	t.Logf("Testing with key size: %d bytes", expectedKeySize)
 
 	// 1. Generate Key
 	key := make([]byte, expectedKeySize)
@@ -27,6 +38,9 @@ func TestAesGcmDefaultEncryptDecrypt(t *testing.T) {
 	if err != nil {
 		t.Fatalf("NewContext failed: %v", err)
 	}
+	if ctx.KeySize() != expectedKeySize {
+		t.Errorf("KeySize() = %d, want %d", ctx.KeySize(), expectedKeySize)
+	}
 	// Note: Finalizer should handle freeing ctx.cCtx
 
 	// 3. Prepare Data
@@ -126,10 +140,158 @@ func TestAesGcmDefaultEncryptDecrypt(t *testing.T) {
 	}
 }
 
-// TODO: Add tests for different key sizes using build tags
-// Example: func TestAesGcm128(t *testing.T) { //go:build aes128 ... }
+// TestAesGcmInvalidKeySize checks that only 16, 24, 32 and 64-byte keys are accepted.
+func TestAesGcmInvalidKeySize(t *testing.T) {
+	for _, n := range []int{0, 1, 15, 17, 31, 33, 48, 63, 65, 128} {
+		if _, err := NewContext(make([]byte, n)); !errors.Is(err, ErrInvalidKeySize) {
+			t.Errorf("NewContext with %d-byte key: got %v, want ErrInvalidKeySize", n, err)
+		}
+	}
+}
+
+// TestAesGcmMatchesStdlib cross-checks the standard key sizes against
+// crypto/cipher's GCM, with several IV lengths (12 bytes and the GHASH path).
+func TestAesGcmMatchesStdlib(t *testing.T) {
+	for _, keySize := range []int{KeySize128, KeySize192, KeySize256} {
+		for _, ivLen := range []int{12, 1, 8, 16, 60} {
+			t.Run(fmt.Sprintf("AES-%d/IV-%d", keySize*8, ivLen), func(t *testing.T) {
+				key := make([]byte, keySize)
+				iv := make([]byte, ivLen)
+				aad := make([]byte, 37)
+				plaintext := make([]byte, 257)
+				for _, b := range [][]byte{key, iv, aad, plaintext} {
+					if _, err := io.ReadFull(rand.Reader, b); err != nil {
+						t.Fatalf("rand: %v", err)
+					}
+				}
 
-// TODO: Add tests for different IV lengths
+				ctx, err := NewContext(key)
+				if err != nil {
+					t.Fatalf("NewContext failed: %v", err)
+				}
+				ciphertext, tag, err := ctx.Encrypt(iv, aad, plaintext)
+				if err != nil {
+					t.Fatalf("Encrypt failed: %v", err)
+				}
+
+				block, err := aes.NewCipher(key)
+				if err != nil {
+					t.Fatalf("aes.NewCipher: %v", err)
+				}
+				gcm, err := cipher.NewGCMWithNonceSize(block, ivLen)
+				if err != nil {
+					t.Fatalf("cipher.NewGCMWithNonceSize: %v", err)
+				}
+				want := gcm.Seal(nil, iv, plaintext, aad)
+				got := append(append([]byte{}, ciphertext...), tag...)
+				if !bytes.Equal(got, want) {
+					t.Fatalf("output mismatch\n got: %x\nwant: %x", got, want)
+				}
+			})
+		}
+	}
+}
+
+// TestAesGcmParallelMatchesSerial checks that the chunked goroutine path
+// produces the same ciphertext and tag as Encrypt, and round-trips.
+func TestAesGcmParallelMatchesSerial(t *testing.T) {
+	for _, keySize := range allKeySizes {
+		for _, size := range []int{0, 1, 15, 16, 17, 64, 1000, 4096 + 3} {
+			for _, chunk := range []int{16, 64, 4096} {
+				t.Run(fmt.Sprintf("AES-%d/%dB/chunk-%d", keySize*8, size, chunk), func(t *testing.T) {
+					key := make([]byte, keySize)
+					plaintext := make([]byte, size)
+					if _, err := io.ReadFull(rand.Reader, plaintext); err != nil {
+						t.Fatalf("rand: %v", err)
+					}
+					ctx, err := NewContext(key)
+					if err != nil {
+						t.Fatalf("NewContext failed: %v", err)
+					}
+					iv, aad := []byte("0123456789ab"), []byte("parallel aad")
+
+					wantCT, wantTag, err := ctx.Encrypt(iv, aad, plaintext)
+					if err != nil {
+						t.Fatalf("Encrypt failed: %v", err)
+					}
+					gotCT := make([]byte, size)
+					gotTag, err := ctx.xcryptParallel(iv, aad, plaintext, gotCT, chunk, true)
+					if err != nil {
+						t.Fatalf("xcryptParallel (encrypt) failed: %v", err)
+					}
+					if !bytes.Equal(gotCT, wantCT) || !bytes.Equal(gotTag, wantTag) {
+						t.Fatalf("parallel output differs from Encrypt")
+					}
+
+					gotPT := make([]byte, size)
+					decTag, err := ctx.xcryptParallel(iv, aad, wantCT, gotPT, chunk, false)
+					if err != nil {
+						t.Fatalf("xcryptParallel (decrypt) failed: %v", err)
+					}
+					if !bytes.Equal(gotPT, plaintext) || !bytes.Equal(decTag, wantTag) {
+						t.Fatalf("parallel decryption mismatch")
+					}
+				})
+			}
+		}
+	}
+
+	// Public entry points, including tag verification.
+	ctx, err := NewContext(make([]byte, KeySize256))
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	plaintext := make([]byte, 2*parallelMinChunk+100)
+	iv := make([]byte, 12)
+	ciphertext, tag, err := ctx.EncryptParallel(iv, nil, plaintext)
+	if err != nil {
+		t.Fatalf("EncryptParallel failed: %v", err)
+	}
+	if pt, err := ctx.Decrypt(iv, nil, ciphertext, tag); err != nil || !bytes.Equal(pt, plaintext) {
+		t.Fatalf("Decrypt of EncryptParallel output failed: %v", err)
+	}
+	if pt, err := ctx.DecryptParallel(iv, nil, ciphertext, tag); err != nil || !bytes.Equal(pt, plaintext) {
+		t.Fatalf("DecryptParallel failed: %v", err)
+	}
+	tag[0] ^= 1
+	if _, err := ctx.DecryptParallel(iv, nil, ciphertext, tag); !errors.Is(err, ErrAuthFailed) {
+		t.Fatalf("DecryptParallel with corrupted tag: got %v, want ErrAuthFailed", err)
+	}
+}
 
 // TODO: Add tests using known test vectors (e.g., from aes.c)
 // Requires parsing hex strings and comparing results.
+
+// TestTruncatedTags checks that EncryptTagSize's tag is the prefix of the full
+// tag, that DecryptTagSize accepts it only at that size, and that Decrypt still
+// requires a full tag.
+func TestTruncatedTags(t *testing.T) {
+	ctx, err := NewContext(make([]byte, KeySize256))
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	iv, aad, plaintext := make([]byte, 12), []byte("radio header"), []byte("frame payload")
+	ciphertext, full, _ := ctx.Encrypt(iv, aad, plaintext)
+	for _, n := range []int{16, 15, 14, 13, 12, 8, 4} {
+		ct, tag, err := ctx.EncryptTagSize(iv, aad, plaintext, n)
+		if err != nil || !bytes.Equal(ct, ciphertext) || !bytes.Equal(tag, full[:n]) {
+			t.Fatalf("EncryptTagSize(%d): tag %x, want %x (err %v)", n, tag, full[:n], err)
+		}
+		if pt, err := ctx.DecryptTagSize(iv, aad, ct, tag, n); err != nil || !bytes.Equal(pt, plaintext) {
+			t.Fatalf("DecryptTagSize(%d): %v", n, err)
+		}
+		tag[n-1] ^= 1
+		if _, err := ctx.DecryptTagSize(iv, aad, ct, tag, n); err != ErrAuthFailed {
+			t.Fatalf("DecryptTagSize(%d) of a bad tag: got %v, want ErrAuthFailed", n, err)
+		}
+	}
+	if _, err := ctx.DecryptTagSize(iv, aad, ciphertext, full[:8], 12); err != ErrInvalidTagSize {
+		t.Fatalf("8-byte tag at size 12: got %v, want ErrInvalidTagSize", err)
+	}
+	if _, _, err := ctx.EncryptTagSize(iv, aad, plaintext, 10); err != ErrInvalidTagSize {
+		t.Fatalf("EncryptTagSize(10): got %v, want ErrInvalidTagSize", err)
+	}
+	if _, err := ctx.Decrypt(iv, aad, ciphertext, full[:12]); err == nil {
+		t.Fatal("Decrypt accepted a 12-byte tag")
+	}
+}
@@ -0,0 +1,41 @@
+package aesgcm
+
+/*
+#cgo CFLAGS: -Wall -Werror
+#include "aes.h"
+*/
+import "C"
+import (
+	"runtime"
+	"unsafe"
+)
+
+// Verify checks that tag authenticates ciphertext and aad under iv without
+// decrypting: it runs GHASH and one block encryption, no CTR pass, and needs
+// no output buffer. It returns nil if Decrypt would succeed and ErrAuthFailed
+// if the tag does not match.
+func (ctx *Context) Verify(iv, aad, ciphertext, tag []byte) error {
+	if ctx == nil || ctx.cCtx == nil || len(iv) == 0 || len(tag) != TagSize {
+		return ErrInvalidArguments
+	}
+	var aadPtr *C.uint8_t
+	if len(aad) > 0 {
+		aadPtr = (*C.uint8_t)(unsafe.Pointer(&aad[0]))
+	}
+	var ctPtr *C.uint8_t
+	if len(ciphertext) > 0 {
+		ctPtr = (*C.uint8_t)(unsafe.Pointer(&ciphertext[0]))
+	}
+	ivPtr := (*C.uint8_t)(unsafe.Pointer(&iv[0]))
+	tagPtr := (*C.uint8_t)(unsafe.Pointer(&tag[0]))
+	ret := C.AES_GCM_verify(ctx.cCtx, ivPtr, C.size_t(len(iv)), aadPtr, C.size_t(len(aad)),
+		ctPtr, C.size_t(len(ciphertext)), tagPtr)
+	runtime.KeepAlive(ctx)
+	switch ret {
+	case 0:
+		return nil
+	case -3:
+		return ErrAuthFailed
+	}
+	return ErrInvalidArguments
+}
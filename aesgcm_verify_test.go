@@ -0,0 +1,56 @@
+package aesgcm
+
+import (
+	"crypto/aes"
+	"crypto/cipher"
+	"fmt"
+	"testing"
+)
+
+// TestVerify checks Verify against messages sealed by crypto/cipher, and that
+// a changed ciphertext, AAD or tag byte is rejected.
+func TestVerify(t *testing.T) {
+	key := make([]byte, KeySize256)
+	for i := range key {
+		key[i] = byte(i * 5)
+	}
+	ctx, err := NewContext(key)
+	if err != nil {
+		t.Fatalf("NewContext failed: %v", err)
+	}
+	block, _ := aes.NewCipher(key)
+	gcm, _ := cipher.NewGCM(block)
+	for _, n := range []int{0, 1, 16, 63, 64, 65, 1000} {
+		t.Run(fmt.Sprint(n), func(t *testing.T) {
+			iv, aad, pt := make([]byte, 12), []byte("archive segment"), make([]byte, n)
+			for i := range pt {
+				pt[i] = byte(i * 3)
+			}
+			iv[0] = byte(n)
+			sealed := gcm.Seal(nil, iv, pt, aad)
+			ct, tag := sealed[:n], sealed[n:]
+			if err := ctx.Verify(iv, aad, ct, tag); err != nil {
+				t.Fatalf("Verify of a good message: %v", err)
+			}
+			tag[0] ^= 1
+			if err := ctx.Verify(iv, aad, ct, tag); err != ErrAuthFailed {
+				t.Fatalf("Verify of a bad tag: got %v, want ErrAuthFailed", err)
+			}
+			tag[0] ^= 1
+			aad[0] ^= 1
+			if err := ctx.Verify(iv, aad, ct, tag); err != ErrAuthFailed {
+				t.Fatalf("Verify with bad AAD: got %v, want ErrAuthFailed", err)
+			}
+			aad[0] ^= 1
+			if n > 0 {
+				ct[n-1] ^= 1
+				if err := ctx.Verify(iv, aad, ct, tag); err != ErrAuthFailed {
+					t.Fatalf("Verify of a bad ciphertext: got %v, want ErrAuthFailed", err)
+				}
+			}
+			if err := ctx.Verify(iv, aad, ct, tag[:12]); err != ErrInvalidArguments {
+				t.Fatalf("Verify of a short tag: got %v, want ErrInvalidArguments", err)
+			}
+		})
+	}
+}
@@ -0,0 +1,177 @@
+// Reactor tail-latency benchmark for aes::worker_pool.
+//
+// A single-threaded reactor serves a 1 kHz timer and, every few ticks, seals a
+// large message from a coroutine. The lateness of each timer tick is recorded
+// with the seal run inline on the reactor ("inline") and offloaded with
+// co_await gcm.async_seal ("offload"), which resumes the coroutine back on the
+// reactor through worker_pool::options::resume.
+//
+//   aes_async_latency [seconds-per-mode] [message-bytes] [worker-threads]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "aes.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct detached {
+  struct promise_type {
+    detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+// Timer plus a run queue of coroutines posted from other threads.
+class reactor {
+public:
+  void post(std::coroutine_handle<> h) {
+    {
+      std::lock_guard lock(mu_);
+      ready_.push_back(h);
+    }
+    cv_.notify_one();
+  }
+
+  // Runs until end, calling on_tick for every period and recording how late
+  // each tick was dispatched. Periods that pass entirely while the loop is
+  // blocked are coalesced into the next tick and counted in missed, like
+  // timerfd overruns.
+  template <class OnTick>
+  std::vector<double> run(clock_type::time_point end, clock_type::duration period, OnTick on_tick) {
+    std::vector<double> lateness_us;
+    clock_type::time_point next = clock_type::now() + period;
+    while (next < end) {
+      std::deque<std::coroutine_handle<>> batch;
+      {
+        std::unique_lock lock(mu_);
+        cv_.wait_until(lock, next, [this] { return !ready_.empty(); });
+        batch.swap(ready_);
+      }
+      for (auto h : batch) {
+        h.resume();
+      }
+      const auto now = clock_type::now();
+      if (now >= next) {
+        lateness_us.push_back(std::chrono::duration<double, std::micro>(now - next).count());
+        const auto overrun = (now - next) / period; // Periods lost while blocked
+        missed += static_cast<std::size_t>(overrun);
+        next += (overrun + 1) * period;
+        on_tick();
+      }
+    }
+    // Let outstanding seals finish before the caller tears down buffers.
+    while (pending > 0) {
+      std::unique_lock lock(mu_);
+      cv_.wait(lock, [this] { return !ready_.empty(); });
+      auto batch = std::move(ready_);
+      ready_.clear();
+      lock.unlock();
+      for (auto h : batch) {
+        h.resume();
+      }
+    }
+    return lateness_us;
+  }
+
+  int pending = 0; // Offloaded seals not yet resumed (reactor thread only)
+  std::size_t missed = 0;
+
+private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::coroutine_handle<>> ready_;
+};
+
+struct message {
+  std::vector<std::byte> pt, ct;
+  std::array<std::byte, aes::tag_size> tag{};
+  std::array<std::byte, aes::iv_size> iv{};
+};
+
+detached seal_inline(const aes::gcm256& gcm, message& m) {
+  gcm.seal(m.iv, {}, m.pt, m.ct, m.tag);
+  co_return;
+}
+
+detached seal_offload(const aes::gcm256& gcm, aes::worker_pool& pool, reactor& r, message& m) {
+  ++r.pending;
+  co_await gcm.async_seal(pool, m.iv, {}, m.pt, m.ct, m.tag);
+  --r.pending; // Back on the reactor thread
+}
+
+double percentile(std::vector<double>& v, double p) {
+  if (v.empty()) {
+    return 0;
+  }
+  std::size_t i = std::min(v.size() - 1, static_cast<std::size_t>(p / 100.0 * v.size()));
+  std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(i), v.end());
+  return v[i];
+}
+
+void report(const char* mode, std::vector<double> lateness, std::size_t missed, unsigned seals) {
+  std::printf("%-8s ticks=%-6zu missed=%-6zu seals=%-5u p50=%9.1fus p99=%9.1fus p99.9=%9.1fus max=%9.1fus\n", mode,
+              lateness.size(), missed, seals, percentile(lateness, 50), percentile(lateness, 99),
+              percentile(lateness, 99.9), percentile(lateness, 100));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+  const std::size_t size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8u << 20;
+  const unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0;
+  constexpr auto period = std::chrono::milliseconds(1);
+  constexpr unsigned seal_every = 20; // ticks between seals
+
+  std::array<std::byte, 32> key{};
+  const aes::gcm256 gcm(key);
+  message m;
+  m.pt.resize(size, std::byte{0x5a});
+  m.ct.resize(size);
+
+  std::printf("AES-256-GCM, %zu-byte message every %u ms, %.1f s per mode\n", size, seal_every, seconds);
+  const auto duration = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(seconds));
+
+  {
+    reactor r;
+    unsigned ticks = 0, seals = 0;
+    auto lat = r.run(clock_type::now() + duration, period, [&] {
+      if (++ticks % seal_every == 0) {
+        ++seals;
+        seal_inline(gcm, m);
+      }
+    });
+    report("inline", std::move(lat), r.missed, seals);
+  }
+
+  {
+    reactor r;
+    aes::worker_pool::options opts;
+    opts.threads = threads;
+    opts.resume = [&r](std::coroutine_handle<> h) { r.post(h); };
+    aes::worker_pool pool(opts);
+    unsigned ticks = 0, seals = 0;
+    auto lat = r.run(clock_type::now() + duration, period, [&] {
+      if (++ticks % seal_every == 0 && r.pending == 0) { // One message buffer in flight
+        ++seals;
+        seal_offload(gcm, pool, r, m);
+      }
+    });
+    report("offload", std::move(lat), r.missed, seals);
+  }
+  return 0;
+}
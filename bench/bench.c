@@ -0,0 +1,427 @@
+// Throughput benchmark for the C library.
+//
+// Measures AES_GCM_encrypt/AES_GCM_decrypt/AES_GCM_verify, AES_GMAC, the key schedule, the CTR kernel
+// alone (for AES-512 on VAES CPUs also the AES-NI kernel it replaces, as
+// ctr_aesni; and the same blocks through one cipher call each, or through one
+// AES_encrypt_blocks call as encrypt_blocks) and GHASH alone (internally, and
+// through the public AES_GHASH_* API as ghash_stream)
+// across message sizes, key sizes and IV lengths, and
+// reports ns/op, ops/s, GB/s and cycles/byte in a table or as JSON.
+//
+// aes.c is compiled into this file so that the internal kernels (KeyExpansion,
+// CTR, GHASH) can be timed on their own. The backend is whatever the build
+// flags select; the Makefile builds one binary per backend (make bench).
+//
+// Usage: aes_gcm_bench [--json] [--min-time=SECONDS] [--max-size=BYTES]
+//                      [--keys=128,192,256,512] [--only=NAME[,NAME...]]
+//                      [--cycles=auto|perf|rdtsc|none]
+#define _GNU_SOURCE
+#include "aes.c"
+
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// --- Backend / cycle counter ---
+
+static const char* bench_cipher_backend(void) {
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AES__)
+    return "aesni";
+#else
+    return "portable";
+#endif
+}
+
+static const char* bench_ghash_backend(void) {
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(AES_HAVE_PCLMUL) && defined(__SSE2__)
+    return "pclmul";
+#else
+    return "portable";
+#endif
+}
+
+enum cycle_source { CYCLES_NONE, CYCLES_PERF, CYCLES_RDTSC };
+static const char* const cycle_source_names[] = { "none", "perf", "rdtsc" };
+static enum cycle_source cycles_src = CYCLES_NONE;
+static int perf_fd = -1;
+
+// Core cycles from perf_event_open(2) where permitted; the TSC (reference
+// cycles, i.e. not scaled by turbo/frequency changes) otherwise.
+static void cycles_init(const char* want) {
+    int auto_mode = strcmp(want, "auto") == 0;
+#if defined(__linux__) && defined(__NR_perf_event_open)
+    if (auto_mode || strcmp(want, "perf") == 0) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        perf_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (perf_fd >= 0) {
+            cycles_src = CYCLES_PERF;
+            return;
+        }
+    }
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+    if (auto_mode || strcmp(want, "rdtsc") == 0) {
+        cycles_src = CYCLES_RDTSC;
+        return;
+    }
+#endif
+    (void)auto_mode;
+    cycles_src = CYCLES_NONE;
+}
+
+static uint64_t cycles_now(void) {
+    switch (cycles_src) {
+#if defined(__linux__)
+    case CYCLES_PERF: {
+        uint64_t v = 0;
+        if (read(perf_fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) {
+            return 0;
+        }
+        return v;
+    }
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+    case CYCLES_RDTSC:
+        return __rdtsc();
+#endif
+    default:
+        return 0;
+    }
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// --- Benchmarked operations ---
+
+struct bench_case {
+    const char* name;
+    unsigned key_bits;
+    size_t iv_len;
+    size_t size; // Bytes processed per op (0 for key expansion)
+    struct AES_ctx ctx;
+    uint8_t key[64];
+    uint8_t iv[16];
+    uint8_t tag[AES_GCM_TAG_LEN];
+    uint8_t* in;
+    uint8_t* out;
+};
+
+typedef void (*bench_fn)(struct bench_case* c);
+
+static void op_gcm_encrypt(struct bench_case* c) {
+    AES_GCM_encrypt(&c->ctx, c->iv, c->iv_len, NULL, 0, c->in, c->out, c->size, c->tag);
+}
+
+static void op_gcm_decrypt(struct bench_case* c) {
+    // c->in holds a valid ciphertext/tag pair (prepared in main)
+    if (AES_GCM_decrypt(&c->ctx, c->iv, c->iv_len, NULL, 0, c->in, c->out, c->size, c->tag) != 0) {
+        fprintf(stderr, "gcm_decrypt: authentication failed\n");
+        exit(1);
+    }
+}
+
+static void op_gcm_verify(struct bench_case* c) {
+    if (AES_GCM_verify(&c->ctx, c->iv, c->iv_len, NULL, 0, c->in, c->size, c->tag) != 0) {
+        fprintf(stderr, "gcm_verify: authentication failed\n");
+        exit(1);
+    }
+}
+
+static void op_gmac(struct bench_case* c) {
+    AES_GMAC(&c->ctx, c->iv, c->iv_len, c->in, c->size, c->tag);
+}
+
+static void op_key_expansion(struct bench_case* c) {
+    KeyExpansion(c->ctx.RoundKey, c->key, c->key_bits / 32, c->ctx.Nr);
+}
+
+static void op_ctr(struct bench_case* c) {
+    uint8_t counter[AES_BLOCKLEN];
+    memcpy(counter, c->ctx.H, AES_BLOCKLEN);
+    kernels_for(&c->ctx)->ctr_xcrypt(c->ctx.RoundKey, counter, c->out, c->size);
+}
+
+// The AES-512 CTR kernel that run-time dispatch passes over on VAES CPUs (the
+// AES-NI one), timed next to ctr; NULL where dispatch has no alternative.
+static const struct aes_kernels* ctr_aesni_kernels(const struct AES_ctx* ctx) {
+#if defined(AES512) && (AES512 == 1) && defined(AES_VAES) && AES_VAES
+    if (ctx->Nr == 22 && kernels_for(ctx) != &kernels512) {
+        return &kernels512;
+    }
+#endif
+    (void)ctx;
+    return NULL;
+}
+
+static void op_ctr_aesni(struct bench_case* c) {
+    uint8_t counter[AES_BLOCKLEN];
+    memcpy(counter, c->ctx.H, AES_BLOCKLEN);
+    ctr_aesni_kernels(&c->ctx)->ctr_xcrypt(c->ctx.RoundKey, counter, c->out, c->size);
+}
+
+// The CTR work done as one cipher call per block, as callers of a
+// single-block API would: the schedule is reloaded on every call and only one
+// block is in flight. Compare with ctr, most of all for AES-512.
+static void op_cipher_blocks(struct bench_case* c) {
+    const struct aes_kernels* k = kernels_for(&c->ctx);
+    for (size_t off = 0; off + AES_BLOCKLEN <= c->size; off += AES_BLOCKLEN) {
+        k->cipher((state_t*)(c->out + off), c->ctx.RoundKey);
+    }
+}
+
+static void op_encrypt_blocks(struct bench_case* c) {
+    AES_encrypt_blocks(&c->ctx, c->out, c->out, c->size / AES_BLOCKLEN);
+}
+
+static void op_ghash(struct bench_case* c) {
+    ghash_update_ctx(c->tag, &c->ctx, c->in, c->size);
+}
+
+// The public API per message: init (H^2..H^4) + update + final.
+static void op_ghash_stream(struct bench_case* c) {
+    struct AES_GHASH_ctx g;
+    AES_GHASH_init(&g, c->ctx.H);
+    AES_GHASH_update(&g, c->in, c->size);
+    AES_GHASH_final(&g, c->tag);
+}
+
+// --- Runner ---
+
+static double min_time = 0.1;
+static int json = 0;
+static int results = 0;
+
+static void report(const struct bench_case* c, uint64_t iters, double secs, uint64_t cycles) {
+    double ns_per_op = secs * 1e9 / (double)iters;
+    double ops_per_s = (double)iters / secs;
+    double gb_per_s = c->size ? (double)c->size * ops_per_s / 1e9 : 0.0;
+    double cyc_per_op = cycles_src != CYCLES_NONE ? (double)cycles / (double)iters : 0.0;
+    double cyc_per_byte = c->size ? cyc_per_op / (double)c->size : 0.0;
+
+    if (json) {
+        printf("%s\n    {\"bench\": \"%s\", \"key_bits\": %u, \"iv_len\": %zu, \"size\": %zu, "
+               "\"iterations\": %llu, \"ns_per_op\": %.2f, \"ops_per_s\": %.1f, \"gb_per_s\": %.4f, "
+               "\"cycles_per_op\": %.1f, \"cycles_per_byte\": %.3f}",
+               results ? "," : "", c->name, c->key_bits, c->iv_len, c->size, (unsigned long long)iters,
+               ns_per_op, ops_per_s, gb_per_s, cyc_per_op, cyc_per_byte);
+    } else {
+        char iv_col[24] = "-";
+        if (c->iv_len) {
+            snprintf(iv_col, sizeof(iv_col), "%zu", c->iv_len);
+        }
+        printf("%-14s %5u %4s %10zu %14.1f %12.1f %10.3f %10.2f\n", c->name, c->key_bits, iv_col, c->size,
+               ns_per_op, ops_per_s, gb_per_s, cyc_per_byte ? cyc_per_byte : cyc_per_op);
+    }
+    fflush(stdout);
+    ++results;
+}
+
+// Runs fn in growing batches until min_time has elapsed, after one warmup call.
+static void run(struct bench_case* c, bench_fn fn) {
+    uint64_t iters = 0, batch = 1, i;
+    uint64_t c0;
+    double t0, elapsed;
+
+    fn(c); // Warmup: page in buffers, train predictors
+    t0 = now_sec();
+    c0 = cycles_now();
+    do {
+        for (i = 0; i < batch; ++i) {
+            fn(c);
+        }
+        iters += batch;
+        batch *= 2;
+        elapsed = now_sec() - t0;
+    } while (elapsed < min_time);
+    report(c, iters, elapsed, cycles_now() - c0);
+}
+
+static int setup_key(struct bench_case* c, unsigned key_bits) {
+    size_t i;
+    c->key_bits = key_bits;
+    for (i = 0; i < sizeof(c->key); ++i) {
+        c->key[i] = (uint8_t)(i * 7 + 1);
+    }
+    for (i = 0; i < sizeof(c->iv); ++i) {
+        c->iv[i] = (uint8_t)(0xa0 + i);
+    }
+    return AES_init_ctx_keylen(&c->ctx, c->key, key_bits / 8);
+}
+
+static int selected(const char* only, const char* name) {
+    size_t n = strlen(name);
+    const char* p = only;
+    if (only == NULL) {
+        return 1;
+    }
+    while ((p = strstr(p, name)) != NULL) {
+        if ((p == only || p[-1] == ',') && (p[n] == '\0' || p[n] == ',')) {
+            return 1;
+        }
+        p += n;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    static const size_t sizes[] = { 16, 64, 256, 1024, 4096, 16384, 65536, 1u << 20, 16u << 20, 64u << 20 };
+    static const size_t iv_lens[] = { AES_GCM_IV_LEN, 16 };
+    unsigned key_bits_list[4] = { 128, 192, 256, 512 };
+    size_t n_keys = 4, max_size = 64u << 20, si, ki, vi, i;
+    const char* only = NULL;
+    const char* cycles_mode = "auto";
+    struct bench_case c;
+    uint8_t *in, *out;
+    int a;
+
+    for (a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "--json") == 0) {
+            json = 1;
+        } else if (strncmp(argv[a], "--min-time=", 11) == 0) {
+            min_time = atof(argv[a] + 11);
+        } else if (strncmp(argv[a], "--max-size=", 11) == 0) {
+            max_size = (size_t)strtoull(argv[a] + 11, NULL, 10);
+        } else if (strncmp(argv[a], "--only=", 7) == 0) {
+            only = argv[a] + 7;
+        } else if (strncmp(argv[a], "--cycles=", 9) == 0) {
+            cycles_mode = argv[a] + 9;
+        } else if (strncmp(argv[a], "--keys=", 7) == 0) {
+            char* p = argv[a] + 7;
+            for (n_keys = 0; *p && n_keys < 4; ++n_keys) {
+                key_bits_list[n_keys] = (unsigned)strtoul(p, &p, 10);
+                if (*p == ',') {
+                    ++p;
+                }
+            }
+        } else {
+            fprintf(stderr, "usage: %s [--json] [--min-time=SECONDS] [--max-size=BYTES] [--keys=128,...]\n"
+                            "       [--only=gcm_encrypt,gcm_decrypt,gcm_verify,key_expansion,ctr,ctr_aesni,cipher_blocks,encrypt_blocks,ghash,ghash_stream,gmac] [--cycles=auto|perf|rdtsc|none]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    cycles_init(cycles_mode);
+
+    in = (uint8_t*)malloc(max_size ? max_size : 1);
+    out = (uint8_t*)malloc(max_size ? max_size : 1);
+    if (!in || !out) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (i = 0; i < max_size; ++i) {
+        in[i] = (uint8_t)i;
+    }
+    memset(out, 0, max_size);
+    memset(&c, 0, sizeof(c));
+    c.in = in;
+    c.out = out;
+
+    if (json) {
+        printf("{\n  \"cipher_backend\": \"%s\",\n  \"ghash_backend\": \"%s\",\n  \"cycle_source\": \"%s\",\n"
+               "  \"min_time\": %.3f,\n  \"results\": [",
+               bench_cipher_backend(), bench_ghash_backend(), cycle_source_names[cycles_src], min_time);
+    } else {
+        printf("backend: cipher=%s ghash=%s, cycles: %s (last column is cycles/op for key_expansion)\n",
+               bench_cipher_backend(), bench_ghash_backend(), cycle_source_names[cycles_src]);
+        printf("%-14s %5s %4s %10s %14s %12s %10s %10s\n", "bench", "key", "iv", "bytes", "ns/op", "ops/s",
+               "GB/s", "cyc/B");
+    }
+
+    for (ki = 0; ki < n_keys; ++ki) {
+        if (setup_key(&c, key_bits_list[ki]) != 0) {
+            fprintf(stderr, "skipping %u-bit keys (not compiled in)\n", key_bits_list[ki]);
+            continue;
+        }
+
+        if (selected(only, "key_expansion")) {
+            c.name = "key_expansion";
+            c.iv_len = 0;
+            c.size = 0;
+            run(&c, op_key_expansion);
+        }
+
+        for (si = 0; si < sizeof(sizes) / sizeof(sizes[0]) && sizes[si] <= max_size; ++si) {
+            c.size = sizes[si];
+            c.iv_len = 0;
+            if (selected(only, "ctr")) {
+                c.name = "ctr";
+                run(&c, op_ctr);
+            }
+            if (selected(only, "ctr_aesni") && ctr_aesni_kernels(&c.ctx) != NULL) {
+                c.name = "ctr_aesni";
+                run(&c, op_ctr_aesni);
+            }
+            if (selected(only, "cipher_blocks")) {
+                c.name = "cipher_blocks";
+                run(&c, op_cipher_blocks);
+            }
+            if (selected(only, "encrypt_blocks")) {
+                c.name = "encrypt_blocks";
+                run(&c, op_encrypt_blocks);
+            }
+            if (selected(only, "gmac")) {
+                c.name = "gmac";
+                c.iv_len = AES_GCM_IV_LEN;
+                run(&c, op_gmac);
+                c.iv_len = 0;
+            }
+            if (selected(only, "ghash") && ki == 0) { // GHASH does not depend on the key size
+                c.name = "ghash";
+                run(&c, op_ghash);
+            }
+            if (selected(only, "ghash_stream") && ki == 0) {
+                c.name = "ghash_stream";
+                run(&c, op_ghash_stream);
+            }
+            for (vi = 0; vi < sizeof(iv_lens) / sizeof(iv_lens[0]); ++vi) {
+                c.iv_len = iv_lens[vi];
+                if (selected(only, "gcm_encrypt")) {
+                    c.name = "gcm_encrypt";
+                    run(&c, op_gcm_encrypt);
+                }
+                if (selected(only, "gcm_decrypt")) {
+                    // Decrypt a valid message: encrypt into out, then swap roles
+                    c.name = "gcm_decrypt";
+                    op_gcm_encrypt(&c);
+                    c.in = out;
+                    c.out = in;
+                    run(&c, op_gcm_decrypt);
+                    c.in = in;
+                    c.out = out;
+                }
+                if (selected(only, "gcm_verify")) {
+                    c.name = "gcm_verify";
+                    op_gcm_encrypt(&c);
+                    c.in = out;
+                    run(&c, op_gcm_verify);
+                    c.in = in;
+                }
+            }
+        }
+    }
+
+    if (json) {
+        printf("\n  ]\n}\n");
+    }
+    free(in);
+    free(out);
+    return 0;
+}
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""Throughput regression check for the C benchmarks (bench/bench.c).
+
+Runs one or more aes_gcm_bench binaries several times with --json, pinned to
+one CPU and after a discarded warmup run, and keeps the median throughput of
+every (backend, bench, key_bits, iv_len, size) case.
+
+  regress.py record BASELINE BENCH...   write the medians to BASELINE
+  regress.py check  BASELINE BENCH...   compare against BASELINE; exit 1 if
+                                        any case regressed
+
+A case regresses when even its best repeat is slower than the baseline median
+by more than the threshold, so a single noisy run cannot fail the check.
+Baselines are only meaningful on the machine that recorded them; check warns
+when the CPU differs. Cases or backends missing from the baseline are reported
+and skipped; run `make bench-baseline` after an intended performance change.
+"""
+
+import argparse
+import json
+import os
+import platform
+import statistics
+import subprocess
+import sys
+
+SCHEMA = 1
+DEFAULT_ARGS = ["--min-time=0.05", "--max-size=65536", "--only=gcm_encrypt,ctr,ghash,key_expansion"]
+
+
+def cpu_model():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or platform.machine()
+
+
+def pin(cpu):
+    if cpu is None or not hasattr(os, "sched_setaffinity"):
+        return None
+    available = sorted(os.sched_getaffinity(0))
+    if cpu < 0:
+        cpu = available[-1]  # Away from CPU 0, which takes most interrupts
+    os.sched_setaffinity(0, {cpu})  # Inherited by the benchmark processes
+    return cpu
+
+
+def case_key(result):
+    return "{bench}/{key_bits}/iv{iv_len}/{size}".format(**result)
+
+
+def throughput(result):
+    # GB/s from ns/op, which the benchmark prints with more significant digits
+    # than gb_per_s. Key expansion processes no bytes; it is compared in ops/s.
+    if result["size"]:
+        return result["size"] / result["ns_per_op"]
+    return 1e9 / result["ns_per_op"]
+
+
+def run_once(binary, bench_args):
+    out = subprocess.run([binary, "--json"] + bench_args, check=True, stdout=subprocess.PIPE).stdout
+    doc = json.loads(out)
+    backend = "{}+{}".format(doc["cipher_backend"], doc["ghash_backend"])
+    return backend, {case_key(r): throughput(r) for r in doc["results"]}
+
+
+def measure(binary, bench_args, repeats, warmup):
+    """Returns (backend, {case: [throughput per repeat]})."""
+    for _ in range(warmup):
+        run_once(binary, bench_args)
+    backend, samples = None, {}
+    for i in range(repeats):
+        backend, results = run_once(binary, bench_args)
+        for key, value in results.items():
+            samples.setdefault(key, []).append(value)
+        print("  {}: run {}/{} done".format(os.path.basename(binary), i + 1, repeats), file=sys.stderr)
+    return backend, samples
+
+
+def record(args, bench_args):
+    baseline = {
+        "schema": SCHEMA,
+        "cpu": cpu_model(),
+        "bench_args": bench_args,
+        "repeats": args.repeats,
+        "threshold": args.threshold,
+        "unit": "GB/s (ops/s for key_expansion), median of repeats",
+        "backends": {},
+    }
+    for binary in args.bench:
+        backend, samples = measure(binary, bench_args, args.repeats, args.warmup)
+        baseline["backends"][backend] = {k: float("{:.6g}".format(statistics.median(v))) for k, v in sorted(samples.items())}
+    with open(args.baseline, "w") as f:
+        json.dump(baseline, f, indent=2, sort_keys=False)
+        f.write("\n")
+    print("wrote {} ({} backends)".format(args.baseline, len(baseline["backends"])))
+    return 0
+
+
+def check(args, bench_args):
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if baseline.get("schema") != SCHEMA:
+        print("{}: schema {} is not supported (expected {}); re-record it".format(
+            args.baseline, baseline.get("schema"), SCHEMA), file=sys.stderr)
+        return 2
+    threshold = args.threshold if args.threshold is not None else baseline.get("threshold", 0.15)
+    if baseline.get("cpu") != cpu_model():
+        print("warning: baseline was recorded on '{}', this is '{}'".format(baseline.get("cpu"), cpu_model()))
+    bench_args = baseline.get("bench_args", bench_args) if not args.bench_args else bench_args
+
+    regressions = 0
+    print("{:<20} {:<40} {:>10} {:>10} {:>10} {:>8}".format("backend", "case", "baseline", "median", "best", "change"))
+    for binary in args.bench:
+        backend, samples = measure(binary, bench_args, args.repeats, args.warmup)
+        expected = baseline["backends"].get(backend)
+        if expected is None:
+            print("{:<20} not in baseline, skipped".format(backend))
+            continue
+        for key in sorted(samples):
+            if key not in expected:
+                print("{:<20} {:<40} {:>10} (new case)".format(backend, key, "-"))
+                continue
+            base = expected[key]
+            median, best = statistics.median(samples[key]), max(samples[key])
+            change = median / base - 1.0 if base else 0.0
+            failed = best < base * (1.0 - threshold)
+            regressions += failed
+            print("{:<20} {:<40} {:>10.4g} {:>10.4g} {:>10.4g} {:>+7.1%}{}".format(
+                backend, key, base, median, best, change, "  REGRESSION" if failed else ""))
+        for key in sorted(set(expected) - set(samples)):
+            print("{:<20} {:<40} missing from this run".format(backend, key))
+
+    if regressions:
+        print("{} case(s) regressed by more than {:.0%}".format(regressions, threshold))
+        return 1
+    print("no regressions beyond {:.0%}".format(threshold))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("mode", choices=["record", "check"])
+    parser.add_argument("baseline", help="baseline JSON file")
+    parser.add_argument("bench", nargs="+", help="aes_gcm_bench binaries to run")
+    parser.add_argument("--repeats", type=int, default=5, help="measured runs per binary (default 5)")
+    parser.add_argument("--warmup", type=int, default=1, help="discarded runs per binary (default 1)")
+    parser.add_argument("--threshold", type=float, default=None,
+                        help="allowed slowdown as a fraction (default: the baseline's, else 0.15)")
+    parser.add_argument("--cpu", type=int, default=-1,
+                        help="CPU to pin to (default: the highest available)")
+    parser.add_argument("--no-pin", action="store_true", help="do not pin to a CPU")
+    parser.add_argument("--bench-args", default=None,
+                        help="arguments passed to the binaries (default: the baseline's, else '{}')".format(
+                            " ".join(DEFAULT_ARGS)))
+    args = parser.parse_args()
+
+    bench_args = args.bench_args.split() if args.bench_args else list(DEFAULT_ARGS)
+    cpu = pin(None if args.no_pin else args.cpu)
+    print("pinned to CPU {}".format(cpu) if cpu is not None else "not pinned", file=sys.stderr)
+    if args.mode == "record":
+        if args.threshold is None:
+            args.threshold = 0.15
+        return record(args, bench_args)
+    return check(args, bench_args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
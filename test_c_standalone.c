@@ -10,6 +10,9 @@
 #define ECB 1
 
 #include "aes.h"
+#include "aes_seg.h"
+#include "aes_nonce.h"
+#include "aes_keycache.h"
 
 // Helper function to print buffer in hex
 static void print_hex(const char* label, const uint8_t* buf, size_t len) {
@@ -25,7 +28,7 @@ typedef struct {
     const char* name;
     int key_len; // In bytes (16, 24, 32, 64)
     const uint8_t* key;
-    int iv_len; // In bytes (only 12 supported by this impl)
+    int iv_len; // In bytes (12 uses the fast path, others are hashed into J0)
     const uint8_t* iv;
     int pt_len;
     const uint8_t* pt;
@@ -35,54 +38,75 @@ typedef struct {
     const uint8_t* expected_tag;
 } gcm_test_vector_t;
 
-// --- NIST SP 800-38D Appendix B Test Vectors ---
-
-// B.1 - AES-128 Test Case 2
-const uint8_t key_128_b1[] = { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 };
-const uint8_t iv_128_b1[]  = { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 };
-const uint8_t pt_128_b1[]  = { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 };
-const uint8_t ct_128_b1[]  = { 0x03,0x88,0xda,0xce,0x60,0xb6,0xa3,0x92,0xf3,0x28,0xc2,0xb9,0x71,0xb2,0xfe,0x78 };
-const uint8_t tag_128_b1[] = { 0xab,0x6e,0x47,0xd4,0x2c,0xec,0x13,0xbd,0xf5,0x3a,0x67,0xb2,0x12,0x57,0xbd,0xdf };
-
-// B.2 - AES-128 Test Case 4
-const uint8_t key_128_b2[] = { 0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08 };
-const uint8_t iv_128_b2[]  = { 0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88 };
-const uint8_t pt_128_b2[]  = {
-    0xd9,0xa3,0x21,0x16,0x8e,0x21,0x0e,0x88,0xa3,0x0a,0x8a,0x54,0x97,0x40,0xe3,0x00,
-    0x3d,0x80,0xaa,0x4c,0x77,0x0b,0x57,0x0e,0xc6,0xc7,0x55,0x5a,0xac,0x2f,0x09,0x98,
-    0x3c,0x77,0x00,0x4f,0x74,0xd2,0x82,0x94,0x3b,0xd1,0x87,0x0a,0xd3,0x8e,0x0f,0xd2,
-    0xa0,0x02,0x64,0xc5,0x82,0x97,0x40,0xca,0x7a,0x4c,0xc1,0xe8,0xa5,0xe4,0xe8,0x00
+// --- GCM Specification Test Vectors (McGrew & Viega, as used in NIST SP 800-38D validation) ---
+
+// Test Case 2 - AES-128, zero key/IV, one block, no AAD
+const uint8_t key_128_tc2[] = { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 };
+const uint8_t iv_128_tc2[]  = { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 };
+const uint8_t pt_128_tc2[]  = { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 };
+const uint8_t ct_128_tc2[]  = { 0x03,0x88,0xda,0xce,0x60,0xb6,0xa3,0x92,0xf3,0x28,0xc2,0xb9,0x71,0xb2,0xfe,0x78 };
+const uint8_t tag_128_tc2[] = { 0xab,0x6e,0x47,0xd4,0x2c,0xec,0x13,0xbd,0xf5,0x3a,0x67,0xb2,0x12,0x57,0xbd,0xdf };
+
+// Plaintext, AAD and key material shared by Test Cases 4, 6, 10 and 16
+const uint8_t key_tc[] = {
+    0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08,
+    0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08
+}; // The 128/192/256-bit keys are the first 16/24/32 bytes
+const uint8_t iv_tc[]  = { 0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88 };
+const uint8_t pt_tc[]  = {
+    0xd9,0x31,0x32,0x25,0xf8,0x84,0x06,0xe5,0xa5,0x59,0x09,0xc5,0xaf,0xf5,0x26,0x9a,
+    0x86,0xa7,0xa9,0x53,0x15,0x34,0xf7,0xda,0x2e,0x4c,0x30,0x3d,0x8a,0x31,0x8a,0x72,
+    0x1c,0x3c,0x0c,0x95,0x95,0x68,0x09,0x53,0x2f,0xcf,0x0e,0x24,0x49,0xa6,0xb5,0x25,
+    0xb1,0x6a,0xed,0xf5,0xaa,0x0d,0xe6,0x57,0xba,0x63,0x7b,0x39
 };
-const uint8_t aad_128_b2[] = { 0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xab,0xad,0xda,0xd2 };
-const uint8_t ct_128_b2[]  = {
+const uint8_t aad_tc[] = { 0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xab,0xad,0xda,0xd2 };
+
+// Test Case 4 - AES-128
+const uint8_t ct_128_tc4[]  = {
     0x42,0x83,0x1e,0xc2,0x21,0x77,0x74,0x24,0x4b,0x72,0x21,0xb7,0x84,0xd0,0xd4,0x9c,
     0xe3,0xaa,0x21,0x2f,0x2c,0x02,0xa4,0xe0,0x35,0xc1,0x7e,0x23,0x29,0xac,0xa1,0x2e,
     0x21,0xd5,0x14,0xb2,0x54,0x66,0x93,0x1c,0x7d,0x8f,0x6a,0x5a,0xac,0x84,0xaa,0x05,
     0x1b,0xa3,0x0b,0x39,0x6a,0x0a,0xac,0x97,0x3d,0x58,0xe0,0x91
 };
-const uint8_t tag_128_b2[] = { 0x5b,0xc9,0x4f,0xbc,0x32,0x21,0xa5,0xdb,0x94,0xfa,0xe9,0x5a,0xe7,0x12,0x1a,0x47 };
+const uint8_t tag_128_tc4[] = { 0x5b,0xc9,0x4f,0xbc,0x32,0x21,0xa5,0xdb,0x94,0xfa,0xe9,0x5a,0xe7,0x12,0x1a,0x47 };
 
-// B.5 - AES-256 Test Case 10
-const uint8_t key_256_b5[] = {
-    0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08,
-    0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08
+// Test Case 6 - AES-128, 60-byte IV (J0 derived via GHASH)
+const uint8_t iv_128_tc6[]  = {
+    0x93,0x13,0x22,0x5d,0xf8,0x84,0x06,0xe5,0x55,0x90,0x9c,0x5a,0xff,0x52,0x69,0xaa,
+    0x6a,0x7a,0x95,0x38,0x53,0x4f,0x7d,0xa1,0xe4,0xc3,0x03,0xd2,0xa3,0x18,0xa7,0x28,
+    0xc3,0xc0,0xc9,0x51,0x56,0x80,0x95,0x39,0xfc,0xf0,0xe2,0x42,0x9a,0x6b,0x52,0x54,
+    0x16,0xae,0xdb,0xf5,0xa0,0xde,0x6a,0x57,0xa6,0x37,0xb3,0x9b
+};
+const uint8_t ct_128_tc6[]  = {
+    0x8c,0xe2,0x49,0x98,0x62,0x56,0x15,0xb6,0x03,0xa0,0x33,0xac,0xa1,0x3f,0xb8,0x94,
+    0xbe,0x91,0x12,0xa5,0xc3,0xa2,0x11,0xa8,0xba,0x26,0x2a,0x3c,0xca,0x7e,0x2c,0xa7,
+    0x01,0xe4,0xa9,0xa4,0xfb,0xa4,0x3c,0x90,0xcc,0xdc,0xb2,0x81,0xd4,0x8c,0x7c,0x6f,
+    0xd6,0x28,0x75,0xd2,0xac,0xa4,0x17,0x03,0x4c,0x34,0xae,0xe5
 };
-const uint8_t iv_256_b5[]  = { 0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88 };
-const uint8_t pt_256_b5[]  = {
-    0xd9,0xa3,0x21,0x16,0x8e,0x21,0x0e,0x88,0xa3,0x0a,0x8a,0x54,0x97,0x40,0xe3,0x00,
-    0x3d,0x80,0xaa,0x4c,0x77,0x0b,0x57,0x0e,0xc6,0xc7,0x55,0x5a,0xac,0x2f,0x09,0x98,
-    0x3c,0x77,0x00,0x4f,0x74,0xd2,0x82,0x94,0x3b,0xd1,0x87,0x0a,0xd3,0x8e,0x0f,0xd2
+const uint8_t tag_128_tc6[] = { 0x61,0x9c,0xc5,0xae,0xff,0xfe,0x0b,0xfa,0x46,0x2a,0xf4,0x3c,0x16,0x99,0xd0,0x50 };
+
+// Test Case 10 - AES-192
+const uint8_t ct_192_tc10[]  = {
+    0x39,0x80,0xca,0x0b,0x3c,0x00,0xe8,0x41,0xeb,0x06,0xfa,0xc4,0x87,0x2a,0x27,0x57,
+    0x85,0x9e,0x1c,0xea,0xa6,0xef,0xd9,0x84,0x62,0x85,0x93,0xb4,0x0c,0xa1,0xe1,0x9c,
+    0x7d,0x77,0x3d,0x00,0xc1,0x44,0xc5,0x25,0xac,0x61,0x9d,0x18,0xc8,0x4a,0x3f,0x47,
+    0x18,0xe2,0x44,0x8b,0x2f,0xe3,0x24,0xd9,0xcc,0xda,0x27,0x10
 };
-const uint8_t aad_256_b5[] = { 0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xab,0xad,0xda,0xd2 };
-const uint8_t ct_256_b5[]  = {
+const uint8_t tag_192_tc10[] = { 0x25,0x19,0x49,0x8e,0x80,0xf1,0x47,0x8f,0x37,0xba,0x55,0xbd,0x6d,0x27,0x61,0x8c };
+
+// Test Case 16 - AES-256
+const uint8_t ct_256_tc16[]  = {
     0x52,0x2d,0xc1,0xf0,0x99,0x56,0x7d,0x07,0xf4,0x7f,0x37,0xa3,0x2a,0x84,0x42,0x7d,
-    0x64,0x3a,0x8c,0xd4,0x44,0x0e,0xe1,0x2a,0x70,0x8c,0xc0,0x9e,0xa9,0xa1,0x32,0xcc,
-    0xf3,0xff,0x39,0x86,0x4f,0xdf,0x61,0xc5,0x86,0x58,0x4b,0x4f,0x6a,0xe9,0x57
+    0x64,0x3a,0x8c,0xdc,0xbf,0xe5,0xc0,0xc9,0x75,0x98,0xa2,0xbd,0x25,0x55,0xd1,0xaa,
+    0x8c,0xb0,0x8e,0x48,0x59,0x0d,0xbb,0x3d,0xa7,0xb0,0x8b,0x10,0x56,0x82,0x88,0x38,
+    0xc5,0xf6,0x1e,0x63,0x93,0xba,0x7a,0x0a,0xbc,0xc9,0xf6,0x62
 };
-const uint8_t tag_256_b5[] = { 0x61,0x9c,0xc5,0xae,0xff,0xfe,0x0b,0x6b,0x45,0x4d,0x48,0xbe,0xb7,0xc8,0x0f,0x4f };
+const uint8_t tag_256_tc16[] = { 0x76,0xfc,0x6e,0xce,0x0f,0x4e,0x17,0x68,0xcd,0xdf,0x88,0x53,0xbb,0x2d,0x55,0x1b };
 
 // --- Non-Standard AES-512 Self-Consistency Test ---
 // NO OFFICIAL VECTORS EXIST FOR THIS. Key chosen arbitrarily.
+// The expected CT/Tag below are pinned from the portable C implementation so the
+// optimized kernels are held to the same output; they are not external vectors.
 const uint8_t key_512_sc[] = {
     0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
     0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
@@ -92,6 +116,8 @@ const uint8_t key_512_sc[] = {
 const uint8_t iv_512_sc[]  = { 0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b };
 const uint8_t pt_512_sc[]  = { 0x54, 0x68, 0x69, 0x73, 0x20, 0x69, 0x73, 0x20, 0x61, 0x20, 0x74, 0x65, 0x73, 0x74, 0x2e }; // "This is a test."
 const uint8_t aad_512_sc[] = { 0xAA, 0xBB, 0xCC, 0xDD };
+const uint8_t ct_512_sc[]  = { 0xbe,0xec,0x44,0x39,0xa0,0x08,0x13,0x7d,0x3b,0x11,0x05,0x74,0x29,0x73,0x75 };
+const uint8_t tag_512_sc[] = { 0xf6,0x3c,0xf0,0x4e,0xd8,0x15,0xbe,0x68,0xb9,0xef,0xd8,0xbd,0x85,0xe5,0xe4,0xb7 };
 
 // Function to run a single GCM test vector
 int run_gcm_test(const gcm_test_vector_t* vector) {
@@ -105,26 +131,20 @@ int run_gcm_test(const gcm_test_vector_t* vector) {
     printf("--- Running Test: %s ---\n", vector->name);
 
     // Allocate buffers
-    calculated_ct = (uint8_t*)malloc(vector->pt_len);
-    decrypted_pt = (uint8_t*)malloc(vector->pt_len);
+    calculated_ct = (uint8_t*)malloc(vector->pt_len + 1); // +1 keeps malloc(0) non-NULL
+    decrypted_pt = (uint8_t*)malloc(vector->pt_len + 1);
     if (!calculated_ct || !decrypted_pt) {
         printf("ERROR: Memory allocation failed!\n");
         goto cleanup;
     }
 
-    // Select key size based on test vector
-    // This relies on the compile-time definitions in aes.h to match
-#if defined(AES128) && (AES128 == 1)
-    if (vector->key_len != 16) { printf("Skipping test - compiled for AES128\n"); result=0; goto cleanup; }
-#elif defined(AES192) && (AES192 == 1)
-     if (vector->key_len != 24) { printf("Skipping test - compiled for AES192\n"); result=0; goto cleanup; }
-#elif defined(AES256) && (AES256 == 1)
-     if (vector->key_len != 32) { printf("Skipping test - compiled for AES256\n"); result=0; goto cleanup; }
-#elif defined(AES512) && (AES512 == 1)
-     if (vector->key_len != 64) { printf("Skipping test - compiled for AES512\n"); result=0; goto cleanup; }
-#else
-    #error "No AES key size defined!"
-#endif
+    // All compiled-in key sizes are available at runtime; skip sizes that were
+    // disabled at build time (e.g. -DAES512=0).
+    if (AES_init_ctx_keylen(&ctx, vector->key, vector->key_len) != 0) {
+        printf("Skipping test - %d-bit keys not compiled in\n", vector->key_len * 8);
+        result = 0;
+        goto cleanup;
+    }
 
     print_hex("Key", vector->key, vector->key_len);
     print_hex("IV", vector->iv, vector->iv_len);
@@ -132,7 +152,6 @@ int run_gcm_test(const gcm_test_vector_t* vector) {
     print_hex("Plaintext", vector->pt, vector->pt_len);
 
     // --- Encryption --- 
-    AES_init_ctx(&ctx, vector->key);
     encrypt_ret = AES_GCM_encrypt(&ctx, vector->iv, vector->iv_len, 
                                 vector->aad, vector->aad_len, 
                                 vector->pt, calculated_ct, vector->pt_len, 
@@ -165,7 +184,7 @@ int run_gcm_test(const gcm_test_vector_t* vector) {
     }
 
     // --- Decryption --- 
-    AES_init_ctx(&ctx, vector->key); // Re-init context (key only)
+    AES_init_ctx_keylen(&ctx, vector->key, vector->key_len); // Re-init context (key only)
     decrypt_ret = AES_GCM_decrypt(&ctx, vector->iv, vector->iv_len,
                                 vector->aad, vector->aad_len,
                                 calculated_ct, decrypted_pt, vector->pt_len, // Use calculated CT
@@ -194,16 +213,988 @@ cleanup:
     return result;
 }
 
-#ifndef AES_GCM_STANDALONE_TEST // Only define main if compiling standalone C test
+// Encrypts a vector in independent chunks of chunk_len bytes (combined in order
+// afterwards) and checks the result against the one-shot AES_GCM_encrypt output.
+int run_chunked_test(const gcm_test_vector_t* vector, size_t chunk_len) {
+    struct AES_ctx ctx;
+    uint8_t* expected_ct = (uint8_t*)malloc(vector->pt_len + 1);
+    uint8_t* chunked_ct = (uint8_t*)malloc(vector->pt_len + 1);
+    uint8_t* chunked_pt = (uint8_t*)malloc(vector->pt_len + 1);
+    uint8_t expected_tag[AES_GCM_TAG_LEN], chunked_tag[AES_GCM_TAG_LEN];
+    uint8_t j0[AES_BLOCKLEN], ghash[AES_BLOCKLEN], partial[AES_BLOCKLEN];
+    size_t off, n;
+    int result = 1;
+
+    printf("--- Running Chunked Test: %s, %zu-byte chunks ---\n", vector->name, chunk_len);
+    if (!expected_ct || !chunked_ct || !chunked_pt) {
+        printf("ERROR: Memory allocation failed!\n");
+        goto cleanup;
+    }
+    if (AES_init_ctx_keylen(&ctx, vector->key, vector->key_len) != 0) {
+        printf("Skipping test - %d-bit keys not compiled in\n", vector->key_len * 8);
+        result = 0;
+        goto cleanup;
+    }
+    AES_GCM_encrypt(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len,
+                    vector->pt, expected_ct, vector->pt_len, expected_tag);
+
+    // Encrypt: chunks hashed into independent partials, folded in order
+    AES_GCM_chunk_start(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, j0, ghash);
+    for (off = 0; off < (size_t)vector->pt_len; off += n) {
+        n = (size_t)vector->pt_len - off < chunk_len ? (size_t)vector->pt_len - off : chunk_len;
+        memset(partial, 0, sizeof(partial));
+        AES_GCM_encrypt_chunk(&ctx, j0, off / AES_BLOCKLEN, vector->pt + off, chunked_ct + off, n, partial);
+        AES_GCM_chunk_combine(&ctx, ghash, partial, n);
+    }
+    AES_GCM_chunk_finish(&ctx, j0, ghash, vector->aad_len, vector->pt_len, chunked_tag);
+    if (memcmp(chunked_ct, expected_ct, vector->pt_len) != 0 || memcmp(chunked_tag, expected_tag, AES_GCM_TAG_LEN) != 0) {
+        printf("ERROR: Chunked encryption does not match one-shot output!\n");
+        goto cleanup;
+    }
+
+    // Decrypt: chunks fed the running GHASH state sequentially
+    AES_GCM_chunk_start(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, j0, ghash);
+    for (off = 0; off < (size_t)vector->pt_len; off += n) {
+        n = (size_t)vector->pt_len - off < chunk_len ? (size_t)vector->pt_len - off : chunk_len;
+        AES_GCM_decrypt_chunk(&ctx, j0, off / AES_BLOCKLEN, chunked_ct + off, chunked_pt + off, n, ghash);
+    }
+    AES_GCM_chunk_finish(&ctx, j0, ghash, vector->aad_len, vector->pt_len, chunked_tag);
+    if (memcmp(chunked_pt, vector->pt, vector->pt_len) != 0 || memcmp(chunked_tag, expected_tag, AES_GCM_TAG_LEN) != 0) {
+        printf("ERROR: Chunked decryption does not match!\n");
+        goto cleanup;
+    }
+    result = 0;
+
+cleanup:
+    free(expected_ct);
+    free(chunked_ct);
+    free(chunked_pt);
+    printf("--- Chunked Test %s: %s ---\n\n", vector->name, result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+#if defined(AES_GCM_STANDALONE_TEST) && AES_GCM_STATS
+#include <pthread.h>
+
+static void* stats_thread_encrypt(void* arg) {
+    const gcm_test_vector_t* vector = (const gcm_test_vector_t*)arg;
+    struct AES_ctx ctx;
+    uint8_t ct[64], tag[AES_GCM_TAG_LEN];
+    AES_init_ctx_keylen(&ctx, vector->key, vector->key_len);
+    AES_GCM_encrypt(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, vector->pt, ct, vector->pt_len, tag);
+    return NULL;
+}
+#endif
+
+// Checks the AES_GCM_STATS counters after a known sequence of calls. vector
+// must have a non-96-bit IV so every call takes the J0 slow path.
+int run_stats_test(const gcm_test_vector_t* vector) {
+    struct AES_ctx ctx;
+    struct AES_GCM_stats st;
+    uint8_t ct[64], pt[64], tag[AES_GCM_TAG_LEN];
+    uint64_t n = (uint64_t)vector->pt_len, seals = 1;
+    int result = 1;
+
+    printf("--- Running Stats Test: %s ---\n", vector->name);
+    AES_init_ctx_keylen(&ctx, vector->key, vector->key_len);
+    AES_GCM_stats_reset();
+    AES_GCM_encrypt(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, vector->pt, ct, vector->pt_len, tag);
+    AES_GCM_decrypt(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, ct, pt, vector->pt_len, tag);
+    AES_GCM_verify(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, ct, vector->pt_len, tag);
+    tag[0] ^= 1;
+    AES_GCM_decrypt(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, ct, pt, vector->pt_len, tag);
+    AES_GCM_verify(&ctx, vector->iv, vector->iv_len, vector->aad, vector->aad_len, ct, vector->pt_len, tag);
+    AES_GMAC_verify(&ctx, vector->iv, vector->iv_len, ct, vector->pt_len, tag); // Not counted
+
+    if (AES_GCM_stats_snapshot(&st) != 0) {
+        printf("Statistics not compiled in (backend %s)\n", st.backend);
+        result = (st.backend == NULL || st.seal_messages != 0);
+        goto done;
+    }
+#if defined(AES_GCM_STANDALONE_TEST) && AES_GCM_STATS
+    { // Counters of a thread that has exited must still be included
+        pthread_t th;
+        if (pthread_create(&th, NULL, stats_thread_encrypt, (void*)vector) != 0 || pthread_join(th, NULL) != 0) {
+            printf("ERROR: pthread_create failed\n");
+            goto done;
+        }
+        AES_GCM_stats_snapshot(&st);
+        seals = 2;
+    }
+#endif
+    printf("backend=%s seal=%llu/%lluB open=%llu/%lluB auth_failures=%llu verify=%llu/%lluB verify_failures=%llu "
+           "iv_slow_path=%llu ctr_ns=%llu ghash_ns=%llu\n",
+           st.backend, (unsigned long long)st.seal_messages, (unsigned long long)st.seal_bytes,
+           (unsigned long long)st.open_messages, (unsigned long long)st.open_bytes,
+           (unsigned long long)st.auth_failures, (unsigned long long)st.verify_messages,
+           (unsigned long long)st.verify_bytes, (unsigned long long)st.verify_failures,
+           (unsigned long long)st.iv_slow_path, (unsigned long long)st.ctr_ns, (unsigned long long)st.ghash_ns);
+    result = !(st.seal_messages == seals && st.seal_bytes == seals * n && st.open_messages == 2 &&
+               st.open_bytes == 2 * n && st.auth_failures == 1 && st.verify_messages == 2 &&
+               st.verify_bytes == 2 * n && st.verify_failures == 1 && st.iv_slow_path == seals + 5 &&
+               st.ctr_ns + st.ghash_ns > 0);
+done:
+    printf("--- Stats Test %s: %s ---\n\n", vector->name, result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// Seals pt_tc in segment_size-byte segments (aes_seg.h) and checks the layout
+// against AES_GCM_encrypt, every byte range, and that tampering, reordering and
+// truncation are rejected.
+int run_seg_test(const uint8_t* key, size_t key_len, uint32_t segment_size) {
+    struct AES_ctx ctx;
+    struct AES_seg_params params = { segment_size, sizeof(pt_tc), (uint8_t)key_len, { 1, 2, 3, 4, 5, 6, 7, 8 } };
+    struct AES_seg_params parsed;
+    uint8_t sealed[512], copy[512], out[sizeof(pt_tc)], zero[sizeof(pt_tc)] = { 0 };
+    uint8_t iv[AES_GCM_IV_LEN], aad[AES_SEG_HEADER_LEN + 1], ct[sizeof(pt_tc)], tag[AES_GCM_TAG_LEN];
+    uint64_t sealed_len = AES_seg_sealed_len(&params), count = AES_seg_count(&params);
+    size_t off, len;
+    int result = 1;
+
+    printf("--- Running Segmented Test: %zu-bit key, %u-byte segments ---\n", key_len * 8, (unsigned)segment_size);
+    if (AES_init_ctx_keylen(&ctx, key, key_len) != 0) {
+        printf("Skipping test - %zu-bit keys not compiled in\n", key_len * 8);
+        return 0;
+    }
+    if (sealed_len > sizeof(sealed) || AES_seg_encrypt(&ctx, &params, pt_tc, sealed) != 0 ||
+        AES_seg_header_read(sealed, &parsed) != 0 || parsed.plaintext_len != sizeof(pt_tc) ||
+        parsed.segment_size != segment_size || parsed.key_len != key_len) {
+        printf("ERROR: AES_seg_encrypt or the header round trip failed\n");
+        goto done;
+    }
+
+    // The last segment is a plain GCM message: IV = base || index, AAD = header || 1
+    memcpy(iv, params.nonce_base, AES_SEG_NONCE_BASE_LEN);
+    memset(iv + AES_SEG_NONCE_BASE_LEN, 0, 4);
+    iv[AES_GCM_IV_LEN - 1] = (uint8_t)(count - 1);
+    memcpy(aad, sealed, AES_SEG_HEADER_LEN);
+    aad[AES_SEG_HEADER_LEN] = 1;
+    len = AES_seg_plain_len(&params, count - 1);
+    AES_GCM_encrypt(&ctx, iv, sizeof(iv), aad, sizeof(aad), pt_tc + (count - 1) * segment_size, ct, len, tag);
+    if (memcmp(sealed + AES_seg_offset(&params, count - 1), ct, len) != 0 ||
+        memcmp(sealed + AES_seg_offset(&params, count - 1) + len, tag, AES_GCM_TAG_LEN) != 0) {
+        printf("ERROR: Last segment does not match AES_GCM_encrypt\n");
+        goto done;
+    }
+
+    for (off = 0; off <= sizeof(pt_tc); ++off) {
+        for (len = 0; off + len <= sizeof(pt_tc); ++len) {
+            if (AES_seg_decrypt_range(&ctx, sealed, sealed_len, off, len, out) != 0 || memcmp(out, pt_tc + off, len) != 0) {
+                printf("ERROR: Range [%zu, +%zu) did not decrypt\n", off, len);
+                goto done;
+            }
+        }
+    }
+    if (AES_seg_decrypt_range(&ctx, sealed, sealed_len, 1, sizeof(pt_tc), out) != -1 ||
+        AES_seg_decrypt_range(&ctx, sealed, sealed_len - 1, 0, 1, out) != -1) {
+        printf("ERROR: Range past the end or truncated object accepted\n");
+        goto done;
+    }
+
+    // A flipped bit in segment 1 fails ranges that touch it, and only those
+    memcpy(copy, sealed, sealed_len);
+    copy[AES_seg_offset(&params, 1)] ^= 1;
+    if (AES_seg_decrypt_range(&ctx, copy, sealed_len, 0, segment_size, out) != 0 ||
+        AES_seg_decrypt_range(&ctx, copy, sealed_len, segment_size - 1, 2, out) != -3 || memcmp(out, zero, 2) != 0) {
+        printf("ERROR: Tampered segment not isolated\n");
+        goto done;
+    }
+
+    // Swapped segments 0 and 1 (equal length) fail: the index is in the IV
+    memcpy(copy, sealed, sealed_len);
+    memcpy(copy + AES_seg_offset(&params, 0), sealed + AES_seg_offset(&params, 1), segment_size + AES_GCM_TAG_LEN);
+    memcpy(copy + AES_seg_offset(&params, 1), sealed + AES_seg_offset(&params, 0), segment_size + AES_GCM_TAG_LEN);
+    if (AES_seg_decrypt_range(&ctx, copy, sealed_len, 0, 1, out) != -3) {
+        printf("ERROR: Reordered segments accepted\n");
+        goto done;
+    }
+
+    // Truncating to the first segment with a rewritten header fails: segment 0
+    // was sealed under the old header and without the last-segment flag
+    parsed.plaintext_len = segment_size;
+    memcpy(copy, sealed, AES_seg_sealed_len(&parsed));
+    AES_seg_header_write(&parsed, copy);
+    if (AES_seg_decrypt_range(&ctx, copy, AES_seg_sealed_len(&parsed), 0, 1, out) != -3) {
+        printf("ERROR: Truncated object accepted\n");
+        goto done;
+    }
+
+    // An empty object is one empty, authenticated segment
+    params.plaintext_len = 0;
+    if (AES_seg_count(&params) != 1 || AES_seg_sealed_len(&params) != AES_SEG_HEADER_LEN + AES_GCM_TAG_LEN ||
+        AES_seg_encrypt(&ctx, &params, NULL, copy) != 0 ||
+        AES_seg_open(&ctx, copy, 0, copy + AES_SEG_HEADER_LEN, AES_GCM_TAG_LEN, NULL) != 0) {
+        printf("ERROR: Empty object did not round trip\n");
+        goto done;
+    }
+    copy[AES_SEG_HEADER_LEN] ^= 1;
+    if (AES_seg_open(&ctx, copy, 0, copy + AES_SEG_HEADER_LEN, AES_GCM_TAG_LEN, NULL) != -3) {
+        printf("ERROR: Empty object with a bad tag accepted\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    printf("--- Segmented Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// Checks the IV layout of nonce leases, that interleaved leases never hand out
+// the same counter, and that the source stops at its limit.
+int run_nonce_test(void) {
+    static const uint8_t prefix[AES_NONCE_PREFIX_LEN] = { 0xde, 0xad, 0xbe, 0xef };
+    static const uint8_t first_iv[AES_GCM_IV_LEN] = { 0xde, 0xad, 0xbe, 0xef, 0, 0, 0, 0, 0, 0, 0, 0 };
+    struct AES_ctx ctx;
+    struct AES_nonce_source src;
+    struct AES_nonce_lease a, b;
+    uint8_t iv[AES_GCM_IV_LEN], ct[sizeof(pt_tc)], pt[sizeof(pt_tc)], tag[AES_GCM_TAG_LEN];
+    uint8_t seen[100] = { 0 };
+    int result = 1, issued = 0;
+
+    printf("--- Running Nonce Lease Test ---\n");
+    AES_init_ctx_keylen(&ctx, key_tc, 16);
+    AES_nonce_source_init(&src, &ctx, prefix, 100);
+    AES_nonce_lease_init(&a, &src, 8);
+    AES_nonce_lease_init(&b, &src, 3);
+
+    if (AES_nonce_next(&a, iv) != 0 || memcmp(iv, first_iv, sizeof(iv)) != 0) {
+        printf("ERROR: First IV is not prefix || 0\n");
+        goto done;
+    }
+    seen[0] = 1;
+    issued = 1;
+    // Alternate leases until both are exhausted; every counter below the limit
+    // must come out exactly once
+    for (;;) {
+        int ra = AES_nonce_next(&a, iv);
+        if (ra == 0) {
+            if (memcmp(iv, prefix, sizeof(prefix)) != 0 || iv[11] >= 100 || seen[iv[11]]++) {
+                printf("ERROR: Duplicate or out-of-range IV %u\n", iv[11]);
+                goto done;
+            }
+            ++issued;
+        }
+        int rb = AES_GCM_encrypt_next(&b, aad_tc, sizeof(aad_tc), pt_tc, ct, sizeof(pt_tc), iv, tag);
+        if (rb == 0) {
+            if (iv[11] >= 100 || seen[iv[11]]++ ||
+                AES_GCM_decrypt(&ctx, iv, sizeof(iv), aad_tc, sizeof(aad_tc), ct, pt, sizeof(pt), tag) != 0) {
+                printf("ERROR: Duplicate IV or bad ciphertext from AES_GCM_encrypt_next\n");
+                goto done;
+            }
+            ++issued;
+        }
+        if (ra == -4 && rb == -4) {
+            break;
+        }
+        if ((ra != 0 && ra != -4) || (rb != 0 && rb != -4)) {
+            printf("ERROR: Unexpected return %d/%d\n", ra, rb);
+            goto done;
+        }
+    }
+    if (issued != 100 || AES_nonce_remaining(&src) != 0) {
+        printf("ERROR: Issued %d IVs under a limit of 100\n", issued);
+        goto done;
+    }
+    result = 0;
+
+done:
+    printf("--- Nonce Lease Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// Checks that AES_ctx_alloc returns aligned contexts that seal like stack
+// contexts, and that initialisation leaves no stale bytes behind.
+int run_ctx_alloc_test(void) {
+    struct AES_ctx* heap = AES_ctx_alloc();
+    struct AES_ctx stack;
+    uint8_t ct1[sizeof(pt_tc)], ct2[sizeof(pt_tc)], tag1[AES_GCM_TAG_LEN], tag2[AES_GCM_TAG_LEN];
+    int result = 1;
+
+    printf("--- Running Context Allocation Test ---\n");
+    if (heap == NULL || ((uintptr_t)heap % AES_CTX_ALIGN) != 0) {
+        printf("ERROR: AES_ctx_alloc returned a misaligned or NULL context\n");
+        goto done;
+    }
+    // Reusing a context for a shorter key must not leave the old schedule in it
+    memset(&stack, 0xa5, sizeof(stack));
+    AES_init_ctx_keylen(&stack, key_512_sc, 64);
+    AES_init_ctx_keylen(&stack, key_tc, 16);
+    AES_init_ctx_keylen(heap, key_tc, 16);
+    if (memcmp(heap, &stack, sizeof(stack)) != 0) {
+        printf("ERROR: Contexts for the same key differ\n");
+        goto done;
+    }
+    AES_GCM_encrypt(heap, iv_tc, 12, aad_tc, sizeof(aad_tc), pt_tc, ct1, sizeof(pt_tc), tag1);
+    AES_GCM_encrypt(&stack, iv_tc, 12, aad_tc, sizeof(aad_tc), pt_tc, ct2, sizeof(pt_tc), tag2);
+    if (memcmp(ct1, ct_128_tc4, sizeof(ct1)) != 0 || memcmp(ct1, ct2, sizeof(ct1)) != 0 ||
+        memcmp(tag1, tag2, sizeof(tag1)) != 0) {
+        printf("ERROR: Heap context does not match GCM TC4\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    AES_ctx_free(heap);
+    printf("--- Context Allocation Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// IVs split into a prefix and a suffix at every point, for IV lengths that take
+// each J0 path (12 bytes: no GHASH; 16: the one-multiply path; 60: TC6's IV
+// length), must give AES_GCM_encrypt's output for the whole IV. The prefix
+// path always GHASHes, so this also checks the 16-byte shortcut against it.
+int run_iv_prefix_test(void) {
+    static const size_t iv_lens[] = { AES_GCM_IV_LEN, AES_BLOCKLEN, 60 };
+    struct AES_ctx ctx;
+    struct AES_GCM_iv_prefix prefix;
+    uint8_t iv[60], j0[AES_BLOCKLEN], ct1[sizeof(pt_tc)], ct2[sizeof(pt_tc)], out[sizeof(pt_tc)];
+    uint8_t tag1[AES_GCM_TAG_LEN], tag2[AES_GCM_TAG_LEN];
+    size_t n, i, split;
+    int result = 1;
+
+    printf("--- Running IV Prefix Test ---\n");
+    AES_init_ctx_keylen(&ctx, key_tc, 16);
+    for (i = 0; i < sizeof(iv); ++i) {
+        iv[i] = (uint8_t)(0xa5 ^ (i * 13));
+    }
+    for (n = 0; n < sizeof(iv_lens) / sizeof(iv_lens[0]); ++n) {
+        size_t iv_len = iv_lens[n];
+        AES_GCM_encrypt(&ctx, iv, iv_len, aad_tc, sizeof(aad_tc), pt_tc, ct1, sizeof(pt_tc), tag1);
+        for (split = 0; split <= iv_len; ++split) {
+            if (AES_GCM_iv_prefix_init(&ctx, iv, split, &prefix) != 0 ||
+                AES_GCM_iv_prefix_j0(&ctx, &prefix, split < iv_len ? iv + split : NULL, iv_len - split, j0) != 0 ||
+                AES_GCM_encrypt_j0(&ctx, j0, aad_tc, sizeof(aad_tc), pt_tc, ct2, sizeof(pt_tc), tag2) != 0) {
+                printf("ERROR: IV prefix API failed (IV %zu bytes, prefix %zu)\n", iv_len, split);
+                goto done;
+            }
+            if (memcmp(ct1, ct2, sizeof(ct1)) != 0 || memcmp(tag1, tag2, sizeof(tag1)) != 0) {
+                printf("ERROR: Prefix output differs (IV %zu bytes, prefix %zu)\n", iv_len, split);
+                goto done;
+            }
+        }
+        if (AES_GCM_decrypt_j0(&ctx, j0, aad_tc, sizeof(aad_tc), ct2, out, sizeof(out), tag2) != 0 ||
+            memcmp(out, pt_tc, sizeof(out)) != 0) {
+            printf("ERROR: AES_GCM_decrypt_j0 failed (IV %zu bytes)\n", iv_len);
+            goto done;
+        }
+        tag2[0] ^= 1;
+        if (AES_GCM_decrypt_j0(&ctx, j0, aad_tc, sizeof(aad_tc), ct2, out, sizeof(out), tag2) != -3) {
+            printf("ERROR: AES_GCM_decrypt_j0 accepted a bad tag\n");
+            goto done;
+        }
+    }
+    if (AES_GCM_iv_prefix_init(&ctx, NULL, 0, &prefix) != 0 ||
+        AES_GCM_iv_prefix_j0(&ctx, &prefix, NULL, 0, j0) != -1 ||
+        AES_GCM_encrypt_j0(&ctx, NULL, NULL, 0, pt_tc, ct2, sizeof(pt_tc), tag2) != -1) {
+        printf("ERROR: Empty IV or missing J0 not rejected\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    printf("--- IV Prefix Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// AES_GMAC must equal AES_GCM_encrypt with the data as AAD and no plaintext,
+// one-shot and streamed in pieces of several sizes, for data lengths around the
+// 4-block GHASH stride.
+int run_gmac_test(void) {
+    static const size_t pieces[] = { 1, 7, 16, 33, 69 };
+    struct AES_ctx ctx;
+    struct AES_GMAC_ctx g;
+    uint8_t data[300], expect[AES_GCM_TAG_LEN], tag[AES_GCM_TAG_LEN];
+    size_t len, i, off, n;
+    int result = 1;
+
+    printf("--- Running GMAC Test ---\n");
+    AES_init_ctx_keylen(&ctx, key_tc, 32);
+    for (i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t)(i * 29 + 3);
+    }
+    for (len = 0; len <= sizeof(data); len += (len < 140 ? 1 : 37)) {
+        const uint8_t* iv = len % 2 ? iv_128_tc6 : iv_tc;
+        size_t iv_len = len % 2 ? sizeof(iv_128_tc6) : sizeof(iv_tc);
+        AES_GCM_encrypt(&ctx, iv, iv_len, data, len, NULL, NULL, 0, expect);
+        if (AES_GMAC(&ctx, iv, iv_len, data, len, tag) != 0 || memcmp(tag, expect, sizeof(tag)) != 0 ||
+            AES_GMAC_verify(&ctx, iv, iv_len, data, len, expect) != 0) {
+            printf("ERROR: AES_GMAC differs from AES_GCM_encrypt (%zu bytes)\n", len);
+            goto done;
+        }
+        for (i = 0; i < sizeof(pieces) / sizeof(pieces[0]); ++i) {
+            AES_GMAC_init(&g, &ctx, iv, iv_len);
+            for (off = 0; off < len; off += n) {
+                n = len - off < pieces[i] ? len - off : pieces[i];
+                AES_GMAC_update(&g, data + off, n);
+            }
+            if (AES_GMAC_final(&g, tag) != 0 || memcmp(tag, expect, sizeof(tag)) != 0) {
+                printf("ERROR: Streamed GMAC differs (%zu bytes in %zu-byte pieces)\n", len, pieces[i]);
+                goto done;
+            }
+        }
+    }
+    expect[15] ^= 0x80;
+    AES_GMAC_init(&g, &ctx, iv_tc, sizeof(iv_tc));
+    AES_GMAC_update(&g, data, sizeof(data));
+    if (AES_GMAC_verify(&ctx, iv_tc, sizeof(iv_tc), data, sizeof(data), expect) != -3 ||
+        AES_GMAC_final_verify(&g, expect) != -3 || AES_GMAC_final(&g, tag) != -1 ||
+        AES_GMAC(&ctx, NULL, 0, data, sizeof(data), tag) != -1) {
+        printf("ERROR: Bad tag, finished stream or missing IV not rejected\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    printf("--- GMAC Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// CTR: the SP 800-38A F.5.1 vector (CTR-AES128.Encrypt), seeking to each block
+// of it, and counters whose low 32 bits or whole 128 bits wrap, checked block
+// by block against one-block calls at the matching offsets.
+int run_ctr_test(void) {
+    static const uint8_t key[16] = { 0x2b,0x7e,0x15,0x16,0x28,0xae,0xd2,0xa6,0xab,0xf7,0x15,0x88,0x09,0xcf,0x4f,0x3c };
+    static const uint8_t ctr0[16] = { 0xf0,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa,0xfb,0xfc,0xfd,0xfe,0xff };
+    static const uint8_t pt[64] = {
+        0x6b,0xc1,0xbe,0xe2,0x2e,0x40,0x9f,0x96,0xe9,0x3d,0x7e,0x11,0x73,0x93,0x17,0x2a,
+        0xae,0x2d,0x8a,0x57,0x1e,0x03,0xac,0x9c,0x9e,0xb7,0x6f,0xac,0x45,0xaf,0x8e,0x51,
+        0x30,0xc8,0x1c,0x46,0xa3,0x5c,0xe4,0x11,0xe5,0xfb,0xc1,0x19,0x1a,0x0a,0x52,0xef,
+        0xf6,0x9f,0x24,0x45,0xdf,0x4f,0x9b,0x17,0xad,0x2b,0x41,0x7b,0xe6,0x6c,0x37,0x10 };
+    static const uint8_t ct[64] = {
+        0x87,0x4d,0x61,0x91,0xb6,0x20,0xe3,0x26,0x1b,0xef,0x68,0x64,0x99,0x0d,0xb6,0xce,
+        0x98,0x06,0xf6,0x6b,0x79,0x70,0xfd,0xff,0x86,0x17,0x18,0x7b,0xb9,0xff,0xfd,0xff,
+        0x5a,0xe4,0xdf,0x3e,0xdb,0xd5,0xd3,0x5e,0x5b,0x4f,0x09,0x02,0x0d,0xb0,0x3e,0xab,
+        0x1e,0x03,0x1d,0xda,0x2f,0xbe,0x03,0xd1,0x79,0x21,0x70,0xa0,0xf3,0x00,0x9c,0xee };
+    struct AES_ctx ctx;
+    uint8_t out[200], block[16], counter[16];
+    size_t i, w;
+    int result = 1;
+
+    printf("--- Running CTR Test ---\n");
+    AES_init_ctx_keylen(&ctx, key, sizeof(key));
+    if (AES_CTR_xcrypt(&ctx, ctr0, 0, pt, out, sizeof(pt)) != 0 || memcmp(out, ct, sizeof(ct)) != 0) {
+        printf("ERROR: SP 800-38A F.5.1 mismatch\n");
+        goto done;
+    }
+    for (i = 0; i < 4; ++i) {
+        memcpy(out, pt + 16 * i, 16);
+        AES_CTR_xcrypt(&ctx, ctr0, i, out, out, 16);
+        if (memcmp(out, ct + 16 * i, 16) != 0) {
+            printf("ERROR: Seek to block %zu mismatch\n", i);
+            goto done;
+        }
+    }
+
+    // Low word at 2^32 - 3 (the carry reaches byte 11, then byte 10), and the
+    // all-ones counter (wraps to zero)
+    for (w = 0; w < 2; ++w) {
+        memset(counter, 0xff, sizeof(counter));
+        if (w == 0) {
+            counter[11] = 0xff;
+            counter[10] = 0x00;
+            counter[15] = 0xfd;
+        }
+        AES_CTR_keystream(&ctx, counter, 0, out, sizeof(out));
+        for (i = 0; i * 16 < sizeof(out); ++i) {
+            size_t n = sizeof(out) - i * 16 < 16 ? sizeof(out) - i * 16 : 16;
+            AES_CTR_keystream(&ctx, counter, i, block, n);
+            if (memcmp(out + i * 16, block, n) != 0) {
+                printf("ERROR: Counter carry mismatch at block %zu\n", i);
+                goto done;
+            }
+        }
+    }
+    // The all-ones counter plus one is zero: stream block 1 is E_K(0)
+    AES_CTR_keystream(&ctx, counter, 1, out, 16);
+    if (memcmp(out, ctx.H, 16) != 0 || AES_CTR_xcrypt(&ctx, NULL, 0, pt, out, 16) != -1 ||
+        AES_CTR_keystream(&ctx, ctr0, 0, NULL, 1) != -1) {
+        printf("ERROR: 128-bit wrap or invalid arguments\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    printf("--- CTR Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// AES_encrypt_blocks: the FIPS-197 appendix C examples for AES-128/192/256,
+// and for every key size 37 blocks (the interleaved loops plus leftovers, in
+// place) against one-block CTR keystreams, which run a different kernel.
+int run_encrypt_blocks_test(void) {
+    static const uint8_t fips_pt[16] = { 0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,0x88,0x99,0xaa,0xbb,0xcc,0xdd,0xee,0xff };
+    static const uint8_t fips_ct[3][16] = {
+        { 0x69,0xc4,0xe0,0xd8,0x6a,0x7b,0x04,0x30,0xd8,0xcd,0xb7,0x80,0x70,0xb4,0xc5,0x5a },
+        { 0xdd,0xa9,0x7c,0xa4,0x86,0x4c,0xdf,0xe0,0x6e,0xaf,0x70,0xa0,0xec,0x0d,0x71,0x91 },
+        { 0x8e,0xa2,0xb7,0xca,0x51,0x67,0x45,0xbf,0xea,0xfc,0x49,0x90,0x4b,0x49,0x60,0x89 } };
+    static const size_t key_lens[] = { 16, 24, 32, 64 };
+    struct AES_ctx ctx;
+    uint8_t key[64], buf[37 * 16], ks[16];
+    size_t k, i;
+    int result = 1;
+
+    printf("--- Running Block Encryption Test ---\n");
+    for (i = 0; i < sizeof(key); ++i) {
+        key[i] = (uint8_t)i;
+    }
+    for (k = 0; k < sizeof(key_lens) / sizeof(key_lens[0]); ++k) {
+        if (AES_init_ctx_keylen(&ctx, key, key_lens[k]) != 0) {
+            continue; // Not compiled in
+        }
+        if (k < 3 && (AES_encrypt_blocks(&ctx, fips_pt, buf, 1) != 0 || memcmp(buf, fips_ct[k], 16) != 0)) {
+            printf("ERROR: FIPS-197 AES-%zu example mismatch\n", key_lens[k] * 8);
+            goto done;
+        }
+        for (i = 0; i < sizeof(buf); ++i) {
+            buf[i] = (uint8_t)(i * 11 + k);
+        }
+        AES_encrypt_blocks(&ctx, buf, buf, sizeof(buf) / 16);
+        for (i = 0; i < sizeof(buf) / 16; ++i) {
+            uint8_t block[16];
+            size_t b;
+            for (b = 0; b < 16; ++b) {
+                block[b] = (uint8_t)((i * 16 + b) * 11 + k);
+            }
+            AES_CTR_keystream(&ctx, block, 0, ks, sizeof(ks));
+            if (memcmp(buf + i * 16, ks, 16) != 0) {
+                printf("ERROR: AES-%zu block %zu differs from the CTR kernel\n", key_lens[k] * 8, i);
+                goto done;
+            }
+        }
+    }
+    if (AES_encrypt_blocks(&ctx, NULL, buf, 1) != -1 || AES_encrypt_blocks(&ctx, NULL, NULL, 0) != 0) {
+        printf("ERROR: Invalid arguments\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    printf("--- Block Encryption Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// Truncated tags are the leftmost bytes of TC4's tag; they verify at their own
+// length only, a changed last byte fails, and other lengths are rejected.
+int run_tag_len_test(void) {
+    static const size_t lens[] = { 16, 15, 14, 13, 12, 8, 4 };
+    static const size_t bad[] = { 0, 3, 9, 11, 17 };
+    struct AES_ctx ctx;
+    uint8_t ct[sizeof(pt_tc)], out[sizeof(pt_tc)], tag[AES_GCM_TAG_LEN];
+    size_t i;
+    int result = 1;
+
+    printf("--- Running Truncated Tag Test ---\n");
+    AES_init_ctx_keylen(&ctx, key_tc, 16);
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+        size_t n = lens[i];
+        memset(tag, 0xee, sizeof(tag));
+        if (AES_GCM_encrypt_taglen(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), pt_tc, ct, sizeof(pt_tc), tag, n) != 0 ||
+            memcmp(ct, ct_128_tc4, sizeof(ct)) != 0 || memcmp(tag, tag_128_tc4, n) != 0 || (n < 16 && tag[n] != 0xee)) {
+            printf("ERROR: %zu-byte tag is not the prefix of the full tag\n", n);
+            goto done;
+        }
+        if (AES_GCM_decrypt_taglen(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), ct, out, sizeof(ct), tag, n) != 0 ||
+            memcmp(out, pt_tc, sizeof(out)) != 0) {
+            printf("ERROR: %zu-byte tag does not verify\n", n);
+            goto done;
+        }
+        tag[n - 1] ^= 1;
+        if (AES_GCM_decrypt_taglen(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), ct, out, sizeof(ct), tag, n) != -3 ||
+            out[0] != 0) {
+            printf("ERROR: Changed %zu-byte tag accepted\n", n);
+            goto done;
+        }
+    }
+    for (i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        if (AES_GCM_encrypt_taglen(&ctx, iv_tc, sizeof(iv_tc), NULL, 0, pt_tc, ct, sizeof(pt_tc), tag, bad[i]) != -1 ||
+            AES_GCM_decrypt_taglen(&ctx, iv_tc, sizeof(iv_tc), NULL, 0, ct, out, sizeof(ct), tag, bad[i]) != -1) {
+            printf("ERROR: %zu-byte tag not rejected\n", bad[i]);
+            goto done;
+        }
+    }
+    result = 0;
+
+done:
+    printf("--- Truncated Tag Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// AES_GCM_verify accepts TC4 and rejects any changed byte of the ciphertext,
+// AAD or tag; over every length up to 100 bytes and each key size it agrees
+// with what AES_GCM_encrypt produced.
+int run_verify_test(void) {
+    static const size_t key_lens[] = { 16, 24, 32, 64 };
+    struct AES_ctx ctx;
+    uint8_t ct[sizeof(pt_tc)], aad[sizeof(aad_tc)], tag[AES_GCM_TAG_LEN];
+    uint8_t msg[100], sealed[100], key[64];
+    size_t i, k, len;
+    int result = 1;
+
+    printf("--- Running Verify Test ---\n");
+    AES_init_ctx_keylen(&ctx, key_tc, 16);
+    memcpy(ct, ct_128_tc4, sizeof(ct));
+    memcpy(aad, aad_tc, sizeof(aad));
+    memcpy(tag, tag_128_tc4, sizeof(tag));
+    if (AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), aad, sizeof(aad), ct, sizeof(ct), tag) != 0) {
+        printf("ERROR: TC4 does not verify\n");
+        goto done;
+    }
+    ct[sizeof(ct) - 1] ^= 0x80;
+    aad[0] ^= 1;
+    tag[7] ^= 2;
+    if (AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), ct, sizeof(ct), tag_128_tc4) != -3 ||
+        AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), aad, sizeof(aad), ct_128_tc4, sizeof(ct), tag_128_tc4) != -3 ||
+        AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), ct_128_tc4, sizeof(ct), tag) != -3) {
+        printf("ERROR: Changed TC4 accepted\n");
+        goto done;
+    }
+    if (AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), NULL, 0, NULL, 16, tag) != -1 ||
+        AES_GCM_verify(&ctx, NULL, 0, NULL, 0, NULL, 0, tag) != -1 ||
+        AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), NULL, 0, NULL, 0, NULL) != -1) {
+        printf("ERROR: Invalid arguments\n");
+        goto done;
+    }
+
+    for (i = 0; i < sizeof(msg); ++i) {
+        msg[i] = (uint8_t)(i * 13 + 5);
+    }
+    for (i = 0; i < sizeof(key); ++i) {
+        key[i] = (uint8_t)(i * 3 + 1);
+    }
+    for (k = 0; k < sizeof(key_lens) / sizeof(key_lens[0]); ++k) {
+        if (AES_init_ctx_keylen(&ctx, key, key_lens[k]) != 0) {
+            continue; // 512-bit keys not compiled in
+        }
+        for (len = 0; len <= sizeof(msg); ++len) {
+            AES_GCM_encrypt(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), msg, sealed, len, tag);
+            if (AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), sealed, len, tag) != 0) {
+                printf("ERROR: %zu-byte key, %zu-byte message does not verify\n", key_lens[k], len);
+                goto done;
+            }
+            if (len > 0) {
+                sealed[len / 2] ^= 0x10;
+                if (AES_GCM_verify(&ctx, iv_tc, sizeof(iv_tc), aad_tc, sizeof(aad_tc), sealed, len, tag) != -3) {
+                    printf("ERROR: %zu-byte key, changed %zu-byte message accepted\n", key_lens[k], len);
+                    goto done;
+                }
+            }
+        }
+    }
+    result = 0;
+
+done:
+    printf("--- Verify Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// AES_GHASH_* against GHASH(H, C || len) of the GCM spec's test case 2; one
+// byte at a time and in one call agree; combining two streams equals hashing
+// the two zero-padded in turn, at every split point.
+int run_ghash_test(void) {
+    static const uint8_t H[16] = { 0x66,0xe9,0x4b,0xd4,0xef,0x8a,0x2c,0x3b,0x88,0x4c,0xfa,0x59,0xca,0x34,0x2b,0x2e };
+    static const uint8_t tc2[32] = { 0x03,0x88,0xda,0xce,0x60,0xb6,0xa3,0x92,0xf3,0x28,0xc2,0xb9,0x71,0xb2,0xfe,0x78,
+                                     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0x80 };
+    static const uint8_t expect[16] = { 0xf3,0x8c,0xbb,0x1a,0xd6,0x92,0x23,0xdc,0xc3,0x45,0x7a,0xe5,0xb6,0xb0,0xf8,0x85 };
+    static const uint8_t one[16] = { 0x80 }, zeros[16] = { 0 };
+    struct AES_GHASH_ctx g, tail;
+    uint8_t data[200], out[16], want[16], prod[16];
+    size_t i, k;
+    int result = 1;
+
+    printf("--- Running GHASH Test ---\n");
+    AES_GHASH_init(&g, H);
+    AES_GHASH_update(&g, tc2, sizeof(tc2));
+    AES_GHASH_final(&g, out);
+    if (memcmp(out, expect, 16) != 0) {
+        printf("ERROR: GHASH of test case 2 does not match\n");
+        goto done;
+    }
+    // 1 is 0x80 00..00 in GCM's bit order; one block hashes to X * H
+    AES_GHASH_init(&g, H);
+    AES_GHASH_update(&g, tc2, 16);
+    AES_GHASH_final(&g, want);
+    memcpy(out, H, 16);
+    if (AES_GHASH_mul(one, H, prod) != 0 || memcmp(prod, H, 16) != 0 ||
+        AES_GHASH_mul(out, tc2, out) != 0 || memcmp(out, want, 16) != 0) {
+        printf("ERROR: AES_GHASH_mul\n");
+        goto done;
+    }
+
+    for (i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t)(i * 29 + 3);
+    }
+    AES_GHASH_init(&g, H);
+    AES_GHASH_update(&g, data, sizeof(data));
+    AES_GHASH_final(&g, want);
+    AES_GHASH_init(&g, H);
+    for (i = 0; i < sizeof(data); ++i) {
+        AES_GHASH_update(&g, data + i, 1);
+    }
+    AES_GHASH_final(&g, out);
+    if (memcmp(out, want, 16) != 0) {
+        printf("ERROR: Byte-at-a-time GHASH differs\n");
+        goto done;
+    }
+
+    for (k = 0; k <= sizeof(data); ++k) {
+        AES_GHASH_init(&g, H);
+        AES_GHASH_update(&g, data, k);
+        AES_GHASH_update(&g, zeros, (16 - k % 16) % 16);
+        AES_GHASH_update(&g, data + k, sizeof(data) - k);
+        AES_GHASH_update(&g, zeros, (16 - (sizeof(data) - k) % 16) % 16);
+        AES_GHASH_update(&g, data, 5);
+        AES_GHASH_final(&g, want);
+
+        AES_GHASH_init(&g, H);
+        AES_GHASH_init(&tail, H);
+        AES_GHASH_update(&g, data, k);
+        AES_GHASH_update(&tail, data + k, sizeof(data) - k);
+        if (AES_GHASH_combine(&g, &tail) != 0) {
+            printf("ERROR: AES_GHASH_combine failed\n");
+            goto done;
+        }
+        AES_GHASH_update(&g, data, 5); // Continues after the padded tail
+        AES_GHASH_final(&g, out);
+        if (memcmp(out, want, 16) != 0) {
+            printf("ERROR: Combined GHASH split at %zu differs\n", k);
+            goto done;
+        }
+    }
+
+    AES_GHASH_init(&g, H);
+    AES_GHASH_init(&tail, expect);
+    if (AES_GHASH_combine(&g, &tail) != -1 || AES_GHASH_combine(&g, &g) != -1 ||
+        AES_GHASH_update(&g, NULL, 1) != -1 || AES_GHASH_init(&g, NULL) != -1) {
+        printf("ERROR: Invalid arguments\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    printf("--- GHASH Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+// AES-512 over every message length up to 600 bytes, so that each CTR kernel
+// (AES-NI's 8-block loop, VAES's 16-block loop) runs its main loop, its
+// leftover blocks and every partial tail. The XOR of all the tags is pinned
+// from the portable implementation, like the AES-512 vector above.
+int run_long_512_test(void) {
+    static const uint8_t expect[AES_GCM_TAG_LEN] = { 0xc9,0xc9,0xbb,0x4f,0xd9,0xfb,0xaa,0xb9,0x69,0x15,0x33,0x35,0x10,0xad,0xd6,0x50 };
+    struct AES_ctx ctx;
+    uint8_t pt[600], ct[600], tag[AES_GCM_TAG_LEN], fold[AES_GCM_TAG_LEN] = { 0 };
+    size_t i, len;
+
+    printf("--- Running AES-512 Message Length Test ---\n");
+    if (AES_init_ctx_keylen(&ctx, key_512_sc, 64) != 0) {
+        printf("Skipping test - 512-bit keys not compiled in\n\n");
+        return 0;
+    }
+    for (i = 0; i < sizeof(pt); ++i) {
+        pt[i] = (uint8_t)(i * 7);
+    }
+    for (len = 0; len <= sizeof(pt); ++len) {
+        AES_GCM_encrypt(&ctx, iv_512_sc, sizeof(iv_512_sc), NULL, 0, pt, ct, len, tag);
+        for (i = 0; i < sizeof(fold); ++i) {
+            fold[i] ^= tag[i];
+        }
+    }
+    if (memcmp(fold, expect, sizeof(expect)) != 0) {
+        print_hex("Folded tags", fold, sizeof(fold));
+        printf("--- AES-512 Message Length Test: FAILED ---\n\n");
+        return 1;
+    }
+    printf("--- AES-512 Message Length Test: PASSED ---\n\n");
+    return 0;
+}
+
+// Checks key-cache hits and misses, CLOCK eviction around pinned entries,
+// wiping on removal, and lookups after enough churn to rebuild the tables.
+int run_keycache_test(void) {
+    struct AES_key_cache* cache = AES_key_cache_new(4, 1);
+    struct AES_key_cache_stats st;
+    struct AES_ctx expect;
+    const struct AES_ctx* pinned[4];
+    const struct AES_ctx* c;
+    uint8_t key[32];
+    int result = 1;
+
+    printf("--- Running Key Cache Test ---\n");
+    if (cache == NULL || AES_key_cache_get(cache, 1) != NULL) {
+        printf("ERROR: New cache is missing or not empty\n");
+        goto done;
+    }
+    c = AES_key_cache_insert(cache, 1, key_tc, 16);
+    AES_init_ctx_keylen(&expect, key_tc, 16);
+    if (c == NULL || memcmp(c, &expect, sizeof(expect)) != 0 || AES_key_cache_insert(cache, 1, key_512_sc, 64) != c ||
+        AES_key_cache_get(cache, 1) != c) {
+        printf("ERROR: Insert did not cache the expanded key once\n");
+        goto done;
+    }
+    for (int i = 0; i < 3; ++i) {
+        AES_key_cache_release(cache, c);
+    }
+    if (AES_key_cache_insert(cache, 2, key_tc, 7) != NULL) {
+        printf("ERROR: Insert accepted a 7-byte key\n");
+        goto done;
+    }
+
+    // Fill the cache and pin everything: nothing can be evicted
+    for (uint64_t id = 1; id <= 4; ++id) {
+        pinned[id - 1] = id == 1 ? AES_key_cache_get(cache, id) : AES_key_cache_insert(cache, id, key_tc, 32);
+    }
+    if (AES_key_cache_insert(cache, 5, key_tc, 16) != NULL) {
+        printf("ERROR: Insert evicted a pinned context\n");
+        goto done;
+    }
+    // Unpin all but id 1; inserting id 5 must evict one of the others
+    for (int i = 1; i < 4; ++i) {
+        AES_key_cache_release(cache, pinned[i]);
+    }
+    c = AES_key_cache_insert(cache, 5, key_tc, 16);
+    AES_key_cache_stats(cache, &st);
+    if (c == NULL || c == pinned[0] || st.evictions != 1 || st.entries != 4 || st.capacity != 4) {
+        printf("ERROR: Expected one eviction, got %llu (entries %llu)\n", (unsigned long long)st.evictions,
+               (unsigned long long)st.entries);
+        goto done;
+    }
+    AES_key_cache_release(cache, c);
+
+    // Removing a pinned entry hides it at once and wipes it on release
+    if (AES_key_cache_remove(cache, 1) != 0 || AES_key_cache_get(cache, 1) != NULL ||
+        memcmp(pinned[0], &expect, sizeof(expect)) != 0 || AES_key_cache_remove(cache, 1) != -1) {
+        printf("ERROR: Remove of a pinned entry\n");
+        goto done;
+    }
+    AES_key_cache_release(cache, pinned[0]);
+    for (size_t i = 0; i < sizeof(expect); ++i) {
+        if (((const uint8_t*)pinned[0])[i] != 0) {
+            printf("ERROR: Removed context was not wiped\n");
+            goto done;
+        }
+    }
+    AES_key_cache_free(cache);
+
+    // Churn through many IDs on a small sharded cache; each hit must hold the
+    // key of its ID
+    cache = AES_key_cache_new(16, 4);
+    memcpy(key, key_tc, sizeof(key));
+    for (uint64_t n = 0; n < 4000 && cache != NULL; ++n) {
+        uint64_t id = (n * 7919) % 40;
+        key[0] = (uint8_t)id;
+        AES_init_ctx_keylen(&expect, key, sizeof(key));
+        c = AES_key_cache_get(cache, id);
+        if (c == NULL) {
+            c = AES_key_cache_insert(cache, id, key, sizeof(key));
+        }
+        if (c == NULL || memcmp(c, &expect, sizeof(expect)) != 0) {
+            printf("ERROR: Wrong context for key ID %llu\n", (unsigned long long)id);
+            goto done;
+        }
+        AES_key_cache_release(cache, c);
+        if (n % 97 == 0) {
+            AES_key_cache_remove(cache, id);
+        }
+    }
+    AES_key_cache_stats(cache, &st);
+    if (cache == NULL || st.hits + st.misses != 4000 || st.inserts != st.misses || st.entries > 16) {
+        printf("ERROR: Inconsistent counters after churn\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    AES_key_cache_free(cache);
+    printf("--- Key Cache Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+
+#if defined(AES_GCM_STANDALONE_TEST) && defined(__linux__)
+#include <unistd.h>
+#include "aes_seg_uring.h"
+
+static int temp_file(void) {
+    char path[] = "/tmp/aes_gcm_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+    return fd;
+}
+
+// Seals pt_len pseudo-random bytes through the io_uring pipeline, checks the
+// file against AES_seg_encrypt with the same parameters, opens it again, and
+// checks that a flipped bit fails authentication.
+int run_uring_test(size_t pt_len, uint32_t segment_size, unsigned depth) {
+    struct AES_ctx ctx;
+    struct AES_seg_params params = { segment_size, pt_len, 32, { 8, 7, 6, 5, 4, 3, 2, 1 } };
+    uint64_t sealed_len = AES_seg_sealed_len(&params);
+    uint8_t* pt = (uint8_t*)malloc(pt_len + 1);
+    uint8_t* expected = (uint8_t*)malloc(sealed_len);
+    uint8_t* got = (uint8_t*)malloc(sealed_len);
+    int in = temp_file(), sealed = temp_file(), out = temp_file();
+    int result = 1, ret;
+    uint8_t bit = 1;
+
+    printf("--- Running io_uring Test: %zu bytes, %u-byte segments, depth %u ---\n", pt_len, (unsigned)segment_size, depth);
+    if (!pt || !expected || !got || in < 0 || sealed < 0 || out < 0) {
+        printf("ERROR: Setup failed\n");
+        goto done;
+    }
+    for (size_t i = 0; i < pt_len; ++i) {
+        pt[i] = (uint8_t)(i * 131 + (i >> 9));
+    }
+    AES_init_ctx_keylen(&ctx, key_tc, 32);
+    AES_seg_encrypt(&ctx, &params, pt, expected);
+    if (pwrite(in, pt, pt_len, 0) != (ssize_t)pt_len) {
+        printf("ERROR: Writing the input failed\n");
+        goto done;
+    }
+
+    ret = AES_seg_uring_seal(&ctx, &params, in, sealed, depth);
+    if (ret == -2) {
+        printf("Skipping test - io_uring not available\n");
+        result = 0;
+        goto done;
+    }
+    if (ret != 0 || pread(sealed, got, sealed_len, 0) != (ssize_t)sealed_len || memcmp(got, expected, sealed_len) != 0) {
+        printf("ERROR: AES_seg_uring_seal output differs from AES_seg_encrypt (ret %d)\n", ret);
+        goto done;
+    }
+    ret = AES_seg_uring_open(&ctx, sealed, out, depth);
+    if (ret != 0 || (pt_len > 0 && (pread(out, got, pt_len, 0) != (ssize_t)pt_len || memcmp(got, pt, pt_len) != 0))) {
+        printf("ERROR: AES_seg_uring_open did not round trip (ret %d)\n", ret);
+        goto done;
+    }
+    if (pwrite(sealed, &bit, 1, (off_t)sealed_len - 1) != 1 || AES_seg_uring_open(&ctx, sealed, out, depth) != -3) {
+        printf("ERROR: Tampered file accepted\n");
+        goto done;
+    }
+    result = 0;
+
+done:
+    free(pt);
+    free(expected);
+    free(got);
+    if (in >= 0) close(in);
+    if (sealed >= 0) close(sealed);
+    if (out >= 0) close(out);
+    printf("--- io_uring Test: %s ---\n\n", result == 0 ? "PASSED" : "FAILED");
+    return result;
+}
+#endif
+
+#ifdef AES_GCM_STANDALONE_TEST // Only define main if compiling standalone C test (cgo also compiles this file)
 int main(void) {
     int total_failures = 0;
     printf("Starting AES-GCM Tests...\n");
-    // printf("(Note: IV lengths != 12 bytes are not supported in this implementation)\n"); // Commented out as non-12-byte IVs are now supported
 
-    // NIST Vectors
-    gcm_test_vector_t test1 = { "NIST B.1 (AES-128)", 16, key_128_b1, 12, iv_128_b1, 16, pt_128_b1, 0, NULL, ct_128_b1, tag_128_b1 };
-    gcm_test_vector_t test2 = { "NIST B.2 (AES-128)", 16, key_128_b2, 12, iv_128_b2, 60, pt_128_b2, 20, aad_128_b2, ct_128_b2, tag_128_b2 };
-    gcm_test_vector_t test3 = { "NIST B.5 (AES-256)", 32, key_256_b5, 12, iv_256_b5, 47, pt_256_b5, 20, aad_256_b5, ct_256_b5, tag_256_b5 };
+    // GCM Specification Vectors
+    gcm_test_vector_t test1 = { "GCM TC2 (AES-128)", 16, key_128_tc2, 12, iv_128_tc2, 16, pt_128_tc2, 0, NULL, ct_128_tc2, tag_128_tc2 };
+    gcm_test_vector_t test2 = { "GCM TC4 (AES-128)", 16, key_tc, 12, iv_tc, 60, pt_tc, 20, aad_tc, ct_128_tc4, tag_128_tc4 };
+    gcm_test_vector_t test3 = { "GCM TC16 (AES-256)", 32, key_tc, 12, iv_tc, 60, pt_tc, 20, aad_tc, ct_256_tc16, tag_256_tc16 };
+    gcm_test_vector_t test5 = { "GCM TC10 (AES-192)", 24, key_tc, 12, iv_tc, 60, pt_tc, 20, aad_tc, ct_192_tc10, tag_192_tc10 };
+    gcm_test_vector_t test6 = { "GCM TC6 (AES-128, 60-byte IV)", 16, key_tc, 60, iv_128_tc6, 60, pt_tc, 20, aad_tc, ct_128_tc6, tag_128_tc6 };
     
     // Non-Standard 512-bit Self-Consistency Test
     gcm_test_vector_t test4 = { 
@@ -216,14 +1207,43 @@ int main(void) {
         .pt = pt_512_sc, 
         .aad_len = sizeof(aad_512_sc), // Correct assignment for aad_len
         .aad = aad_512_sc,             // Correct assignment for aad
-        .expected_ct = NULL,           // Explicitly NULL for self-test 
-        .expected_tag = NULL           // Explicitly NULL for self-test
+        .expected_ct = ct_512_sc,      // Pinned regression values (see above)
+        .expected_tag = tag_512_sc
     };
 
     total_failures += run_gcm_test(&test1);
     total_failures += run_gcm_test(&test2);
     total_failures += run_gcm_test(&test3);
     total_failures += run_gcm_test(&test4);
+    total_failures += run_gcm_test(&test5);
+    total_failures += run_gcm_test(&test6);
+
+    total_failures += run_chunked_test(&test2, 16);
+    total_failures += run_chunked_test(&test3, 32);
+    total_failures += run_chunked_test(&test6, 48);
+    total_failures += run_chunked_test(&test4, 16);
+
+    total_failures += run_stats_test(&test6);
+
+    total_failures += run_seg_test(key_tc, 16, 16);
+    total_failures += run_seg_test(key_tc, 32, 25);
+    total_failures += run_seg_test(key_512_sc, 64, 7);
+    total_failures += run_nonce_test();
+    total_failures += run_keycache_test();
+    total_failures += run_ctx_alloc_test();
+    total_failures += run_long_512_test();
+    total_failures += run_iv_prefix_test();
+    total_failures += run_gmac_test();
+    total_failures += run_ctr_test();
+    total_failures += run_encrypt_blocks_test();
+    total_failures += run_tag_len_test();
+    total_failures += run_verify_test();
+    total_failures += run_ghash_test();
+#ifdef __linux__
+    total_failures += run_uring_test(200003, 4096, 8);
+    total_failures += run_uring_test(5000, 65536, 0);
+    total_failures += run_uring_test(0, 4096, 4);
+#endif
 
     printf("===============================\n");
     if (total_failures == 0) {
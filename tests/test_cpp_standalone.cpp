@@ -0,0 +1,334 @@
+// Tests for the C++20 wrapper in aes.hpp. Lives outside the package root so
+// that cgo does not try to compile it.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "aes.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+  std::printf("%s: %s\n", what, ok ? "SUCCESS" : "FAILED");
+  if (!ok) {
+    ++failures;
+  }
+}
+
+template <std::size_t N>
+std::array<std::byte, N> bytes(const unsigned char (&in)[N]) {
+  std::array<std::byte, N> out{};
+  for (std::size_t i = 0; i < N; ++i) {
+    out[i] = static_cast<std::byte>(in[i]);
+  }
+  return out;
+}
+
+// GCM spec Test Case 4 (AES-128), shared with test_c_standalone.c
+constexpr unsigned char key_tc4[16] = {
+  0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08 };
+constexpr unsigned char iv_tc4[12] = { 0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88 };
+constexpr unsigned char pt_tc4[60] = {
+  0xd9,0x31,0x32,0x25,0xf8,0x84,0x06,0xe5,0xa5,0x59,0x09,0xc5,0xaf,0xf5,0x26,0x9a,
+  0x86,0xa7,0xa9,0x53,0x15,0x34,0xf7,0xda,0x2e,0x4c,0x30,0x3d,0x8a,0x31,0x8a,0x72,
+  0x1c,0x3c,0x0c,0x95,0x95,0x68,0x09,0x53,0x2f,0xcf,0x0e,0x24,0x49,0xa6,0xb5,0x25,
+  0xb1,0x6a,0xed,0xf5,0xaa,0x0d,0xe6,0x57,0xba,0x63,0x7b,0x39 };
+constexpr unsigned char aad_tc4[20] = {
+  0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xab,0xad,0xda,0xd2 };
+constexpr unsigned char ct_tc4[60] = {
+  0x42,0x83,0x1e,0xc2,0x21,0x77,0x74,0x24,0x4b,0x72,0x21,0xb7,0x84,0xd0,0xd4,0x9c,
+  0xe3,0xaa,0x21,0x2f,0x2c,0x02,0xa4,0xe0,0x35,0xc1,0x7e,0x23,0x29,0xac,0xa1,0x2e,
+  0x21,0xd5,0x14,0xb2,0x54,0x66,0x93,0x1c,0x7d,0x8f,0x6a,0x5a,0xac,0x84,0xaa,0x05,
+  0x1b,0xa3,0x0b,0x39,0x6a,0x0a,0xac,0x97,0x3d,0x58,0xe0,0x91 };
+constexpr unsigned char tag_tc4[16] = {
+  0x5b,0xc9,0x4f,0xbc,0x32,0x21,0xa5,0xdb,0x94,0xfa,0xe9,0x5a,0xe7,0x12,0x1a,0x47 };
+
+// GCM spec Test Case 16 (AES-256, same IV/AAD/plaintext as TC4)
+constexpr unsigned char key_tc16[32] = {
+  0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08,
+  0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08 };
+constexpr unsigned char ct_tc16[60] = {
+  0x52,0x2d,0xc1,0xf0,0x99,0x56,0x7d,0x07,0xf4,0x7f,0x37,0xa3,0x2a,0x84,0x42,0x7d,
+  0x64,0x3a,0x8c,0xdc,0xbf,0xe5,0xc0,0xc9,0x75,0x98,0xa2,0xbd,0x25,0x55,0xd1,0xaa,
+  0x8c,0xb0,0x8e,0x48,0x59,0x0d,0xbb,0x3d,0xa7,0xb0,0x8b,0x10,0x56,0x82,0x88,0x38,
+  0xc5,0xf6,0x1e,0x63,0x93,0xba,0x7a,0x0a,0xbc,0xc9,0xf6,0x62 };
+constexpr unsigned char tag_tc16[16] = {
+  0x76,0xfc,0x6e,0xce,0x0f,0x4e,0x17,0x68,0xcd,0xdf,0x88,0x53,0xbb,0x2d,0x55,0x1b };
+
+// GCM spec Test Case 10 (AES-192)
+constexpr unsigned char ct_tc10[60] = {
+  0x39,0x80,0xca,0x0b,0x3c,0x00,0xe8,0x41,0xeb,0x06,0xfa,0xc4,0x87,0x2a,0x27,0x57,
+  0x85,0x9e,0x1c,0xea,0xa6,0xef,0xd9,0x84,0x62,0x85,0x93,0xb4,0x0c,0xa1,0xe1,0x9c,
+  0x7d,0x77,0x3d,0x00,0xc1,0x44,0xc5,0x25,0xac,0x61,0x9d,0x18,0xc8,0x4a,0x3f,0x47,
+  0x18,0xe2,0x44,0x8b,0x2f,0xe3,0x24,0xd9,0xcc,0xda,0x27,0x10 };
+constexpr unsigned char tag_tc10[16] = {
+  0x25,0x19,0x49,0x8e,0x80,0xf1,0x47,0x8f,0x37,0xba,0x55,0xbd,0x6d,0x27,0x61,0x8c };
+
+// GCM spec Test Case 6 (AES-128, 60-byte IV hashed into J0)
+constexpr unsigned char iv_tc6[60] = {
+  0x93,0x13,0x22,0x5d,0xf8,0x84,0x06,0xe5,0x55,0x90,0x9c,0x5a,0xff,0x52,0x69,0xaa,
+  0x6a,0x7a,0x95,0x38,0x53,0x4f,0x7d,0xa1,0xe4,0xc3,0x03,0xd2,0xa3,0x18,0xa7,0x28,
+  0xc3,0xc0,0xc9,0x51,0x56,0x80,0x95,0x39,0xfc,0xf0,0xe2,0x42,0x9a,0x6b,0x52,0x54,
+  0x16,0xae,0xdb,0xf5,0xa0,0xde,0x6a,0x57,0xa6,0x37,0xb3,0x9b };
+constexpr unsigned char ct_tc6[60] = {
+  0x8c,0xe2,0x49,0x98,0x62,0x56,0x15,0xb6,0x03,0xa0,0x33,0xac,0xa1,0x3f,0xb8,0x94,
+  0xbe,0x91,0x12,0xa5,0xc3,0xa2,0x11,0xa8,0xba,0x26,0x2a,0x3c,0xca,0x7e,0x2c,0xa7,
+  0x01,0xe4,0xa9,0xa4,0xfb,0xa4,0x3c,0x90,0xcc,0xdc,0xb2,0x81,0xd4,0x8c,0x7c,0x6f,
+  0xd6,0x28,0x75,0xd2,0xac,0xa4,0x17,0x03,0x4c,0x34,0xae,0xe5 };
+constexpr unsigned char tag_tc6[16] = {
+  0x61,0x9c,0xc5,0xae,0xff,0xfe,0x0b,0xfa,0x46,0x2a,0xf4,0x3c,0x16,0x99,0xd0,0x50 };
+
+// Encrypts with the constexpr implementation and compares against a vector.
+constexpr bool portable_matches(std::span<const std::uint8_t> key, std::span<const std::uint8_t> iv,
+                                std::span<const std::uint8_t> ct, std::span<const std::uint8_t> tag) {
+  std::array<std::uint8_t, sizeof(pt_tc4)> out{};
+  std::array<std::uint8_t, aes::tag_size> out_tag{};
+  const AES_ctx ctx = aes::portable::expand_key(key);
+  aes::portable::gcm_encrypt(ctx, iv, aad_tc4, pt_tc4, out, out_tag);
+  return std::equal(ct.begin(), ct.end(), out.begin()) && std::equal(tag.begin(), tag.end(), out_tag.begin());
+}
+
+static_assert(portable_matches(std::span(key_tc16).first(16), iv_tc4, ct_tc4, tag_tc4), "GCM TC4 (AES-128)");
+static_assert(portable_matches(std::span(key_tc16).first(24), iv_tc4, ct_tc10, tag_tc10), "GCM TC10 (AES-192)");
+static_assert(portable_matches(key_tc16, iv_tc4, ct_tc16, tag_tc16), "GCM TC16 (AES-256)");
+static_assert(portable_matches(std::span(key_tc16).first(16), iv_tc6, ct_tc6, tag_tc6), "GCM TC6 (60-byte IV)");
+
+// Non-standard AES-512, pinned against the C implementation (test_c_standalone.c)
+constexpr bool portable_matches_aes512() {
+  std::uint8_t key[64] = {};
+  for (unsigned i = 0; i < 64; ++i) {
+    key[i] = static_cast<std::uint8_t>(i);
+  }
+  constexpr std::uint8_t iv[12] = { 0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b };
+  constexpr std::uint8_t pt[] = { 'T','h','i','s',' ','i','s',' ','a',' ','t','e','s','t','.' };
+  constexpr std::uint8_t aad[] = { 0xAA, 0xBB, 0xCC, 0xDD };
+  constexpr std::uint8_t ct[] = { 0xbe,0xec,0x44,0x39,0xa0,0x08,0x13,0x7d,0x3b,0x11,0x05,0x74,0x29,0x73,0x75 };
+  constexpr std::uint8_t tag[] = { 0xf6,0x3c,0xf0,0x4e,0xd8,0x15,0xbe,0x68,0xb9,0xef,0xd8,0xbd,0x85,0xe5,0xe4,0xb7 };
+  std::array<std::uint8_t, sizeof(pt)> out{};
+  std::array<std::uint8_t, aes::tag_size> out_tag{};
+  aes::portable::gcm_encrypt(aes::portable::expand_key(key), iv, aad, pt, out, out_tag);
+  return std::equal(out.begin(), out.end(), ct) && std::equal(out_tag.begin(), out_tag.end(), tag);
+}
+static_assert(portable_matches_aes512(), "AES-512 regression vector");
+
+// A fixed key expanded entirely at compile time
+constexpr aes::fixed_gcm<128> fixed_tc4(key_tc4);
+static_assert(fixed_tc4.native_handle().Nr == 10);
+
+// Round keys are aligned lanes; H and its powers fill the first cache line,
+// and Nr and the first round keys share the second
+static_assert(alignof(AES_ctx) == AES_CTX_ALIGN && sizeof(AES_ctx) % AES_CTX_ALIGN == 0);
+static_assert(offsetof(AES_ctx, H) == 0 && offsetof(AES_ctx, H2) == 16 && offsetof(AES_ctx, H3) == 32 &&
+              offsetof(AES_ctx, H4) == 48);
+static_assert(offsetof(AES_ctx, Nr) == AES_CTX_ALIGN && offsetof(AES_ctx, RoundKey) % aes::block_size == 0 &&
+              offsetof(AES_ctx, RoundKey) < 2 * AES_CTX_ALIGN);
+
+// The constexpr key schedule must produce the context the C library would,
+// and the C kernels must accept it.
+void test_fixed_key() {
+  AES_ctx runtime_ctx{};
+  AES_init_ctx_keylen(&runtime_ctx, key_tc4, sizeof(key_tc4));
+  const AES_ctx& fixed_ctx = fixed_tc4.native_handle();
+  // Both start from a zeroed context, so every field (the schedule past
+  // Nr + 1, the cached GHASH values, the padding) must match
+  check(std::memcmp(&fixed_ctx, &runtime_ctx, sizeof(AES_ctx)) == 0,
+        "constexpr key schedule matches AES_init_ctx_keylen");
+
+  const auto iv = bytes(iv_tc4);
+  const auto aad = bytes(aad_tc4);
+  const auto pt = bytes(pt_tc4);
+  std::array<std::byte, sizeof(pt_tc4)> ct{};
+  std::array<std::byte, aes::tag_size> tag{};
+  fixed_tc4.seal(iv, aad, pt, ct, tag);
+  check(ct == bytes(ct_tc4) && tag == bytes(tag_tc4), "fixed_gcm seal matches GCM TC4");
+
+  // The kernels also read the cached per-key values: 16-byte IVs use H^2,
+  // and 64 bytes or more go through the 4-block GHASH with H^2..H^4
+  const aes::gcm128 gcm(bytes(key_tc4));
+  std::array<std::byte, 16> iv16{};
+  std::vector<std::byte> msg(200), fixed_ct(msg.size()), runtime_ct(msg.size());
+  std::array<std::byte, aes::tag_size> runtime_tag{};
+  for (std::size_t i = 0; i < msg.size(); ++i) {
+    msg[i] = static_cast<std::byte>(i);
+  }
+  for (std::size_t i = 0; i < iv16.size(); ++i) {
+    iv16[i] = static_cast<std::byte>(0xa0 + i);
+  }
+  for (const std::size_t len : { 16, 60, 64, 200 }) {
+    const auto in = std::span(msg).first(len);
+    fixed_tc4.seal(iv16, aad, in, std::span(fixed_ct).first(len), tag);
+    gcm.seal(iv16, aad, in, std::span(runtime_ct).first(len), runtime_tag);
+    check(fixed_ct == runtime_ct && tag == runtime_tag, "fixed_gcm seal matches gcm with a 16-byte IV");
+    fixed_tc4.seal(iv, aad, in, std::span(fixed_ct).first(len), tag);
+    gcm.seal(iv, aad, in, std::span(runtime_ct).first(len), runtime_tag);
+    check(fixed_ct == runtime_ct && tag == runtime_tag, "fixed_gcm seal matches gcm with a 12-byte IV");
+  }
+}
+
+void test_one_shot() {
+  const auto key = bytes(key_tc4);
+  const auto iv = bytes(iv_tc4);
+  const auto aad = bytes(aad_tc4);
+  const auto pt = bytes(pt_tc4);
+  std::array<std::byte, sizeof(pt_tc4)> ct{}, out{};
+  std::array<std::byte, aes::tag_size> tag{};
+
+  const aes::gcm128 gcm(key);
+  gcm.seal(iv, aad, pt, ct, tag);
+  check(ct == bytes(ct_tc4) && tag == bytes(tag_tc4), "seal matches GCM TC4");
+  check(gcm.open(iv, aad, ct, tag, out) && out == pt, "open round-trips");
+
+  tag[0] ^= std::byte{1};
+  check(!gcm.open(iv, aad, ct, tag, out) && out == decltype(out){}, "open rejects a bad tag and wipes output");
+
+  bool threw = false;
+  try {
+    gcm.seal(iv, aad, pt, std::span(out).first(10), tag);
+  } catch (const aes::error&) {
+    threw = true;
+  }
+  check(threw, "seal throws on mismatched sizes");
+}
+
+// Feeds a 1000-byte message through the streaming API in uneven pieces and
+// compares against the one-shot result.
+template <unsigned KeyBits>
+void test_streaming(const char* name) {
+  std::array<std::byte, aes::gcm<KeyBits>::key_size> key{};
+  for (std::size_t i = 0; i < key.size(); ++i) {
+    key[i] = static_cast<std::byte>(i);
+  }
+  const auto iv = bytes(iv_tc4);
+  const auto aad = bytes(aad_tc4);
+  std::vector<std::byte> pt(1000), ct(pt.size()), streamed(pt.size()), back(pt.size());
+  for (std::size_t i = 0; i < pt.size(); ++i) {
+    pt[i] = static_cast<std::byte>(i * 7);
+  }
+  std::array<std::byte, aes::tag_size> tag{}, streamed_tag{};
+
+  const aes::gcm<KeyBits> gcm(key);
+  gcm.seal(iv, aad, pt, ct, tag);
+
+  static constexpr std::size_t steps[] = { 1, 15, 3, 16, 40, 0, 7, 33, 100 };
+  auto sealer = gcm.sealer(iv, aad);
+  auto opener = gcm.opener(iv, aad);
+  for (std::size_t off = 0, s = 0; off < pt.size(); ++s) {
+    std::size_t n = std::min(steps[s % std::size(steps)], pt.size() - off);
+    sealer.update(std::span(pt).subspan(off, n), std::span(streamed).subspan(off, n));
+    opener.update(std::span(ct).subspan(off, n), std::span(back).subspan(off, n));
+    off += n;
+  }
+  sealer.finish(streamed_tag);
+  std::printf("%s\n", name);
+  check(streamed == ct && streamed_tag == tag, "  streaming seal matches one-shot");
+  check(opener.finish(tag) && back == pt, "  streaming open verifies and decrypts");
+
+  auto bad = gcm.opener(iv);
+  bad.update(ct, back);
+  check(!bad.finish(tag), "  streaming open rejects wrong AAD");
+}
+
+// Minimal fire-and-forget coroutine type for driving the awaitables.
+struct detached {
+  struct promise_type {
+    detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+struct async_result {
+  std::vector<std::byte> ct, pt;
+  std::array<std::byte, aes::tag_size> tag{};
+  bool opened = false, rejected = false;
+};
+
+detached seal_then_open(const aes::gcm256& gcm, aes::worker_pool& pool, std::span<const std::byte> iv,
+                        std::span<const std::byte> pt, async_result& r, std::atomic<int>& done) {
+  r.ct.resize(pt.size());
+  r.pt.resize(pt.size());
+  co_await gcm.async_seal(pool, iv, {}, pt, r.ct, r.tag);
+  r.opened = co_await gcm.async_open(pool, iv, {}, r.ct, r.tag, r.pt);
+  auto bad_tag = r.tag;
+  bad_tag[0] ^= std::byte{0x80};
+  std::vector<std::byte> scratch(pt.size());
+  r.rejected = !co_await gcm.async_open(pool, iv, {}, r.ct, bad_tag, scratch);
+  done.fetch_add(1);
+}
+
+// Several concurrent messages through a small pool with max_inflight = 2, so
+// messages are chunked, run in parallel and queue for admission.
+void test_async() {
+  std::array<std::byte, 32> key{};
+  key[0] = std::byte{1};
+  const aes::gcm256 gcm(key);
+  aes::worker_pool::options opts;
+  opts.threads = 2;
+  opts.chunk_size = 4096;
+  opts.max_inflight = 2;
+  opts.inline_threshold = 1024;
+  aes::worker_pool pool(opts);
+
+  constexpr std::size_t sizes[] = { 100000, 65536, 5000, 512, 0, 4097 };
+  std::vector<std::vector<std::byte>> pts, ivs;
+  std::vector<async_result> results(std::size(sizes));
+  std::atomic<int> done{0};
+  for (std::size_t m = 0; m < std::size(sizes); ++m) {
+    pts.emplace_back(sizes[m]);
+    for (std::size_t i = 0; i < sizes[m]; ++i) {
+      pts[m][i] = static_cast<std::byte>(i * 13 + m);
+    }
+    ivs.emplace_back(aes::iv_size, static_cast<std::byte>(m));
+  }
+  for (std::size_t m = 0; m < std::size(sizes); ++m) {
+    seal_then_open(gcm, pool, ivs[m], pts[m], results[m], done);
+  }
+  while (done.load() != static_cast<int>(std::size(sizes))) {
+    std::this_thread::yield();
+  }
+
+  bool ok = true;
+  for (std::size_t m = 0; m < std::size(sizes); ++m) {
+    std::vector<std::byte> ct(sizes[m]);
+    std::array<std::byte, aes::tag_size> tag{};
+    gcm.seal(ivs[m], {}, pts[m], ct, tag);
+    ok = ok && results[m].ct == ct && results[m].tag == tag && results[m].opened && results[m].pt == pts[m] &&
+         results[m].rejected;
+  }
+  check(ok, "async seal/open match sync results and reject bad tags");
+  check(pool.inflight() == 0 && pool.waiting() == 0, "async pool drained");
+}
+
+} // namespace
+
+int main() {
+  std::printf("Starting AES-GCM C++ Tests...\n");
+  test_one_shot();
+  test_fixed_key();
+  test_async();
+  test_streaming<128>("Streaming AES-128");
+  test_streaming<192>("Streaming AES-192");
+  test_streaming<256>("Streaming AES-256");
+  test_streaming<512>("Streaming AES-512");
+
+  std::printf("===============================\n");
+  if (failures == 0) {
+    std::printf("ALL C++ TESTS PASSED\n");
+  } else {
+    std::printf("%d C++ TEST(S) FAILED\n", failures);
+  }
+  std::printf("===============================\n");
+  return failures;
+}
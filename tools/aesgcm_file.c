@@ -0,0 +1,546 @@
+/*
+ * aesgcm-file: seal and open files in the segmented container format
+ * (aes_seg.h), and decrypt byte ranges by reading only the covering segments.
+ *
+ *   aesgcm-file seal  -k KEYFILE [-s SEGMENT_SIZE] [-j THREADS] [-w mmap|pwrite] [-q] IN OUT
+ *   aesgcm-file open  -k KEYFILE [-j THREADS] [-w mmap|pwrite] [-q] IN OUT
+ *   aesgcm-file range -k KEYFILE IN OFFSET LENGTH [OUT]
+ *
+ * KEYFILE holds the raw key (16, 24, 32 or 64 bytes). OUT defaults to stdout
+ * for range. open removes OUT if any segment fails authentication.
+ *
+ * seal and open map the input, size the output up front and process segments
+ * on THREADS workers (default: online CPUs), writing into a shared mapping of
+ * the output (-w mmap, the default) or with one pwrite per segment. Both print
+ * the plaintext throughput to stderr unless -q is given.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "aes.h"
+#include "aes_seg.h"
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: aesgcm-file seal  -k KEYFILE [-s SEGMENT_SIZE] [-j THREADS] [-w mmap|pwrite] [-q] IN OUT\n"
+            "       aesgcm-file open  -k KEYFILE [-j THREADS] [-w mmap|pwrite] [-q] IN OUT\n"
+            "       aesgcm-file range -k KEYFILE IN OFFSET LENGTH [OUT]\n");
+    exit(2);
+}
+
+static int read_full(int fd, uint8_t* buf, size_t len, off_t offset) {
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1; // Error, or the file is shorter than its header says
+        }
+        buf += n;
+        len -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const uint8_t* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static size_t load_key(const char* path, uint8_t key[64]) {
+    uint8_t extra;
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+    size_t n = fread(key, 1, 64, f);
+    if (fread(&extra, 1, 1, f) != 0 || (n != 16 && n != 24 && n != 32 && n != 64)) {
+        fprintf(stderr, "%s: key must be 16, 24, 32 or 64 bytes\n", path);
+        exit(1);
+    }
+    fclose(f);
+    return n;
+}
+
+static void random_bytes(uint8_t* buf, size_t len) {
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd < 0 || read_full(fd, buf, len, 0) != 0) {
+        perror("/dev/urandom");
+        exit(1);
+    }
+    close(fd);
+}
+
+static int pwrite_full(int fd, const uint8_t* buf, size_t len, off_t offset) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, buf, len, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// --- Work-stealing pool ---
+//
+// Segments are grouped into tasks of about TASK_BYTES. Each worker starts with
+// a contiguous run of tasks, packed as next << 32 | end in one atomic word, and
+// takes tasks from the front of it. A worker whose run is empty steals the back
+// half of another worker's run with a CAS, so the owner keeps streaming through
+// adjacent memory while uneven workers (page faults, a busy core) are balanced.
+// A run is only ever shrunk by others, and only replaced by its owner once it
+// is empty, so a single CAS per take or steal is enough.
+
+#define TASK_BYTES (1u << 20)
+
+struct job;
+
+struct worker {
+    _Alignas(64) _Atomic uint64_t run; // One cache line per worker
+    struct job* job;
+    unsigned id;
+    pthread_t thread;
+    uint8_t* buf; // pwrite output: one segment plus tag
+};
+
+struct job {
+    const struct AES_ctx* ctx;
+    int sealing;
+    const uint8_t* header;
+    struct AES_seg_params params;
+    const uint8_t* in;  // Mapped input
+    uint8_t* out;       // Mapped output, or NULL to pwrite from each worker's buf
+    int out_fd;
+    uint64_t segs_per_task;
+    unsigned nworkers;
+    struct worker* workers;
+    _Atomic int failed;            // 0, or -1 (I/O error) / -3 (authentication failed)
+    _Atomic uint64_t bad_segment;  // First failing segment reported
+};
+
+static uint64_t run_pack(uint64_t next, uint64_t end) {
+    return next << 32 | end;
+}
+
+static int64_t take_task(struct worker* w) {
+    uint64_t v = atomic_load(&w->run);
+    while ((v >> 32) < (uint32_t)v) {
+        if (atomic_compare_exchange_weak(&w->run, &v, run_pack((v >> 32) + 1, (uint32_t)v))) {
+            return (int64_t)(v >> 32);
+        }
+    }
+    return -1;
+}
+
+static int64_t steal_task(struct worker* self) {
+    struct job* job = self->job;
+    for (unsigned k = 1; k < job->nworkers; ++k) {
+        struct worker* victim = &job->workers[(self->id + k) % job->nworkers];
+        uint64_t v = atomic_load(&victim->run);
+        while ((v >> 32) < (uint32_t)v) {
+            uint64_t next = v >> 32, end = (uint32_t)v, half = (end - next + 1) / 2;
+            if (atomic_compare_exchange_weak(&victim->run, &v, run_pack(next, end - half))) {
+                atomic_store(&self->run, run_pack(end - half + 1, end)); // Our run was empty
+                return (int64_t)(end - half);
+            }
+        }
+    }
+    return -1;
+}
+
+static int run_segment(struct worker* w, uint64_t i) {
+    const struct job* job = w->job;
+    const struct AES_seg_params* params = &job->params;
+    size_t n = AES_seg_plain_len(params, i);
+    uint64_t plain_off = i * params->segment_size, sealed_off = AES_seg_offset(params, i);
+
+    if (job->sealing) {
+        const uint8_t* pt = n ? job->in + plain_off : NULL;
+        uint8_t* dst = job->out ? job->out + sealed_off : w->buf;
+        if (AES_seg_seal(job->ctx, job->header, i, pt, n, dst) != 0) {
+            return -1;
+        }
+        return job->out ? 0 : pwrite_full(job->out_fd, dst, n + AES_GCM_TAG_LEN, (off_t)sealed_off);
+    }
+    uint8_t* dst = job->out ? job->out + plain_off : w->buf;
+    int ret = AES_seg_open(job->ctx, job->header, i, job->in + sealed_off, n + AES_GCM_TAG_LEN, dst);
+    if (ret != 0) {
+        return ret;
+    }
+    return job->out ? 0 : pwrite_full(job->out_fd, dst, n, (off_t)plain_off);
+}
+
+static void* worker_main(void* arg) {
+    struct worker* w = (struct worker*)arg;
+    struct job* job = w->job;
+    uint64_t count = AES_seg_count(&job->params);
+    int64_t task;
+
+    while (atomic_load_explicit(&job->failed, memory_order_relaxed) == 0 &&
+           ((task = take_task(w)) >= 0 || (task = steal_task(w)) >= 0)) {
+        uint64_t first = (uint64_t)task * job->segs_per_task;
+        uint64_t last = first + job->segs_per_task < count ? first + job->segs_per_task : count;
+        for (uint64_t i = first; i < last; ++i) {
+            int ret = run_segment(w, i);
+            if (ret != 0) {
+                int expected = 0;
+                if (atomic_compare_exchange_strong(&job->failed, &expected, ret)) {
+                    atomic_store(&job->bad_segment, i);
+                }
+                return NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Seals or opens every segment of job on nthreads workers.
+static int run_job(struct job* job, unsigned nthreads) {
+    uint64_t count = AES_seg_count(&job->params);
+    uint64_t tasks = (count + job->segs_per_task - 1) / job->segs_per_task;
+    unsigned started = 0;
+    int ret = 0;
+
+    if (tasks > UINT32_MAX) {
+        return -1; // Does not fit the packed runs (petabytes with 1 MiB segments)
+    }
+    job->nworkers = nthreads < tasks ? nthreads : (unsigned)tasks;
+    job->workers = aligned_alloc(64, job->nworkers * sizeof(struct worker));
+    if (job->workers == NULL) {
+        return -1;
+    }
+    for (unsigned t = 0; t < job->nworkers; ++t) {
+        struct worker* w = &job->workers[t];
+        atomic_init(&w->run, run_pack(tasks * t / job->nworkers, tasks * (t + 1) / job->nworkers));
+        w->job = job;
+        w->id = t;
+        w->buf = NULL;
+    }
+    for (unsigned t = 0; t < job->nworkers && ret == 0; ++t) {
+        struct worker* w = &job->workers[t];
+        if (job->out == NULL && (w->buf = malloc((size_t)job->params.segment_size + AES_GCM_TAG_LEN)) == NULL) {
+            ret = -1;
+        } else if (t > 0 && pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            ret = -1;
+        } else {
+            started = t + 1;
+        }
+    }
+    if (ret != 0) {
+        atomic_store(&job->failed, -1);
+    }
+    if (started > 0) {
+        worker_main(&job->workers[0]); // The calling thread is worker 0
+    }
+    for (unsigned t = 1; t < started; ++t) {
+        pthread_join(job->workers[t].thread, NULL);
+    }
+    for (unsigned t = 0; t < job->nworkers; ++t) {
+        if (job->workers[t].buf != NULL) {
+            memset(job->workers[t].buf, 0, (size_t)job->params.segment_size + AES_GCM_TAG_LEN);
+            free(job->workers[t].buf);
+        }
+    }
+    free(job->workers);
+    return atomic_load(&job->failed);
+}
+
+struct file_options {
+    unsigned threads;
+    int use_mmap; // Write the output through a shared mapping instead of pwrite
+    int quiet;
+};
+
+// Seals (sealing != 0) or opens the whole of in into out, with the input
+// memory-mapped and segments processed by a pool of opts->threads workers.
+static int process_file(const struct AES_ctx* ctx, int sealing, size_t key_len, uint32_t segment_size, int in,
+                        int out, const struct file_options* opts) {
+    const char* what = sealing ? "seal" : "open";
+    uint8_t header[AES_SEG_HEADER_LEN];
+    struct job job;
+    struct stat st;
+    uint8_t* in_map = NULL;
+    uint8_t* out_map = NULL;
+    uint64_t out_len = 0;
+    int ret = 1;
+
+    double start = now_seconds();
+    memset(&job, 0, sizeof(job));
+    if (fstat(in, &st) != 0) {
+        perror(what);
+        return 1;
+    }
+    if (st.st_size > 0 && (in_map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, in, 0)) == MAP_FAILED) {
+        perror("mmap input");
+        return 1;
+    }
+
+    if (sealing) {
+        job.params.segment_size = segment_size;
+        job.params.plaintext_len = (uint64_t)st.st_size;
+        job.params.key_len = (uint8_t)key_len;
+        random_bytes(job.params.nonce_base, sizeof(job.params.nonce_base));
+        if (AES_seg_header_write(&job.params, header) != 0) {
+            fprintf(stderr, "seal: invalid segment size or input too large\n");
+            goto done;
+        }
+        out_len = AES_seg_sealed_len(&job.params);
+    } else {
+        if ((uint64_t)st.st_size < AES_SEG_HEADER_LEN) {
+            fprintf(stderr, "open: not a sealed file\n");
+            goto done;
+        }
+        memcpy(header, in_map, sizeof(header));
+        if (AES_seg_header_read(header, &job.params) != 0 ||
+            (uint64_t)st.st_size != AES_seg_sealed_len(&job.params)) {
+            fprintf(stderr, "open: not a sealed file, or truncated\n");
+            goto done;
+        }
+        out_len = job.params.plaintext_len;
+    }
+
+    if (ftruncate(out, (off_t)out_len) != 0) {
+        perror("ftruncate output");
+        goto done;
+    }
+    if (opts->use_mmap && out_len > 0 &&
+        (out_map = mmap(NULL, (size_t)out_len, PROT_READ | PROT_WRITE, MAP_SHARED, out, 0)) == MAP_FAILED) {
+        out_map = NULL;
+        perror("mmap output");
+        goto done;
+    }
+    if (sealing && out_map != NULL) {
+        memcpy(out_map, header, sizeof(header));
+    } else if (sealing && pwrite_full(out, header, sizeof(header), 0) != 0) {
+        perror("seal");
+        goto done;
+    }
+
+    job.ctx = ctx;
+    job.sealing = sealing;
+    job.header = header;
+    job.in = in_map;
+    job.out = out_map;
+    job.out_fd = out;
+    // About TASK_BYTES per task, but at least four tasks per worker to steal
+    job.segs_per_task = job.params.segment_size < TASK_BYTES ? TASK_BYTES / job.params.segment_size : 1;
+    uint64_t spread = (AES_seg_count(&job.params) + 4 * (uint64_t)opts->threads - 1) / (4 * (uint64_t)opts->threads);
+    if (spread < job.segs_per_task) {
+        job.segs_per_task = spread;
+    }
+    int r = run_job(&job, opts->threads);
+    if (r == -3) {
+        fprintf(stderr, "open: segment %llu: authentication failed\n", (unsigned long long)atomic_load(&job.bad_segment));
+        goto done;
+    } else if (r != 0) {
+        fprintf(stderr, "%s: I/O error or out of memory\n", what);
+        goto done;
+    }
+    ret = 0;
+
+done:
+    if (out_map != NULL && munmap(out_map, (size_t)out_len) != 0) {
+        perror("munmap output");
+        ret = 1;
+    }
+    if (in_map != NULL) {
+        munmap(in_map, (size_t)st.st_size);
+    }
+    if (ret == 0 && !opts->quiet) {
+        double seconds = now_seconds() - start;
+        uint64_t bytes = job.params.plaintext_len;
+        fprintf(stderr, "%s: %llu bytes in %.4f s, %.3f GB/s (%llu segments, %u threads, %s output)\n", what,
+                (unsigned long long)bytes, seconds, seconds > 0 ? (double)bytes / seconds / 1e9 : 0.0,
+                (unsigned long long)AES_seg_count(&job.params), job.nworkers, opts->use_mmap ? "mmap" : "pwrite");
+    }
+    return ret;
+}
+
+// Decrypts plaintext bytes [offset, offset + len) of the sealed file in to out,
+// reading only the covering segments.
+static int open_range(const struct AES_ctx* ctx, int in, uint64_t offset, uint64_t len, int out) {
+    struct AES_seg_params params;
+    uint8_t header[AES_SEG_HEADER_LEN];
+    struct stat st;
+
+    if (read_full(in, header, sizeof(header), 0) != 0 || AES_seg_header_read(header, &params) != 0 ||
+        fstat(in, &st) != 0 || (uint64_t)st.st_size != AES_seg_sealed_len(&params)) {
+        fprintf(stderr, "open: not a sealed file, or truncated\n");
+        return 1;
+    }
+    if (offset > params.plaintext_len || len > params.plaintext_len - offset) {
+        fprintf(stderr, "range: [%llu, +%llu) is past the end (%llu bytes)\n", (unsigned long long)offset,
+                (unsigned long long)len, (unsigned long long)params.plaintext_len);
+        return 1;
+    }
+
+    uint8_t* buf = malloc((size_t)params.segment_size + AES_GCM_TAG_LEN);
+    if (buf == NULL) {
+        fprintf(stderr, "open: out of memory\n");
+        return 1;
+    }
+    uint64_t first = offset / params.segment_size;
+    uint64_t last = len ? (offset + len - 1) / params.segment_size : first;
+    int ret = 0;
+    for (uint64_t i = first; i <= last && len > 0 && ret == 0; ++i) {
+        size_t n = AES_seg_plain_len(&params, i);
+        uint64_t start = i * params.segment_size;
+        uint64_t from = offset > start ? offset - start : 0;
+        uint64_t to = offset + len - start < n ? offset + len - start : n;
+        int r = -1;
+        if (read_full(in, buf, n + AES_GCM_TAG_LEN, (off_t)AES_seg_offset(&params, i)) != 0 ||
+            (r = AES_seg_open(ctx, header, i, buf, n + AES_GCM_TAG_LEN, buf)) != 0 ||
+            write_full(out, buf + from, (size_t)(to - from)) != 0) {
+            fprintf(stderr, "open: segment %llu: %s\n", (unsigned long long)i,
+                    r == -3 ? "authentication failed" : "I/O error");
+            ret = 1;
+        }
+    }
+    memset(buf, 0, (size_t)params.segment_size + AES_GCM_TAG_LEN);
+    free(buf);
+    return ret;
+}
+
+static uint64_t parse_u64(const char* s) {
+    char* end;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 0);
+    if (errno != 0 || end == s || *end != '\0' || s[0] == '-') {
+        fprintf(stderr, "invalid number: %s\n", s);
+        exit(2);
+    }
+    return v;
+}
+
+int main(int argc, char** argv) {
+    const char* key_path = NULL;
+    uint64_t segment_size = AES_SEG_DEFAULT_SEGMENT_SIZE;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    struct file_options opts = { cpus > 0 ? (unsigned)cpus : 1, 1, 0 };
+    int opt;
+
+    if (argc < 2) {
+        usage();
+    }
+    const char* mode = argv[1];
+    optind = 2;
+    while ((opt = getopt(argc, argv, "k:s:j:w:q")) != -1) {
+        switch (opt) {
+        case 'k':
+            key_path = optarg;
+            break;
+        case 's':
+            segment_size = parse_u64(optarg);
+            break;
+        case 'j':
+            opts.threads = (unsigned)parse_u64(optarg);
+            if (opts.threads == 0 || opts.threads > 1024) {
+                usage();
+            }
+            break;
+        case 'w':
+            if (strcmp(optarg, "mmap") != 0 && strcmp(optarg, "pwrite") != 0) {
+                usage();
+            }
+            opts.use_mmap = strcmp(optarg, "mmap") == 0;
+            break;
+        case 'q':
+            opts.quiet = 1;
+            break;
+        default:
+            usage();
+        }
+    }
+    char** args = argv + optind;
+    int nargs = argc - optind;
+    if (key_path == NULL) {
+        usage();
+    }
+
+    uint8_t key[64];
+    size_t key_len = load_key(key_path, key);
+    struct AES_ctx ctx;
+    if (AES_init_ctx_keylen(&ctx, key, key_len) != 0) {
+        fprintf(stderr, "%s: unsupported key length\n", key_path);
+        return 1;
+    }
+    memset(key, 0, sizeof(key));
+
+    int is_seal = strcmp(mode, "seal") == 0, is_open = strcmp(mode, "open") == 0;
+    int is_range = strcmp(mode, "range") == 0;
+    if (!((is_seal || is_open) && nargs == 2) && !(is_range && (nargs == 3 || nargs == 4))) {
+        usage();
+    }
+    if (!is_seal && segment_size != AES_SEG_DEFAULT_SEGMENT_SIZE) {
+        usage(); // The segment size of an existing file comes from its header
+    }
+    if (segment_size == 0 || segment_size > UINT32_MAX) {
+        fprintf(stderr, "segment size must be between 1 and %u\n", UINT32_MAX);
+        return 2;
+    }
+
+    int in = open(args[0], O_RDONLY);
+    if (in < 0) {
+        perror(args[0]);
+        return 1;
+    }
+    const char* out_path = is_range ? (nargs == 4 ? args[3] : NULL) : args[1];
+    // Read access too, for the shared output mapping
+    int out = out_path ? open(out_path, (is_range ? O_WRONLY : O_RDWR) | O_CREAT | O_TRUNC, 0600) : STDOUT_FILENO;
+    if (out < 0) {
+        perror(out_path);
+        return 1;
+    }
+
+    int ret;
+    if (is_seal || is_open) {
+        ret = process_file(&ctx, is_seal, key_len, (uint32_t)segment_size, in, out, &opts);
+    } else {
+        ret = open_range(&ctx, in, parse_u64(args[1]), parse_u64(args[2]), out);
+    }
+    if (out_path && close(out) != 0) {
+        perror(out_path);
+        ret = 1;
+    }
+    if (ret != 0 && out_path) {
+        unlink(out_path); // Leave no partial or unauthenticated output behind
+    }
+    close(in);
+    memset(&ctx, 0, sizeof(ctx));
+    return ret;
+}